@@ -0,0 +1,35 @@
+/*
+* ARM64 Machine-Code Decoder
+*
+* Turns A64 instruction words (from an ELF executable) into the assembly
+* text the Parser reads, so loaded binaries go through the same parse and
+* predecode path as listings.
+*
+* - Covers the integer instructions the executor implements: arithmetic,
+*   logical and move-wide immediates, shifted/extended register forms,
+*   bitfield moves, multiply/divide, conditional select/compare, loads and
+*   stores (immediate, register, pre/post-index, pairs), branches, SVC and
+*   MRS/MSR, plus the scalar FP data-processing instructions.
+* - PC-relative values are resolved while decoding: ADR/ADRP become a MOV
+*   of the address and branch targets are written as absolute 0x addresses.
+* - Hints and barriers decode to NOP (the emulator is single threaded).
+* - Anything else comes back as ".inst 0x<word>", which assembles to an
+*   instruction that raises an error if it is ever executed.
+*
+* Author: Kyle Mather and Braeden Allen
+*/
+
+#ifndef ARM64_A64_DECODE_HPP
+#define ARM64_A64_DECODE_HPP
+
+#include <cstdint>
+#include <string>
+
+namespace arm64 {
+
+// Assembly text for the instruction word at address pc.
+std::string disassemble(uint32_t word, uint64_t pc);
+
+} // namespace arm64
+
+#endif // ARM64_A64_DECODE_HPP
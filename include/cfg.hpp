@@ -0,0 +1,108 @@
+/*
+* ARM64 Control-Flow Graph
+*
+* The structural view of an AsmProgram: basic blocks, the edges between
+* them, dominators and natural loops, with DOT and JSON export.
+*
+* - A block starts at the program entry, at every direct branch or call
+*   target, after every branch/RET/UDF and at host-function entries
+*   (hle.hpp). blockLeaders() is the same split, and is what
+*   fuseSuperinstructions() uses so no superinstruction spans two blocks.
+* - Edges: fallthrough (including a call's return site), taken (direct
+*   branches), call (BL) and return (RET back to the sites that call its
+*   function). BR/BLR targets are unknown and have no edge.
+* - Dominators (Cooper-Harvey-Kennedy) and loops are computed over the
+*   fallthrough and taken edges from the entry and every call target, so
+*   each function is analysed on its own.
+* - Loops are natural loops: a back edge to a header that dominates its
+*   source, merged per header, with nesting depth.
+* - Exports can carry per-block execution counts from a profiled run.
+* - The graph refers to the program it was built from, which must outlive it.
+*
+* Author: Kyle Mather and Braeden Allen
+*/
+
+#ifndef ARM64_CFG_HPP
+#define ARM64_CFG_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "executor.hpp"
+
+namespace arm64 {
+
+enum class EdgeKind : uint8_t {
+    Fallthrough, // next block in address order
+    Taken,       // direct branch target
+    Call,        // BL to the callee's entry
+    Return,      // RET to the instruction after a BL to its function
+};
+
+struct CfgEdge {
+    uint32_t from, to; // block ids
+    EdgeKind kind;
+};
+
+struct BasicBlock {
+    static constexpr uint32_t kNone = 0xFFFF'FFFFu;
+
+    uint32_t first{0};                 // index of the first instruction in prog.code
+    uint32_t size{0};                  // instructions in the block
+    std::vector<uint32_t> succs, preds; // edge ids, in edges() order
+    uint32_t idom{kNone};              // immediate dominator; kNone for entries and unreachable blocks
+    uint32_t loop{kNone};              // innermost loop containing the block
+    bool     reachable{false};         // from the entry or a call target
+};
+
+struct Loop {
+    uint32_t header;
+    std::vector<uint32_t> latches;     // sources of back edges to header
+    std::vector<uint32_t> blocks;      // body including header, ascending
+    uint32_t parent{BasicBlock::kNone}; // enclosing loop
+    uint32_t depth{1};                 // 1 for outermost
+};
+
+// One flag per instruction of prog (plus one for the end address) marking
+// the first instruction of each basic block.
+std::vector<bool> blockLeaders(const AsmProgram& prog, uint64_t entry);
+inline std::vector<bool> blockLeaders(const AsmProgram& prog) { return blockLeaders(prog, prog.base); }
+
+class ControlFlowGraph {
+public:
+    // entry is where execution starts (prog.base for listings, e_entry for ELF).
+    explicit ControlFlowGraph(const AsmProgram& prog, uint64_t entry);
+    explicit ControlFlowGraph(const AsmProgram& prog) : ControlFlowGraph(prog, prog.base) {}
+
+    const std::vector<BasicBlock>& blocks() const { return blocks_; }
+    const std::vector<CfgEdge>&    edges() const { return edges_; }
+    const std::vector<Loop>&       loops() const { return loops_; }
+
+    // Block containing instruction index i of prog.code.
+    uint32_t blockAt(std::size_t i) const { return blockOf_[i]; }
+    bool     isLeader(std::size_t i) const { return blocks_[blockOf_[i]].first == i; }
+
+    // True if every path from an entry to b passes through a (a dominates itself).
+    bool dominates(uint32_t a, uint32_t b) const;
+
+    // counts, if given, holds one execution count per block (see executor_main --profile).
+    std::string toDot(const std::vector<uint64_t>* counts = nullptr) const;
+    std::string toJson(const std::vector<uint64_t>* counts = nullptr) const;
+
+private:
+    void addEdge(uint32_t from, uint32_t to, EdgeKind kind);
+    void computeDominators(const std::vector<uint32_t>& entries);
+    void findLoops();
+
+    const AsmProgram& prog_;
+    std::vector<BasicBlock> blocks_;
+    std::vector<CfgEdge> edges_;
+    std::vector<Loop> loops_;
+    std::vector<uint32_t> blockOf_; // instruction index -> block id
+};
+
+} // namespace arm64
+
+#endif // ARM64_CFG_HPP
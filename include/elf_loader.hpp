@@ -0,0 +1,84 @@
+/*
+* ARM64 Static ELF Loader
+*
+* Starts statically linked AArch64 Linux executables the way the kernel
+* would: segments in guest memory, an initial process stack, PC at e_entry.
+*
+* - Accepts ELF64, little endian, EM_AARCH64, ET_EXEC; executables that
+*   need an interpreter or dynamic linking are rejected.
+* - PT_LOAD segments are copied into Memory at their p_vaddr (the rest of
+*   p_memsz reads as zero); the brk heap starts at the first page past the
+*   highest segment.
+* - Executable segments are decoded (a64_decode.hpp) into one AsmProgram
+*   based at the lowest executable address; .symtab function symbols
+*   become its labels, so host functions (hle.hpp) can bind to them.
+* - The stack holds argc, argv[], envp[] and the auxiliary vector (AT_PHDR,
+*   AT_PHENT, AT_PHNUM, AT_PAGESZ, AT_ENTRY, AT_RANDOM, AT_EXECFN, ...),
+*   with the strings and AT_RANDOM bytes above them, as Linux lays it out.
+* - Throws std::runtime_error for files it cannot run.
+*
+* Author: Kyle Mather and Braeden Allen
+*/
+
+#ifndef ARM64_ELF_LOADER_HPP
+#define ARM64_ELF_LOADER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "executor.hpp"
+#include "mapped_file.hpp"
+#include "memory.hpp"
+#include "parser.hpp"
+
+namespace arm64 {
+
+// True if path starts with the ELF magic bytes.
+bool isElfFile(const std::string& path);
+
+class ElfExecutable {
+public:
+    static constexpr uint64_t kStackTop  = 0x0000800000000000ull; // one past the highest stack byte
+    static constexpr uint64_t kStackSize = 8ull << 20;              // 8 MiB, committed lazily
+
+    explicit ElfExecutable(const std::string& path);
+
+    uint64_t entry() const { return entry_; }
+
+    // First page past the highest PT_LOAD segment.
+    uint64_t brkBase() const { return brkBase_; }
+
+    // Function symbols (uppercase name -> address); empty if stripped.
+    const LabelMap& symbols() const { return symbols_; }
+
+    // Map and fill every PT_LOAD segment.
+    void load(Memory& mem) const;
+
+    // Decode the executable segments into a program based at their lowest address.
+    AsmProgram decode(const Parser& parser) const;
+
+    // Map the stack and write argc/argv/envp/auxv; returns the initial SP.
+    uint64_t setupStack(Memory& mem, const std::vector<std::string>& argv,
+                        const std::vector<std::string>& envp) const;
+
+private:
+    struct Segment {
+        uint64_t vaddr, memsz, offset, filesz;
+        uint32_t flags;
+    };
+
+    void readSymbols();
+
+    MappedFile file_;
+    std::vector<Segment> segments_; // PT_LOAD only
+    uint64_t entry_{0};
+    uint64_t brkBase_{0};
+    uint64_t phdrAddr_{0};          // program headers in guest memory, 0 if not loaded
+    uint64_t phent_{0}, phnum_{0};
+    LabelMap symbols_;
+};
+
+} // namespace arm64
+
+#endif // ARM64_ELF_LOADER_HPP
@@ -7,14 +7,40 @@
 * - Assigns sequential addresses (0x0, 0x4, ...) to instructions and records labels.
 * - Defines AsmProgram / AsmInst containers used by the emulator.
 * - Exposes buildFileProgram(...) and step(...).
+* - Resolves branch targets and register/memory operands once at build time
+*   (AsmInst::pre), so execution never re-parses operand text.
+* - Fuses common adjacent pairs/triples (CMP+B.cond, LDR+ADD+STR, MOV+ADD)
+*   into superinstructions for untraced runs, and folds MOVZ+MOVK chains
+*   into a single constant load. optimize.hpp can further rewrite whole
+*   block windows (Fusion::Block, OptAction).
 * - Executes the Task-5 instruction set:
-*     ADD, SUB, AND, EOR, MUL, MOV,
-*     STR, STRB, LDR, LDRB,
-*     CMP, B, B.GT, B.LE, NOP, RET.
+*     ADD, SUB, AND, ORR, EOR, MUL, MOV (with shifted/extended registers),
+*     MOVZ, MOVN, MOVK, MADD, MSUB, MNEG, SMULL, UMULL, SMULH, UMULH, SDIV, UDIV,
+*     LSL, LSR, ASR, ROR, UBFM, SBFM, BFM and their bitfield aliases,
+*     STR, STRB, STRH, LDR, LDRB, LDRH, LDRSB, LDRSH, LDRSW, LDP, STP (with
+*     pre/post-index writeback),
+*     CMP, B, B.<cond> (all 16 conditions), NOP, RET,
+*   plus CSEL, CSINC, CSINV, CSNEG, CSET, CSETM, CINC, CINV, CNEG, CCMP, CCMN,
+*   flag-setting ADDS, SUBS, ANDS, CMN, TST and carry chains ADC(S), SBC(S),
+*   and calls/branches BL, BLR, BR, RET {Xn}, CBZ, CBNZ, TBZ, TBNZ.
+* - AdvSIMD integer instructions on V0-V31: LD1, ST1, ADD, SUB, MUL, AND, ORR,
+*   EOR, MOV, CMEQ, ADDV, DUP, INS, UMOV, run through the host SIMD kernels
+*   in simd.hpp.
+* - Scalar FP on the S/D views of V0-V31: FMOV, FADD, FSUB, FMUL, FDIV,
+*   FMADD, FMSUB, FNEG, FABS, FSQRT, FCMP(E), FCVT, FCVTZS/ZU, SCVTF/UCVTF,
+*   LDR/STR of St/Dt/Qt, and MRS/MSR of NZCV, FPCR and FPSR; rounding
+*   follows FPCR (fp.hpp).
+* - Entries of memcpy/memset/strlen and friends can run as host functions
+*   (hle.hpp) and return straight to X30.
+* - Calls link through X30; ExecState tracks call depth with a return-address
+*   stack so RET from the entry function can halt (RetPolicy).
 * - Updates PC, general-purpose registers, and processor state flags as needed.
 * - Enforces 32-/64-bit semantics: Wn reads/writes low 32-bits (zero-extend on
 *   destination), Xn operate on full 64-bits.
-* - Uses the 256-byte stack model for all memory accesses with bounds checks.
+* - Loads and stores translate a guest address to the 256-byte stack when it
+*   falls there, else to a Memory region (ELF segments, brk heap, anonymous
+*   mmap; memory.hpp). An access not wholly inside one of them throws
+*   "<op> of <n> bytes at 0x<addr> out of guest memory bounds".
 *
 * Author: Kyle Mather and Braeden Allen
 */
@@ -23,6 +49,7 @@
 #define ARM64_EXECUTOR_HPP
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <cstdint>
@@ -34,25 +61,203 @@
 
 namespace arm64 {
 
+class Memory; // guest heap, memory.hpp
+
+// Superinstruction headed by an instruction (see fuseSuperinstructions()).
+enum class Fusion : uint8_t {
+    None,
+    CmpBranch,     // CMP Rn, op2 ; B.cond label
+    LoadAddStore,  // LDR Rt, [m] ; ADD Rt, Rt, op2 ; STR Rt, [m]
+    MovAdd,        // MOV Rd, op2 ; ADD ...
+    MovConst,      // MOVZ/MOVN/MOV Rd, #imm ; MOVK Rd, ... (up to three)
+    Block,         // a window rewritten by optimizeProgram(), see OptAction
+};
+
+// Longest group executeFused() may retire in one call.
+constexpr std::size_t kMaxFusedLength = 16;
+
+// What a member of a Fusion::Block window does in place of itself when the
+// window is run from its head (optimize.hpp).
+enum class OptAction : uint8_t {
+    Keep,   // execute the instruction
+    Skip,   // nothing: its result is dead or already in place
+    Const,  // Rd = optImm
+    Move,   // Rd = slot optSrc & optImm (a reload of a value still in a register)
+};
+
+// Shift or extend applied to a second source register ("x2, lsl #3", "w2, sxtw").
+enum class ShiftOp : uint8_t {
+    None,
+    Lsl, Lsr, Asr, Ror,
+    Uxtb, Uxth, Uxtw, Uxtx, Sxtb, Sxth, Sxtw, Sxtx,
+};
+
+// Facts derived from the decoded text once, after the whole program is known.
+// Kept trivially copyable so program images can store it verbatim.
+struct Predecoded {
+    static constexpr uint32_t kNoTarget = 0xFFFF'FFFFu;
+
+    uint64_t target{0};             // branch target address (valid if hasTarget)
+    uint32_t targetIdx{kNoTarget};  // index of the target instruction, if it is one
+    bool     hasTarget{false};      // false for non-branches and undefined labels
+
+    // Operands as Registers slots. An absent register is the zero slot, so the
+    // register and immediate forms of a second source are both (Rm & mask) + imm.
+    bool     ok{false};             // operands well formed; if not, executing re-raises the error
+    uint8_t  rd{Registers::XZR_INDEX}; // destination, or Rt for loads/stores
+    uint8_t  rn{Registers::XZR_INDEX}; // also Rt2 for LDP/STP
+    uint8_t  rm{Registers::XZR_INDEX};
+    uint8_t  ra{Registers::XZR_INDEX}; // MADD/MSUB addend, read at the width of Rd
+    uint8_t  rdW{0}, rnW{0}, rmW{0}; // 1 for a Wn view (low 32 bits)
+
+    // Memory operand: base + ((index & mask) << lsl) + offset. With memWb the
+    // base is updated to that address + imm after the access: imm is 0 for
+    // pre-index ([Xn, #off]!) and the increment for post-index ([Xn], #inc).
+    uint8_t  memBase{Registers::XZR_INDEX};
+    uint8_t  memIndex{Registers::XZR_INDEX};
+    uint8_t  memIndexW{0};
+    uint8_t  memLsl{0};
+    uint8_t  memIndexSxt{0};        // 1 for [.., Wm, SXTW]: sign-extend the index from bit 31
+    uint8_t  memWb{0};
+
+    // Second-source shift/extend, applied at the operation width (shiftW = 1
+    // for 32-bit). Shift instructions (LSL Rd, Rn, ...) keep their kind here too.
+    ShiftOp  shift{ShiftOp::None};
+    uint8_t  shiftAmt{0};           // also immr for bitfield moves
+    uint8_t  shiftW{0};
+
+    // Bitfield moves (UBFM/SBFM/BFM and aliases), as in the A64 pseudocode:
+    // Rd = (top & ~tmask) | (bot & tmask), bot = ROR(Rn, immr) & wmask.
+    // MOVK is the same insert with a constant: Rd = (Rd & ~wmask) | imm.
+    uint8_t  bf{0};                 // 0 none, 1 UBFM, 2 SBFM, 3 BFM
+    uint8_t  bfS{0};                // imms (sign bit for SBFM)
+    uint64_t bfWmask{0};
+    uint64_t bfTmask{0};
+
+    // Conditional select / compare. CSET, CINC, ... are rewritten to their
+    // CSEL-family form with the condition inverted, so every select is
+    // cond ? Rn : ((Rm ^ -selInvert) + imm).
+    uint8_t  cond{static_cast<uint8_t>(Cond::AL)}; // condition actually evaluated
+    uint8_t  selInvert{0};          // 1 for CSINV/CSNEG
+    uint8_t  nzcv{0};               // CCMP flags when the condition fails
+
+    // AdvSIMD operands. rd/rn/rm hold V register numbers for vector
+    // instructions; vgpr marks the one general register of DUP/INS/UMOV
+    // (the other slot keeps its usual meaning).
+    uint8_t  vesz{0};               // element size: 0 B, 1 H, 2 S, 3 D
+    uint8_t  vq{0};                 // 1 for a 128-bit arrangement
+    uint8_t  vlane{0};              // element index of Vd (INS) or Vn (UMOV, DUP)
+    uint8_t  vlane2{0};             // source element index of INS Vd[i], Vn[j]
+    uint8_t  vcount{0};             // LD1/ST1 register count
+    uint8_t  vgpr{0};
+    uint8_t  vesz2{0};              // FCVT: source precision (vesz is the destination)
+    uint8_t  form{0};               // FMOV/FCMP/MRS/MSR operand form, see decodeFp()
+
+    // Entry of a libc routine run on the host instead (HostFn, hle.hpp); set
+    // by bindHostFunctions(), never by predecode().
+    uint8_t  host{0};
+
+    int64_t  imm{0};
+    int64_t  memOffset{0};
+
+    Fusion   fuse{Fusion::None};    // set only by fuseSuperinstructions()
+    uint8_t  fuseLen{1};            // instructions in the group
+    uint64_t fuseImm{0};            // Fusion::MovConst: the folded value of Rd
+
+    OptAction opt{OptAction::Keep};  // set only by optimizeProgram()
+    uint8_t   optSrc{0};
+    uint64_t  optImm{0};
+};
+
 struct AsmInst {
     uint64_t addr;
     std::size_t instrIndex; // 1-based index of instruction in program
+    std::size_t srcLine{0}; // 1-based line in the source listing
     DecodedInstruction inst;
+    Predecoded pre{};
 };
 
+using LabelMap = std::unordered_map<std::string, uint64_t>; // uppercase name -> address
+
 struct AsmProgram {
+    uint64_t base{0}; // address of code[0]; instructions follow 4 bytes apart
     std::vector<AsmInst> code;
-    std::unordered_map<std::string, uint64_t> labels;
+    LabelMap labels;
     std::unordered_map<uint64_t, std::size_t> addr2idx;
 };
 
+// What RET does when executed.
+enum class RetPolicy : uint8_t {
+    HaltAlways,     // every RET halts (the original Task-5 behavior)
+    HaltFromEntry,  // RET halts only when no BL/BLR call is outstanding
+    Never,          // RET always jumps to its register
+};
+
+// Per-run control-flow state for executeInst/executeFused/step.
+struct ExecState {
+    RetPolicy retPolicy{RetPolicy::HaltFromEntry};
+
+    // Return addresses pushed by BL/BLR and popped by RET; its depth is the
+    // call depth. A RET whose target matches the top is a predicted return.
+    std::vector<uint64_t> returnStack;
+    std::size_t rasHits{0};
+    std::size_t rasMisses{0};
+
+    // Set when the guest calls exit/exit_group; exitCode is the low 8 bits
+    // of its status.
+    bool exited{false};
+    int  exitCode{0};
+
+    // Run the routines tagged by bindHostFunctions() natively (hle.hpp);
+    // hostCalls counts the calls that were.
+    bool        hostFunctions{true};
+    std::size_t hostCalls{0};
+
+    // Guest heap for brk/mmap and for loads/stores outside the stack; with
+    // none attached the stack is the only guest memory.
+    Memory* memory{nullptr};
+};
+
 // First pass: parse and assign addresses; collect labels.
 AsmProgram buildFileProgram(const std::string& path, const Parser& parser);
 
+// Same as buildFileProgram, over listing text already in memory.
+AsmProgram buildProgramFromText(std::string_view text, const Parser& parser);
+
+// Strip leading "name:" labels from a line, recording each at next_instr_addr.
+// Returns the remainder of the line.
+std::string_view collectLeadingLabels(std::string_view line, uint64_t next_instr_addr, LabelMap& out);
+
+// Fill ai.pre once the program's labels and size are known.
+void predecode(AsmInst& ai, const LabelMap& labels, std::size_t codeSize, uint64_t base = 0);
+
+// Mark adjacent instruction groups that executeFused() runs in one dispatch.
+// A group never extends into another basic block (blockLeaders(), cfg.hpp),
+// and every member keeps its own Predecoded block, so entering mid-group
+// stays exact.
+void fuseSuperinstructions(AsmProgram& prog);
+
 // Execute a single instruction at PC -> updates regs/stack/PC.
-// Returns false to halt (RET) or when PC == end.
+// Returns false to halt (RET, per st.retPolicy) or when PC == end.
+bool step(const AsmProgram& prog, Registers& regs, Stack& stack, uint64_t& pc, ExecState& st);
+
+// As above with RetPolicy::HaltAlways.
 bool step(const AsmProgram& prog, Registers& regs, Stack& stack, uint64_t& pc);
 
+// Execute an already-fetched instruction; endAddr is the address one past the
+// last instruction. Shared by AsmProgram and LazyProgram.
+bool executeInst(const AsmInst& ai, uint64_t endAddr, Registers& regs, Stack& stack, uint64_t& pc,
+                 ExecState& st);
+
+// As above with RetPolicy::HaltAlways.
+bool executeInst(const AsmInst& ai, uint64_t endAddr, Registers& regs, Stack& stack, uint64_t& pc);
+
+// Like executeInst, but runs the whole superinstruction headed by *ai. ai must
+// point into prog.code of a fused AsmProgram. Adds the number of instructions
+// executed to retired.
+bool executeFused(const AsmInst* ai, uint64_t endAddr, Registers& regs, Stack& stack, uint64_t& pc,
+                  ExecState& st, std::size_t& retired);
+
 } // namespace arm64
 
 #endif // ARM64_EXECUTOR_HPP
@@ -0,0 +1,106 @@
+/*
+* ARM64 Scalar Floating Point
+*
+* Host-FPU helpers for the scalar FP instructions (FADD, FMADD, FCVT,
+* SCVTF, ...), honouring the rounding mode selected by the guest's FPCR.
+*
+* - FPCR.RMode (bits 23:22) picks one of four IEEE rounding modes.
+* - Round-to-nearest is the host's default mode, so that case runs inline
+*   with plain host arithmetic; the directed modes switch the host FPU
+*   through <cfenv> around the one operation (fp.cpp, built so the compiler
+*   does not move FP arithmetic across the mode switches).
+* - Conversions to integers always truncate and saturate (NaN gives 0),
+*   as FCVTZS/FCVTZU do.
+* - FPCR.FZ/DN and FPSR exception accumulation are not modelled.
+*
+* Author: Kyle Mather and Braeden Allen
+*/
+
+#ifndef ARM64_FP_HPP
+#define ARM64_FP_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace arm64 {
+namespace fp {
+
+// FPCR.RMode encodings.
+enum class Rounding : uint8_t { Nearest, PlusInf, MinusInf, Zero };
+
+inline Rounding rounding(uint32_t fpcr) { return static_cast<Rounding>((fpcr >> 22) & 3); }
+
+enum class Op : uint8_t { Add, Sub, Mul, Div, Fma, Sqrt };
+
+// a op b; Fma is a * b + c with one rounding, Sqrt uses a only.
+template <class T>
+inline T compute(Op op, T a, T b, T c) {
+    switch (op) {
+    case Op::Add:  return a + b;
+    case Op::Sub:  return a - b;
+    case Op::Mul:  return a * b;
+    case Op::Div:  return a / b;
+    case Op::Fma:  return std::fma(a, b, c);
+    default:       return std::sqrt(a);
+    }
+}
+
+// Directed-rounding paths (fp.cpp).
+float  computeRounded(Op op, float a, float b, float c, Rounding r);
+double computeRounded(Op op, double a, double b, double c, Rounding r);
+float  narrowRounded(double v, Rounding r);
+template <class T> T fromIntRounded(uint64_t v, bool isSigned, Rounding r);
+
+template <class T>
+inline T eval(Op op, T a, T b, T c, Rounding r) {
+    return r == Rounding::Nearest ? compute(op, a, b, c) : computeRounded(op, a, b, c, r);
+}
+
+// FCVT Sd, Dn
+inline float narrow(double v, Rounding r) {
+    return r == Rounding::Nearest ? static_cast<float>(v) : narrowRounded(v, r);
+}
+
+// SCVTF/UCVTF of a 64-bit value (already sign- or zero-extended from 32 bits).
+template <class T>
+inline T fromInt(uint64_t v, bool isSigned, Rounding r) {
+    if (r != Rounding::Nearest) return fromIntRounded<T>(v, isSigned, r);
+    return isSigned ? static_cast<T>(static_cast<int64_t>(v)) : static_cast<T>(v);
+}
+
+// FCVTZS/FCVTZU to a bits-wide integer: truncate, saturate, NaN -> 0.
+template <class T>
+inline uint64_t toIntTrunc(T v, bool isSigned, unsigned bits) {
+    if (std::isnan(v)) return 0;
+    const T t = std::trunc(v);
+    const uint64_t mask = bits >= 64 ? ~0ull : (1ull << bits) - 1;
+    if (isSigned) {
+        const T lim = std::ldexp(T(1), static_cast<int>(bits) - 1);
+        if (t >= lim)  return mask >> 1;                       // INT_MAX
+        if (t < -lim)  return (mask >> 1) + 1;                 // INT_MIN at the width
+        return static_cast<uint64_t>(static_cast<int64_t>(t)) & mask;
+    }
+    if (t <= T(0)) return 0;
+    if (t >= std::ldexp(T(1), static_cast<int>(bits))) return mask;
+    return static_cast<uint64_t>(t);
+}
+
+// FCMP result as packed NZCV: unordered 0011, equal 0110, less 1000, greater 0010.
+template <class T>
+inline unsigned compare(T a, T b) {
+    if (std::isnan(a) || std::isnan(b)) return 0x3;
+    if (a == b) return 0x6;
+    return a < b ? 0x8 : 0x2;
+}
+
+// Bit-pattern views of S/D register contents.
+inline float  asFloat(uint64_t bits)  { const uint32_t b = static_cast<uint32_t>(bits); float f; std::memcpy(&f, &b, 4); return f; }
+inline double asDouble(uint64_t bits) { double d; std::memcpy(&d, &bits, 8); return d; }
+inline uint64_t bitsOf(float f)  { uint32_t b; std::memcpy(&b, &f, 4); return b; }
+inline uint64_t bitsOf(double d) { uint64_t b; std::memcpy(&b, &d, 8); return b; }
+
+} // namespace fp
+} // namespace arm64
+
+#endif // ARM64_FP_HPP
@@ -0,0 +1,50 @@
+/*
+* ARM64 Host Function Interception
+*
+* Runs hot libc routines natively instead of emulating them instruction by
+* instruction. When execution reaches the entry of a known routine, the
+* host version works on guest memory directly and returns to X30.
+*
+* - Routines are found by symbol name in the program's labels: ELF .symtab
+*   function symbols, objdump "addr <name>:" headers and "<name>" call
+*   annotations all end up there.
+* - memcpy, memmove, memset, memcmp and strlen, on the AAPCS64 arguments
+*   X0-X2 with the result in X0; other registers are left as they were.
+* - A routine that would touch unmapped memory is not intercepted: the
+*   guest's own code runs and faults exactly as it would have.
+* - ExecState::hostFunctions turns interception off (--no-hle).
+*
+* Author: Kyle Mather and Braeden Allen
+*/
+
+#ifndef ARM64_HLE_HPP
+#define ARM64_HLE_HPP
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "executor.hpp"
+
+namespace arm64 {
+
+// Stored in Predecoded::host; None for ordinary instructions.
+enum class HostFn : uint8_t {
+    None,
+    Memcpy, Memmove, Memset, Memcmp, Strlen,
+};
+
+// Address of every routine in labels that has a host version.
+std::vector<std::pair<uint64_t, HostFn>> findHostFunctions(const LabelMap& labels);
+
+// Tag the first instruction of each such routine in prog (after predecode()).
+void bindHostFunctions(AsmProgram& prog);
+
+// Run fn on the guest's arguments and write its result. Returns false,
+// having changed nothing the guest code would not redo, when the guest
+// routine has to run instead.
+bool callHostFunction(HostFn fn, Registers& regs, Stack& stack, ExecState& st);
+
+} // namespace arm64
+
+#endif // ARM64_HLE_HPP
@@ -0,0 +1,56 @@
+/*
+* ARM64 Program Image Cache
+*
+* A compiled, binary form of an AsmProgram so repeated runs of the same
+* listing can skip text parsing entirely.
+*
+* - The image stores every instruction's decoded form (opcode, condition,
+*   classified operands, immediates), its Predecoded block (resolved branch
+*   targets) and source line, plus the label table and a string pool.
+* - Images are read back through a memory mapping; records are fixed size
+*   and copied straight out of the mapping.
+* - Each image records a hash of the listing it was built from; a changed
+*   source, a different format version or a different Predecoded layout
+*   makes the image stale and it is rebuilt.
+* - Images are a host-local cache (native byte order), not an interchange
+*   format.
+*
+* Author: Kyle Mather and Braeden Allen
+*/
+
+#ifndef ARM64_IMAGE_HPP
+#define ARM64_IMAGE_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "executor.hpp"
+
+namespace arm64 {
+
+// Bump whenever the record layout or the meaning of a stored field changes.
+constexpr uint32_t kImageVersion = 17;
+
+// Fast 64-bit content hash used to tie an image to its source listing.
+uint64_t hashContents(std::string_view bytes);
+
+// "<source>.a64img"
+std::string defaultImagePath(const std::string& sourcePath);
+
+// Serialize prog; written to a uniquely named temporary file beside imagePath,
+// synced and renamed into place, so concurrent writers cannot tear it.
+void writeProgramImage(const AsmProgram& prog, const std::string& imagePath, uint64_t sourceHash);
+
+// Load an image if it exists, is well formed and matches sourceHash.
+std::optional<AsmProgram> loadProgramImage(const std::string& imagePath, uint64_t sourceHash);
+
+// Load prog from its image when fresh, otherwise parse the listing and
+// (re)write the image. An empty imagePath means defaultImagePath(path).
+AsmProgram buildCachedProgram(const std::string& path, const Parser& parser,
+                              const std::string& imagePath = {});
+
+} // namespace arm64
+
+#endif // ARM64_IMAGE_HPP
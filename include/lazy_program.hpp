@@ -0,0 +1,93 @@
+/*
+* ARM64 Lazily Decoded Program
+*
+* An alternative to AsmProgram for listings too large to hold decoded.
+*
+* - The listing is memory-mapped; construction makes one cheap pass that
+*   records where each instruction's text starts (and collects labels)
+*   without parsing any operands.
+* - Instructions are decoded on first fetch into a bounded cache; when the
+*   cache is full a CLOCK (second-chance) sweep evicts a cold entry.
+* - Resident memory therefore tracks the executed working set plus a small
+*   fixed record per instruction, not the size of the listing.
+* - Host functions (hle.hpp) bind through objdump symbol headers; call
+*   annotations are only seen once their instruction is decoded.
+* - Parse errors surface when the offending instruction is first fetched
+*   rather than at load time.
+*
+* Author: Kyle Mather and Braeden Allen
+*/
+
+#ifndef ARM64_LAZY_PROGRAM_HPP
+#define ARM64_LAZY_PROGRAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "executor.hpp"
+#include "hle.hpp"
+#include "mapped_file.hpp"
+#include "parser.hpp"
+
+namespace arm64 {
+
+class LazyProgram {
+public:
+    static constexpr std::size_t kDefaultCacheSize = 4096;
+
+    LazyProgram(const std::string& path, const Parser& parser,
+                std::size_t cacheSize = kDefaultCacheSize);
+
+    std::size_t size()    const { return lines_.size(); }
+    uint64_t    endAddr() const { return lines_.size() * 4ull; }
+    const LabelMap& labels() const { return labels_; }
+
+    // Decoded instruction at pc; throws if pc is not an instruction address.
+    // The reference stays valid until the next fetch() that misses.
+    const AsmInst& fetch(uint64_t pc);
+
+    struct Stats {
+        std::size_t hits{0};
+        std::size_t misses{0};
+        std::size_t evictions{0};
+    };
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct LineRef {
+        uint64_t offset;  // start of the instruction text in the file
+        uint32_t length;
+        uint32_t srcLine;
+    };
+    struct Slot {
+        AsmInst  inst{};
+        uint32_t idx{0};
+        bool     used{false};
+        bool     referenced{false};
+    };
+
+    std::size_t takeSlot();
+
+    MappedFile file_;
+    const Parser& parser_;
+    std::vector<LineRef> lines_;
+    LabelMap labels_;
+    std::vector<std::pair<uint64_t, HostFn>> hostFns_; // from symbol headers only
+
+    std::vector<Slot> slots_;
+    std::unordered_map<uint32_t, uint32_t> resident_; // instruction index -> slot
+    std::size_t hand_{0};
+    Stats stats_;
+};
+
+// Execute a single instruction from a lazily decoded program (see step()).
+bool step(LazyProgram& prog, Registers& regs, Stack& stack, uint64_t& pc, ExecState& st);
+bool step(LazyProgram& prog, Registers& regs, Stack& stack, uint64_t& pc);
+
+} // namespace arm64
+
+#endif // ARM64_LAZY_PROGRAM_HPP
@@ -0,0 +1,103 @@
+/*
+* ARM64 Counted-Loop Fast-Forwarding
+*
+* Recognises loops whose iterations only update registers and stack slots
+* by affine recurrences and exit on a compare against a fixed bound, and
+* jumps over whole runs of their iterations in closed form.
+*
+* - A candidate is a natural loop (cfg.hpp) whose trip from the header back
+*   to itself is one straight path with a single exit: B.cond after a CMP or
+*   SUBS, or CBZ/CBNZ.
+* - Along the path only ADD, SUB, MOV, MOVZ/MOVN/MOVK, LSL #n, MUL/MADD/MSUB/
+*   MNEG with a constant factor, and LDR/STR of Wt/Xt at fixed offsets from
+*   one register the loop never writes are allowed; no other memory is
+*   touched and nothing else can fault.
+* - Each iteration is then x' = A x + c over the locations it writes, so k
+*   iterations are A^k by repeated squaring. W results are exact modulo 2^32.
+* - The exit value must be an induction variable (or a multiple of one plus
+*   an invariant), so the exiting iteration is solved for directly: a modular
+*   inverse for EQ/NE, a binary search over the non-wrapping range for
+*   ordered conditions.
+* - Execution lands at the start of the exiting iteration with registers,
+*   stack slots and NZCV exactly as interpretation leaves them, and never
+*   skips past the caller's step budget.
+* - In verify mode the skipped iterations are interpreted instead and the
+*   result is checked against the closed form; a mismatch throws.
+*
+* Author: Kyle Mather and Braeden Allen
+*/
+
+#ifndef ARM64_LOOPS_HPP
+#define ARM64_LOOPS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "executor.hpp"
+
+namespace arm64 {
+
+// One location an iteration reads or writes: a register slot or a stack slot.
+struct LoopLocation {
+    bool     memory{false};
+    uint8_t  reg{0};          // register slot, or the base of a memory slot
+    uint8_t  size{8};         // memory slot bytes (4 or 8)
+    int64_t  offset{0};       // memory slot offset from reg
+};
+
+// A linear form over the locations' values at the start of an iteration:
+// c + sum(coef * value). w32 forms are only meaningful modulo 2^32.
+struct LoopForm {
+    uint64_t c{0};
+    std::vector<std::pair<uint32_t, uint64_t>> terms; // location id, coefficient; ascending ids
+    bool     w32{false};
+};
+
+struct LoopSummary {
+    uint32_t header{0};                  // instruction index of the loop header
+    uint32_t length{0};                  // instructions per iteration
+    bool     fallsIn{false};             // an iteration ends by falling through into the header
+    std::vector<LoopLocation> locations;
+    std::vector<LoopForm> next;          // per location: its value after one iteration
+    std::vector<bool> written;           // per location: changed by an iteration
+
+    // Exit test, evaluated on the iteration's start values.
+    LoopForm lhs, rhs;
+    unsigned width{64};                  // of the compare
+    uint8_t  cond{0};                    // Cond code; CBZ is EQ and CBNZ NE against 0
+    bool     exitTaken{false};           // the branch leaves the loop when taken
+    bool     setsFlags{false};           // the test is a CMP/SUBS, so NZCV are written
+};
+
+class LoopAccelerator {
+public:
+    // entry as for ControlFlowGraph. prog must outlive the accelerator.
+    LoopAccelerator(const AsmProgram& prog, uint64_t entry, bool verify = false);
+
+    const std::vector<LoopSummary>& summaries() const { return summaries_; }
+
+    // The summary of the loop headed by instruction idx, or nullptr.
+    const LoopSummary* summaryAt(std::size_t idx) const;
+
+    // Called with pc at instruction idx. If idx heads a summarised loop that
+    // stays inside it for at least one whole iteration, advances the state
+    // (and pc, which stays at the header) over as many iterations as fit in
+    // budget instructions and returns how many instructions that was; 0
+    // leaves everything untouched.
+    std::size_t fastForward(std::size_t idx, Registers& regs, Stack& stack, uint64_t& pc, ExecState& st,
+                            std::size_t budget);
+
+    std::size_t iterationsSkipped() const { return iterations_; }
+
+private:
+    const AsmProgram& prog_;
+    bool verify_;
+    std::vector<LoopSummary> summaries_;
+    std::vector<uint32_t> summaryAt_; // instruction index -> summary, or kNone
+    std::size_t iterations_{0};
+};
+
+} // namespace arm64
+
+#endif // ARM64_LOOPS_HPP
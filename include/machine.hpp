@@ -0,0 +1,146 @@
+/*
+* ARM64 Machine
+*
+* The emulator as one embeddable object: a loaded program with its
+* registers, stack, guest memory and run loop, built into the arm64emu
+* library that the command-line tools link against.
+*
+* - load() takes an assembly listing or a static AArch64 ELF executable;
+*   loadText() a listing already in memory. Either resets the machine:
+*   registers, stack, guest memory and ExecState's per-run fields.
+* - run() executes until the program stops or a RunLimits budget runs out;
+*   runUntil() also stops when PC reaches an address; step() executes one
+*   instruction. A run that stopped on a limit (or a breakpoint) resumes
+*   where it left off on the next call; an ended program stays ended.
+* - The step limit is exact and the timeout is polled at block boundaries
+*   (watchdog.hpp). The step count for the limit starts at each call;
+*   steps() is the total over the machine's life.
+* - Unless MachineOptions::singleStep is set, runs over a whole program
+*   execute superinstructions and, with fastLoops, skip counted-loop
+*   iterations (loops.hpp). runUntil() and step() go one instruction at a
+*   time so they can stop anywhere.
+* - onFetch() installs a callback given each instruction the loop dispatches
+*   before it runs: every instruction when single-stepping, else the head of
+*   each superinstruction. Every basic block start is dispatched.
+* - Registers, stack, memory and ExecState are reachable directly for
+*   inspection between runs; readMemory()/writeMemory() reach any mapped
+*   guest address. An instruction error throws std::runtime_error and
+*   leaves the machine stopped with StopReason::Error.
+*
+* Author: Kyle Mather and Braeden Allen
+*/
+
+#ifndef ARM64_MACHINE_HPP
+#define ARM64_MACHINE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "elf_loader.hpp"
+#include "executor.hpp"
+#include "lazy_program.hpp"
+#include "loops.hpp"
+#include "memory.hpp"
+#include "optimize.hpp"
+#include "parser.hpp"
+#include "registers.hpp"
+#include "stack.hpp"
+#include "watchdog.hpp"
+
+namespace arm64 {
+
+struct MachineOptions {
+    std::size_t lazyCache{0};  // listing files: decode on demand, caching this many; 0 = up front
+    bool useCache{false};      // listings: reuse/refresh a compiled image (image.hpp)
+    std::string imagePath;     // ... at this path; empty = "<listing>.a64img"
+    bool optimize{false};      // optimizeProgram() after loading
+    bool fastLoops{false};     // skip counted-loop iterations (LoopAccelerator)
+    bool verifyLoops{false};   // ... interpreting them and checking the closed form
+    bool randomStack{false};   // fill the stack with pseudo-random bytes on load
+    bool singleStep{false};    // never run superinstructions or skip loops
+};
+
+class Machine {
+public:
+    using FetchHook = std::function<void(const AsmInst&)>;
+
+    explicit Machine(MachineOptions opts = {});
+
+    Machine(const Machine&) = delete;
+    Machine& operator=(const Machine&) = delete;
+
+    // path is a listing or a static ELF; args/env become the ELF process's
+    // argv/envp (args defaults to {path}). Throws std::runtime_error.
+    void load(const std::string& path, std::vector<std::string> args = {},
+              const std::vector<std::string>& env = {});
+    void loadText(std::string_view listing);
+
+    StopReason run(const RunLimits& limits = {});
+    StopReason runUntil(uint64_t addr, const RunLimits& limits = {});
+    // Execute one instruction (stopReason() is then StepLimit unless the
+    // program stopped); false once the program has stopped.
+    bool step();
+
+    // Why the last run stopped, and whether the program can go on.
+    StopReason stopReason() const { return reason_; }
+    bool finished() const { return finished_; }
+
+    void onFetch(FetchHook hook) { fetchHook_ = std::move(hook); }
+
+    uint64_t pc() const { return pc_; }
+    void     setPc(uint64_t pc); // also lets an ended program run again
+    std::size_t steps() const { return steps_; }
+
+    Registers&       registers()       { return regs_; }
+    const Registers& registers() const { return regs_; }
+    Stack&           stack()           { return stack_; }
+    const Stack&     stack() const     { return stack_; }
+    Memory&          memory()          { return *memory_; }
+    ExecState&       exec()            { return exec_; }
+    const ExecState& exec() const      { return exec_; }
+
+    // Copy guest bytes (stack or guest memory); throws if any are unmapped.
+    void readMemory(uint64_t addr, void* dst, std::size_t n);
+    void writeMemory(uint64_t addr, const void* src, std::size_t n);
+
+    // The whole decoded program, or nullptr for a lazily decoded listing.
+    const AsmProgram*  program() const { return prog_.get(); }
+    std::size_t        instructionCount() const;
+    uint64_t           endAddress() const { return endAddr_; }
+    const OptimizeStats& optimizeStats() const { return optStats_; }
+    const LoopAccelerator* loops() const { return loops_.get(); }
+
+private:
+    MachineOptions opts_;
+    Parser parser_;
+    std::unique_ptr<AsmProgram>    prog_;
+    std::unique_ptr<LazyProgram>   lazy_;
+    std::unique_ptr<ElfExecutable> elf_;
+    std::unique_ptr<LoopAccelerator> loops_;
+    OptimizeStats optStats_;
+
+    Registers regs_;
+    Stack stack_{/*base=*/0x0};
+    std::unique_ptr<Memory> memory_;
+    ExecState exec_;
+    uint64_t pc_{0};
+    uint64_t endAddr_{0};
+    std::size_t steps_{0};
+    StopReason reason_{StopReason::End};
+    bool finished_{false};
+    FetchHook fetchHook_;
+
+    void reset(std::vector<std::string> args, const std::vector<std::string>& env);
+    const AsmInst* fetch();
+    uint8_t* guestBytes(uint64_t addr, std::size_t n);
+    StopReason runLoop(const RunLimits& limits, bool stopAt, uint64_t until, bool once = false);
+};
+
+} // namespace arm64
+
+#endif // ARM64_MACHINE_HPP
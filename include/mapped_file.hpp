@@ -0,0 +1,55 @@
+/*
+* Read-only Memory-Mapped File
+*
+* Small RAII wrapper used to read listings and program images without
+* copying them into std::string first.
+*
+* - mmap() on POSIX, CreateFileMapping/MapViewOfFile on Windows.
+* - Exposes the mapping as a std::string_view; empty files map to "".
+* - Move-only; the mapping is released in the destructor.
+* - Throws std::runtime_error if the file cannot be opened or mapped.
+*
+* Author: Kyle Mather and Braeden Allen
+*/
+
+#ifndef ARM64_MAPPED_FILE_HPP
+#define ARM64_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace arm64 {
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const char*      data() const { return data_; }
+    std::size_t      size() const { return size_; }
+    std::string_view view() const { return std::string_view(data_ ? data_ : "", size_); }
+
+    // Returns false instead of throwing when the file does not exist.
+    static bool exists(const std::string& path);
+
+private:
+    void release();
+
+    const char* data_{nullptr};
+    std::size_t size_{0};
+#if defined(_WIN32)
+    void* file_{nullptr};
+    void* mapping_{nullptr};
+#endif
+};
+
+} // namespace arm64
+
+#endif // ARM64_MAPPED_FILE_HPP
@@ -0,0 +1,87 @@
+/*
+* ARM64 Guest Heap Memory
+*
+* Guest memory beyond the 256-byte Stack: the brk heap and anonymous mmap
+* regions requested through SVC (see syscalls.hpp).
+*
+* - Every region is backed by a host reservation (mmap PROT_NONE on POSIX,
+*   VirtualAlloc MEM_RESERVE on Windows). Committed pages take no host
+*   memory until the guest touches them, and read as zero the first time.
+* - The brk heap reserves kBrkReserve bytes up front and commits pages as
+*   the break grows; shrinking the break decommits the released pages.
+* - mmap regions are placed upwards from kMmapBase; munmap may cover whole
+*   regions or any page range inside them (splitting a region), and a host
+*   reservation is released once none of it is mapped any more.
+* - translate() is how the executor and syscalls reach guest bytes; it
+*   returns nullptr for addresses that are not mapped.
+*
+* Author: Kyle Mather and Braeden Allen
+*/
+
+#ifndef ARM64_MEMORY_HPP
+#define ARM64_MEMORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+
+namespace arm64 {
+
+class Memory {
+public:
+    static constexpr uint64_t kPageSize      = 4096;
+    static constexpr uint64_t kDefaultBrkBase = 0x10000000ull;  // 256 MiB
+    static constexpr uint64_t kBrkReserve     = 1ull << 30;     // 1 GiB of heap at most
+    static constexpr uint64_t kMmapBase       = 0x100000000ull; // 4 GiB
+    static constexpr uint64_t kMaxMapping     = 1ull << 36;     // largest single mmap
+
+    explicit Memory(uint64_t brkBase = kDefaultBrkBase);
+    ~Memory();
+
+    Memory(const Memory&) = delete;
+    Memory& operator=(const Memory&) = delete;
+
+    // Linux brk(): move the break to request and return the new break, or
+    // return the current break unchanged if request is 0 or out of range.
+    uint64_t brk(uint64_t request);
+    uint64_t brkBase() const { return brkBase_; }
+
+    // Map len bytes (rounded up to pages) of zeroed memory; 0 on failure.
+    uint64_t mmap(uint64_t len);
+
+    // Map zeroed pages covering [addr, addr + len) at that address (ELF
+    // segments, the process stack); false if any of it is already in use.
+    bool map(uint64_t addr, uint64_t len);
+
+    // Unmap [addr, addr + len) rounded out to pages. false if addr is not
+    // page aligned or len is 0; unmapped pages inside the range are ignored.
+    bool munmap(uint64_t addr, uint64_t len);
+
+    // Host pointer to guest [addr, addr + len) when it lies inside a single
+    // mapping, else nullptr.
+    uint8_t* translate(uint64_t addr, uint64_t len);
+
+private:
+    // One host reservation; released when the last region using it goes.
+    struct Reservation;
+
+    struct Region {
+        uint64_t end;                       // one past the last guest byte
+        std::shared_ptr<Reservation> host;
+        uint64_t hostOff;                   // offset of the region start in host
+    };
+
+    uint64_t brkBase_;
+    uint64_t brkCur_;
+    std::unique_ptr<Reservation> brkHost_;
+    uint64_t mmapNext_{kMmapBase};
+    std::map<uint64_t, Region> regions_;    // keyed by guest start address
+
+    bool inUse(uint64_t start, uint64_t end) const;
+    bool addRegion(uint64_t start, uint64_t end);
+};
+
+} // namespace arm64
+
+#endif // ARM64_MEMORY_HPP
@@ -0,0 +1,389 @@
+/*
+* ARM64 Mnemonic Table
+*
+* This header maps assembly mnemonics to the opcode enum used by the
+* parser and executor, so neither has to dispatch on strings.
+*
+* - Opcode / Cond enums shared by the parser, predecoder and executor.
+* - kMnemonics is the single table of supported spellings; adding an
+*   instruction (or a B.<cond> alias) is one row here.
+* - kCondNames spells the condition codes used as operands (CSEL, CCMP...).
+* - Mnemonics shared by scalar and vector instructions (ADD v0.4s, ...) map
+*   to a separate vector opcode once the operands are known (vectorForm()).
+* - A minimal perfect hash over that table is built at compile time
+*   (hash-and-displace), so lookupMnemonic() is one pass over the text,
+*   two table reads and a final case-insensitive compare.
+*
+* Author: Kyle Mather and Braeden Allen
+*/
+
+#ifndef ARM64_OPCODES_HPP
+#define ARM64_OPCODES_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace arm64 {
+
+enum class Opcode : uint8_t {
+    Unknown,
+    Nop,
+    Mov,
+    Movz, Movn, Movk,            // wide immediates
+    Add, Sub, And, Orr, Eor, Mul,
+    Madd, Msub, Mneg,            // multiply-accumulate
+    Smull, Umull, Smulh, Umulh,  // widening / high-half multiplies
+    Sdiv, Udiv,
+    Adds, Subs, Ands,            // flag-setting forms
+    Adc, Adcs, Sbc, Sbcs,        // carry chains
+    Lsl, Lsr, Asr, Ror,          // immediate (UBFM/SBFM/EXTR aliases) or register (xxxV) shifts
+    Ubfm, Sbfm, Bfm,             // bitfield moves
+    Ubfx, Sbfx, Ubfiz, Sbfiz, Bfi, Bfxil,
+    Uxtb, Uxth, Sxtb, Sxth, Sxtw, // aliases of the above
+    Cmp, Cmn, Tst,
+    Csel, Csinc, Csinv, Csneg,   // conditional select
+    Cset, Csetm, Cinc, Cinv, Cneg, // aliases of the above
+    Ccmp, Ccmn,
+    Ldr, Ldrb, Ldrh, Str, Strb, Strh,
+    Ldrsb, Ldrsh, Ldrsw,         // sign-extending loads
+    Ldp, Stp,                    // register pairs
+    Ld1, St1,                    // AdvSIMD: multiple single-element structures
+    VAdd, VSub, VMul, VAnd, VOrr, VEor, VMov, // vector forms of shared mnemonics
+    Cmeq, Addv, Dup, Ins, Umov,
+    VLdr, VStr,                  // LDR/STR of Bt/Ht/St/Dt/Qt
+    Fmov, Fadd, Fsub, Fmul, Fdiv, Fmadd, Fmsub, Fneg, Fabs, Fsqrt,
+    Fcmp, Fcmpe, Fcvt, Fcvtzs, Fcvtzu, Scvtf, Ucvtf,
+    Mrs, Msr,                    // NZCV, FPCR, FPSR, TPIDR_EL0
+    Svc,                         // Linux syscalls (syscalls.hpp)
+    Udf,                         // UDF / ".inst" words: an error if executed
+    B, BCond,
+    Bl, Blr, Br,
+    Cbz, Cbnz, Tbz, Tbnz,
+    Ret,
+};
+
+// Condition codes in their architectural encoding order.
+enum class Cond : uint8_t {
+    EQ, NE, CS, CC, MI, PL, VS, VC,
+    HI, LS, GE, LT, GT, LE, AL, NV,
+};
+
+struct CondName {
+    std::string_view name; // uppercase spelling
+    Cond cond;
+};
+
+// Condition operand / suffix spellings, including the HS and LO aliases.
+inline constexpr CondName kCondNames[] = {
+    {"EQ", Cond::EQ}, {"NE", Cond::NE}, {"CS", Cond::CS}, {"HS", Cond::CS},
+    {"CC", Cond::CC}, {"LO", Cond::CC}, {"MI", Cond::MI}, {"PL", Cond::PL},
+    {"VS", Cond::VS}, {"VC", Cond::VC}, {"HI", Cond::HI}, {"LS", Cond::LS},
+    {"GE", Cond::GE}, {"LT", Cond::LT}, {"GT", Cond::GT}, {"LE", Cond::LE},
+    {"AL", Cond::AL}, {"NV", Cond::NV},
+};
+
+struct MnemonicInfo {
+    std::string_view name; // uppercase spelling
+    Opcode op;
+    Cond   cond;           // AL unless the mnemonic carries a condition suffix
+};
+
+inline constexpr MnemonicInfo kMnemonics[] = {
+    {"NOP",    Opcode::Nop,    Cond::AL},
+    {"MOV",    Opcode::Mov,    Cond::AL},
+    {"MOVZ",   Opcode::Movz,   Cond::AL},
+    {"MOVN",   Opcode::Movn,   Cond::AL},
+    {"MOVK",   Opcode::Movk,   Cond::AL},
+    {"ADD",    Opcode::Add,    Cond::AL},
+    {"SUB",    Opcode::Sub,    Cond::AL},
+    {"AND",    Opcode::And,    Cond::AL},
+    {"ORR",    Opcode::Orr,    Cond::AL},
+    {"EOR",    Opcode::Eor,    Cond::AL},
+    {"MUL",    Opcode::Mul,    Cond::AL},
+    {"MADD",   Opcode::Madd,   Cond::AL},
+    {"MSUB",   Opcode::Msub,   Cond::AL},
+    {"MNEG",   Opcode::Mneg,   Cond::AL},
+    {"SMULL",  Opcode::Smull,  Cond::AL},
+    {"UMULL",  Opcode::Umull,  Cond::AL},
+    {"SMULH",  Opcode::Smulh,  Cond::AL},
+    {"UMULH",  Opcode::Umulh,  Cond::AL},
+    {"SDIV",   Opcode::Sdiv,   Cond::AL},
+    {"UDIV",   Opcode::Udiv,   Cond::AL},
+    {"ADDS",   Opcode::Adds,   Cond::AL},
+    {"SUBS",   Opcode::Subs,   Cond::AL},
+    {"ANDS",   Opcode::Ands,   Cond::AL},
+    {"ADC",    Opcode::Adc,    Cond::AL},
+    {"ADCS",   Opcode::Adcs,   Cond::AL},
+    {"SBC",    Opcode::Sbc,    Cond::AL},
+    {"SBCS",   Opcode::Sbcs,   Cond::AL},
+    {"LSL",    Opcode::Lsl,    Cond::AL},
+    {"LSR",    Opcode::Lsr,    Cond::AL},
+    {"ASR",    Opcode::Asr,    Cond::AL},
+    {"ROR",    Opcode::Ror,    Cond::AL},
+    {"UBFM",   Opcode::Ubfm,   Cond::AL},
+    {"SBFM",   Opcode::Sbfm,   Cond::AL},
+    {"BFM",    Opcode::Bfm,    Cond::AL},
+    {"UBFX",   Opcode::Ubfx,   Cond::AL},
+    {"SBFX",   Opcode::Sbfx,   Cond::AL},
+    {"UBFIZ",  Opcode::Ubfiz,  Cond::AL},
+    {"SBFIZ",  Opcode::Sbfiz,  Cond::AL},
+    {"BFI",    Opcode::Bfi,    Cond::AL},
+    {"BFXIL",  Opcode::Bfxil,  Cond::AL},
+    {"UXTB",   Opcode::Uxtb,   Cond::AL},
+    {"UXTH",   Opcode::Uxth,   Cond::AL},
+    {"SXTB",   Opcode::Sxtb,   Cond::AL},
+    {"SXTH",   Opcode::Sxth,   Cond::AL},
+    {"SXTW",   Opcode::Sxtw,   Cond::AL},
+    {"CMP",    Opcode::Cmp,    Cond::AL},
+    {"CMN",    Opcode::Cmn,    Cond::AL},
+    {"TST",    Opcode::Tst,    Cond::AL},
+    {"CSEL",   Opcode::Csel,   Cond::AL},
+    {"CSINC",  Opcode::Csinc,  Cond::AL},
+    {"CSINV",  Opcode::Csinv,  Cond::AL},
+    {"CSNEG",  Opcode::Csneg,  Cond::AL},
+    {"CSET",   Opcode::Cset,   Cond::AL},
+    {"CSETM",  Opcode::Csetm,  Cond::AL},
+    {"CINC",   Opcode::Cinc,   Cond::AL},
+    {"CINV",   Opcode::Cinv,   Cond::AL},
+    {"CNEG",   Opcode::Cneg,   Cond::AL},
+    {"CCMP",   Opcode::Ccmp,   Cond::AL},
+    {"CCMN",   Opcode::Ccmn,   Cond::AL},
+    {"LDR",    Opcode::Ldr,    Cond::AL},
+    {"LDRB",   Opcode::Ldrb,   Cond::AL},
+    {"LDRH",   Opcode::Ldrh,   Cond::AL},
+    {"STR",    Opcode::Str,    Cond::AL},
+    {"STRB",   Opcode::Strb,   Cond::AL},
+    {"STRH",   Opcode::Strh,   Cond::AL},
+    {"LDRSB",  Opcode::Ldrsb,  Cond::AL},
+    {"LDRSH",  Opcode::Ldrsh,  Cond::AL},
+    {"LDRSW",  Opcode::Ldrsw,  Cond::AL},
+    {"LDP",    Opcode::Ldp,    Cond::AL},
+    {"STP",    Opcode::Stp,    Cond::AL},
+    {"LD1",    Opcode::Ld1,    Cond::AL},
+    {"ST1",    Opcode::St1,    Cond::AL},
+    {"CMEQ",   Opcode::Cmeq,   Cond::AL},
+    {"ADDV",   Opcode::Addv,   Cond::AL},
+    {"DUP",    Opcode::Dup,    Cond::AL},
+    {"INS",    Opcode::Ins,    Cond::AL},
+    {"UMOV",   Opcode::Umov,   Cond::AL},
+    {"FMOV",   Opcode::Fmov,   Cond::AL},
+    {"FADD",   Opcode::Fadd,   Cond::AL},
+    {"FSUB",   Opcode::Fsub,   Cond::AL},
+    {"FMUL",   Opcode::Fmul,   Cond::AL},
+    {"FDIV",   Opcode::Fdiv,   Cond::AL},
+    {"FMADD",  Opcode::Fmadd,  Cond::AL},
+    {"FMSUB",  Opcode::Fmsub,  Cond::AL},
+    {"FNEG",   Opcode::Fneg,   Cond::AL},
+    {"FABS",   Opcode::Fabs,   Cond::AL},
+    {"FSQRT",  Opcode::Fsqrt,  Cond::AL},
+    {"FCMP",   Opcode::Fcmp,   Cond::AL},
+    {"FCMPE",  Opcode::Fcmpe,  Cond::AL},
+    {"FCVT",   Opcode::Fcvt,   Cond::AL},
+    {"FCVTZS", Opcode::Fcvtzs, Cond::AL},
+    {"FCVTZU", Opcode::Fcvtzu, Cond::AL},
+    {"SCVTF",  Opcode::Scvtf,  Cond::AL},
+    {"UCVTF",  Opcode::Ucvtf,  Cond::AL},
+    {"MRS",    Opcode::Mrs,    Cond::AL},
+    {"MSR",    Opcode::Msr,    Cond::AL},
+    {"SVC",    Opcode::Svc,    Cond::AL},
+    {"UDF",    Opcode::Udf,    Cond::AL},
+    {".INST",  Opcode::Udf,    Cond::AL},
+    {"B",      Opcode::B,      Cond::AL},
+    {"B.EQ",   Opcode::BCond,  Cond::EQ},
+    {"B.NE",   Opcode::BCond,  Cond::NE},
+    {"B.CS",   Opcode::BCond,  Cond::CS},
+    {"B.HS",   Opcode::BCond,  Cond::CS},
+    {"B.CC",   Opcode::BCond,  Cond::CC},
+    {"B.LO",   Opcode::BCond,  Cond::CC},
+    {"B.MI",   Opcode::BCond,  Cond::MI},
+    {"B.PL",   Opcode::BCond,  Cond::PL},
+    {"B.VS",   Opcode::BCond,  Cond::VS},
+    {"B.VC",   Opcode::BCond,  Cond::VC},
+    {"B.HI",   Opcode::BCond,  Cond::HI},
+    {"B.LS",   Opcode::BCond,  Cond::LS},
+    {"B.GE",   Opcode::BCond,  Cond::GE},
+    {"B.LT",   Opcode::BCond,  Cond::LT},
+    {"B.GT",   Opcode::BCond,  Cond::GT},
+    {"B.LE",   Opcode::BCond,  Cond::LE},
+    {"B.AL",   Opcode::BCond,  Cond::AL},
+    {"B.NV",   Opcode::BCond,  Cond::NV},
+    {"BL",     Opcode::Bl,     Cond::AL},
+    {"BLR",    Opcode::Blr,    Cond::AL},
+    {"BR",     Opcode::Br,     Cond::AL},
+    {"CBZ",    Opcode::Cbz,    Cond::AL},
+    {"CBNZ",   Opcode::Cbnz,   Cond::AL},
+    {"TBZ",    Opcode::Tbz,    Cond::AL},
+    {"TBNZ",   Opcode::Tbnz,   Cond::AL},
+    {"RET",    Opcode::Ret,    Cond::AL},
+};
+
+namespace detail {
+
+constexpr char foldUpper(char c) {
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - ('a' - 'A')) : c;
+}
+
+// FNV-1a over the case-folded text
+constexpr uint64_t mnemonicHash(std::string_view s) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (char c : s) {
+        h ^= static_cast<uint8_t>(foldUpper(c));
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+// Second-level mix of the same hash with a per-bucket displacement seed
+constexpr uint64_t displace(uint64_t h, uint32_t seed) {
+    h ^= static_cast<uint64_t>(seed) * 0x9e3779b97f4a7c15ull;
+    h ^= h >> 31;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 29;
+    return h;
+}
+
+constexpr std::size_t nextPow2(std::size_t n) {
+    std::size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+constexpr std::size_t kMnemonicCount = sizeof(kMnemonics) / sizeof(kMnemonics[0]);
+constexpr std::size_t kSlotCount     = 2 * nextPow2(kMnemonicCount);
+constexpr std::size_t kBucketCount   = nextPow2(kMnemonicCount) / 2 ? nextPow2(kMnemonicCount) / 2 : 1;
+
+static_assert(kMnemonicCount < 0xFFFF, "slot table stores 16-bit entries");
+
+struct MnemonicHashTable {
+    std::array<uint16_t, kBucketCount> seeds{}; // displacement per first-level bucket
+    std::array<uint16_t, kSlotCount>   slots{}; // 0 = empty, else kMnemonics index + 1
+};
+
+// Hash-and-displace construction: place the largest buckets first, and for each
+// bucket search for a seed that sends all of its keys to free slots.
+constexpr MnemonicHashTable buildMnemonicHashTable() {
+    MnemonicHashTable t{};
+
+    std::array<uint64_t, kMnemonicCount> hashes{};
+    std::array<std::size_t, kBucketCount> counts{};
+    for (std::size_t i = 0; i < kMnemonicCount; ++i) {
+        hashes[i] = mnemonicHash(kMnemonics[i].name);
+        ++counts[hashes[i] & (kBucketCount - 1)];
+    }
+
+    std::array<std::size_t, kBucketCount> order{};
+    for (std::size_t b = 0; b < kBucketCount; ++b) order[b] = b;
+    for (std::size_t i = 1; i < kBucketCount; ++i) {
+        for (std::size_t j = i; j > 0 && counts[order[j]] > counts[order[j - 1]]; --j) {
+            std::size_t tmp = order[j]; order[j] = order[j - 1]; order[j - 1] = tmp;
+        }
+    }
+
+    for (std::size_t ob = 0; ob < kBucketCount; ++ob) {
+        const std::size_t b = order[ob];
+        if (counts[b] == 0) break;
+
+        bool placed = false;
+        for (uint32_t seed = 1; seed < 0xFFFF && !placed; ++seed) {
+            std::array<std::size_t, kMnemonicCount> taken{};
+            std::size_t nTaken = 0;
+            bool ok = true;
+            for (std::size_t i = 0; i < kMnemonicCount && ok; ++i) {
+                if ((hashes[i] & (kBucketCount - 1)) != b) continue;
+                const std::size_t s = displace(hashes[i], seed) & (kSlotCount - 1);
+                if (t.slots[s] != 0) { ok = false; break; }
+                t.slots[s] = static_cast<uint16_t>(i + 1);
+                taken[nTaken++] = s;
+            }
+            if (ok) {
+                t.seeds[b] = static_cast<uint16_t>(seed);
+                placed = true;
+            } else {
+                for (std::size_t k = 0; k < nTaken; ++k) t.slots[taken[k]] = 0;
+            }
+        }
+        if (!placed) throw "mnemonic perfect hash: no displacement seed found";
+    }
+    return t;
+}
+
+inline constexpr MnemonicHashTable kMnemonicHashTable = buildMnemonicHashTable();
+
+} // namespace detail
+
+// Case-insensitive lookup; returns nullptr for unsupported mnemonics.
+constexpr const MnemonicInfo* lookupMnemonic(std::string_view text) {
+    const uint64_t h = detail::mnemonicHash(text);
+    const uint16_t seed = detail::kMnemonicHashTable.seeds[h & (detail::kBucketCount - 1)];
+    const uint16_t slot = detail::kMnemonicHashTable.slots[detail::displace(h, seed) & (detail::kSlotCount - 1)];
+    if (slot == 0) return nullptr;
+
+    const MnemonicInfo& info = kMnemonics[slot - 1];
+    if (info.name.size() != text.size()) return nullptr;
+    for (std::size_t i = 0; i < text.size(); ++i)
+        if (detail::foldUpper(text[i]) != info.name[i]) return nullptr;
+    return &info;
+}
+
+// Case-insensitive condition name lookup ("lt", "HS", ...).
+constexpr const CondName* lookupCond(std::string_view text) {
+    for (const CondName& c : kCondNames) {
+        if (c.name.size() != text.size()) continue;
+        bool same = true;
+        for (std::size_t i = 0; i < text.size() && same; ++i)
+            same = detail::foldUpper(text[i]) == c.name[i];
+        if (same) return &c;
+    }
+    return nullptr;
+}
+
+// Index of the label operand of a direct branch, or -1.
+constexpr int branchLabelOperand(Opcode op) {
+    switch (op) {
+    case Opcode::B: case Opcode::BCond: case Opcode::Bl: return 0;
+    case Opcode::Cbz: case Opcode::Cbnz:                 return 1;
+    case Opcode::Tbz: case Opcode::Tbnz:                 return 2;
+    default:                                             return -1;
+    }
+}
+
+// Opcode for a shared mnemonic (ADD, MOV, ...) written with vector operands,
+// or op itself if it has no vector form.
+constexpr Opcode vectorForm(Opcode op) {
+    switch (op) {
+    case Opcode::Add: return Opcode::VAdd;
+    case Opcode::Sub: return Opcode::VSub;
+    case Opcode::Mul: return Opcode::VMul;
+    case Opcode::And: return Opcode::VAnd;
+    case Opcode::Orr: return Opcode::VOrr;
+    case Opcode::Eor: return Opcode::VEor;
+    case Opcode::Mov: return Opcode::VMov;
+    case Opcode::Ldr: return Opcode::VLdr;
+    case Opcode::Str: return Opcode::VStr;
+    default:          return op;
+    }
+}
+
+// Conditional select/compare instructions take their condition as the last operand.
+constexpr bool takesCondOperand(Opcode op) {
+    return op >= Opcode::Csel && op <= Opcode::Ccmn;
+}
+
+namespace detail {
+constexpr bool everyMnemonicResolves() {
+    for (const MnemonicInfo& m : kMnemonics)
+        if (lookupMnemonic(m.name) != &m) return false;
+    return true;
+}
+} // namespace detail
+
+static_assert(detail::everyMnemonicResolves(), "mnemonic perfect hash is not collision-free");
+static_assert(lookupMnemonic("b.gt") && lookupMnemonic("b.gt")->cond == Cond::GT,
+              "mnemonic lookup is case-insensitive");
+static_assert(lookupCond("lo") && lookupCond("lo")->cond == Cond::CC, "condition aliases resolve");
+
+} // namespace arm64
+
+#endif // ARM64_OPCODES_HPP
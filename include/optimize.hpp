@@ -0,0 +1,51 @@
+/*
+* ARM64 Predecoded-Program Optimizer
+*
+* An optional pass over a built AsmProgram that removes work the emulator
+* would otherwise repeat, without changing what the guest observes at the
+* end of a basic block.
+*
+* - Each basic block (blockLeaders(), cfg.hpp) is cut into windows of at
+*   most kMaxFusedLength instructions, and each window is analysed on its
+*   own: nothing is known on entry and every register is live on exit.
+* - Constant propagation: ALU results whose sources are all known become a
+*   plain constant load (OptAction::Const).
+* - Redundant reloads: a LDR/LDRB/LDRH of an address just stored to or loaded
+*   from at the same width, with neither the address registers nor the
+*   value's register changed since, becomes a register move or nothing.
+* - Dead writes: a pure ALU result (or a rewritten load) that a later member
+*   of the window overwrites before anything reads it is skipped.
+* - Loads that are kept, stores, flag writes and branches run unchanged;
+*   SVC and anything not modelled here end what the pass knows.
+* - The rewrites live in the members' Predecoded blocks and are applied by
+*   executeFused() only for a window entered at its head (Fusion::Block);
+*   entering elsewhere runs the original instructions.
+* - A window that faults part way may have skipped a write that a later
+*   member would have made; the run ends with the error either way.
+*
+* Author: Kyle Mather and Braeden Allen
+*/
+
+#ifndef ARM64_OPTIMIZE_HPP
+#define ARM64_OPTIMIZE_HPP
+
+#include <cstddef>
+
+#include "executor.hpp"
+
+namespace arm64 {
+
+struct OptimizeStats {
+    std::size_t windows{0};   // windows given a Fusion::Block head
+    std::size_t folded{0};    // members turned into constant loads
+    std::size_t forwarded{0}; // reloads turned into moves or skipped
+    std::size_t dead{0};      // dead writes skipped
+};
+
+// Rewrite prog in place; run after fuseSuperinstructions(). The head of a
+// rewritten window gives up any superinstruction it headed.
+OptimizeStats optimizeProgram(AsmProgram& prog);
+
+} // namespace arm64
+
+#endif // ARM64_OPTIMIZE_HPP
@@ -6,8 +6,13 @@
 * with the instruction (registers, memory references, labels, etc.)
 *
 * - Strips comments, labels and blank lines before parsing.
+* - Tokenizes with std::string_view over the input line. Each instruction keeps
+*   one copy of its operand text in an OperandList, whose operands are views
+*   into it, held inline for up to three operands.
 * - Splits operands even when inside memory brackets.
-* - Classifies operands into types (Register, Immediate, Memory, Label).
+* - Classifies operands into types (Register, Immediate, Memory, Label,
+*   Shift, and AdvSIMD Vector registers / {braced} register lists).
+* - Resolves the mnemonic to an Opcode via the compile-time table in opcodes.hpp.
 * - Uses instruction-specific handlers for stricter parsing (ex. ADD, LDR, STR).
 * - Extensible design, additional instruction handlers can be added.
 
@@ -17,52 +22,140 @@
 #ifndef ARM64_PARSER_HPP
 #define ARM64_PARSER_HPP
 
+#include <array>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <optional>
 #include <cstdint>
 #include <iostream>
+#include <stdexcept>
+
+#include "opcodes.hpp"
 
 namespace arm64 {
 
 // Operand types
-enum class OperandType { Register, Immediate, Memory, Label };
+// Vector: an AdvSIMD/FP register ("v0.4s", "v1.s[2]", "s0", "q3");
+// VList: a braced register list ("{v0.16b, v1.16b}").
+enum class OperandType : uint8_t { Register, Immediate, Memory, Label, Shift, Vector, VList };
 
 struct Operand {
+    Operand() = default;
+    Operand(OperandType t, std::string_view raw, int64_t value = 0)
+        : imm(value), type(t), len_(static_cast<uint32_t>(raw.size())), raw_(raw.data()) {}
+
+    // raw token, a view into the owning OperandList's text
+    std::string_view raw() const { return {raw_, len_}; }
+
+    int64_t     imm{0}; // immediate value if applicable (shift amount for Shift)
     OperandType type{};
-    std::string raw; // raw token
-    int64_t     imm{0}; // immediate value if applicable
+
+private:
+    friend class OperandList;
+    uint32_t    len_{0};
+    const char* raw_{nullptr};
+};
+
+// Operand storage for one instruction. The operand text of the line is copied
+// once into the list and every Operand::raw() is a view into that copy, so the
+// tokenizer never builds a string per operand. The first kInline operands live
+// inline; a longer list moves to the heap. Copies and moves re-point the views
+// at the new owner's text.
+class OperandList {
+public:
+    static constexpr std::size_t kInline = 3;
+
+    OperandList() = default;
+    // text: the operands as written ("X0, [SP, #8]"), tokenized by the caller
+    // through text() and added with push_back()
+    explicit OperandList(std::string_view text) : text_(text) {}
+
+    OperandList(const OperandList& other) { *this = other; }
+    OperandList(OperandList&& other) noexcept { *this = std::move(other); }
+    OperandList& operator=(const OperandList& other);
+    OperandList& operator=(OperandList&& other) noexcept;
+
+    std::size_t size() const { return n_; }
+    bool        empty() const { return n_ == 0; }
+
+    Operand&       operator[](std::size_t i)       { return data()[i]; }
+    const Operand& operator[](std::size_t i) const { return data()[i]; }
+
+    const Operand& at(std::size_t i) const {
+        if (i >= n_) throw std::out_of_range("operand index out of range");
+        return data()[i];
+    }
+
+    // The text the operands view
+    std::string_view text() const { return text_; }
+
+    // op.raw() is either a view into text() or any other string, which is
+    // then appended to text() first
+    void push_back(Operand op);
+
+    Operand*       begin()       { return data(); }
+    Operand*       end()         { return data() + n_; }
+    const Operand* begin() const { return data(); }
+    const Operand* end()   const { return data() + n_; }
+
+private:
+    std::string text_;
+    std::array<Operand, kInline> inline_{};
+    std::unique_ptr<Operand[]> heap_; // all operands once there are more than kInline
+    uint32_t n_{0};
+    uint32_t cap_{0};                 // of heap_
+
+    Operand*       data()       { return heap_ ? heap_.get() : inline_.data(); }
+    const Operand* data() const { return heap_ ? heap_.get() : inline_.data(); }
+    // Point every view that was into the buffer at from into text_ instead
+    void rebase(const char* from);
 };
 
 struct DecodedInstruction {
     std::string mnem;
-    std::vector<Operand> operands;
+    OperandList operands;
+    Opcode      op{Opcode::Unknown}; // resolved once from mnem by the parser
+    Cond        cond{Cond::AL};      // B.<cond> suffix or CSEL/CCMP-style condition operand, AL otherwise
 };
 
-// Base handler
+// Base handler. Handlers are stateless; Parser keeps one shared instance of each.
 struct InstructionHandler {
     virtual ~InstructionHandler() = default;
-    virtual DecodedInstruction parse(const std::string& mnem, const std::vector<Operand>& ops) const = 0;
+    virtual DecodedInstruction parse(std::string_view mnem, OperandList&& ops) const = 0;
 };
 
 // Concrete handlers for different instruction types
 struct GenericHandler final : InstructionHandler {
-    DecodedInstruction parse(const std::string& mnem, const std::vector<Operand>& ops) const override;
+    DecodedInstruction parse(std::string_view mnem, OperandList&& ops) const override;
 };
 
 struct AddHandler final : InstructionHandler {
-    DecodedInstruction parse(const std::string& mnem, const std::vector<Operand>& ops) const override;
+    DecodedInstruction parse(std::string_view mnem, OperandList&& ops) const override;
 };
 
 struct LdrHandler final : InstructionHandler {
-    DecodedInstruction parse(const std::string& mnem, const std::vector<Operand>& ops) const override;
+    DecodedInstruction parse(std::string_view mnem, OperandList&& ops) const override;
+};
+
+// CSEL, CSET, CCMP, ...: resolves the trailing condition operand into cond.
+struct CondHandler final : InstructionHandler {
+    DecodedInstruction parse(std::string_view mnem, OperandList&& ops) const override;
 };
 
 // Parser class used in src/parser_main.cpp
 class Parser {
 public:
-    // Parse a single line of assembly
-    std::optional<DecodedInstruction> parseLine(const std::string& line) const;
+    // Parse a single line of assembly. The view only needs to stay valid for
+    // the duration of the call; the result owns its text.
+    std::optional<DecodedInstruction> parseLine(std::string_view line) const;
+
+    // The "mnemonic operands" slice of line once comments, an objdump address
+    // prefix and opcode word are stripped; empty if the line holds no
+    // instruction. Cheap (no allocation), for indexing a listing without
+    // decoding it.
+    std::string_view instructionText(std::string_view line) const;
 };
 
 // Print function called in src/parser_main.cpp
@@ -8,7 +8,15 @@
 * - Provides accessors for both 64-bit and 32-bit views.
 * - Emulates XZR/WZR behavior.
 * - Includes Stack Pointer and Program Counter.
-* - Maintains processor state flags for conditional execution.
+* - X0-X30, a zero/write-sink slot for XZR and SP share one flat array so
+*   predecoded instructions can access any of them by slot index with no
+*   branches (see get()/set()/clearZeroSlot()).
+* - Holds the 32 128-bit AdvSIMD registers V0-V31 (see VReg); the scalar
+*   FP registers Sn/Dn are their low 32/64 bits.
+* - Holds FPCR (rounding mode) and FPSR for floating point, and TPIDR_EL0,
+*   the thread pointer a C library's TLS setup writes with MSR.
+* - Maintains processor state flags for conditional execution; flags are
+*   evaluated lazily from the last flag-setting operation.
 * - Includes a print() function for human readable registers.
 *
 * Author: Kyle Mather and Braeden Allen
@@ -19,43 +27,237 @@
 
 #include <array>
 #include <cstdint>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 
 namespace arm64 {
 
-// Processor state flags
-struct ProcessorState {
-    bool N{false}; // Negative
-    bool Z{false}; // Zero
-    bool C{false}; // Carry (for subs: NOT borrow)
-    bool V{false}; // Overflow (signed)
+namespace detail {
+
+// kCondTable[cond] has bit n set when cond holds for packed NZCV value n.
+constexpr std::array<uint16_t, 16> buildCondTable() {
+    std::array<uint16_t, 16> t{};
+    for (unsigned code = 0; code < 16; ++code) {
+        for (unsigned n = 0; n < 16; ++n) {
+            const bool N = (n >> 3) & 1, Z = (n >> 2) & 1, C = (n >> 1) & 1, V = n & 1;
+            bool r = true;
+            switch (code >> 1) {
+            case 0: r = Z; break;
+            case 1: r = C; break;
+            case 2: r = N; break;
+            case 3: r = V; break;
+            case 4: r = C && !Z; break;
+            case 5: r = (N == V); break;
+            case 6: r = !Z && (N == V); break;
+            default: break;
+            }
+            if (code < 14 && (code & 1)) r = !r;
+            if (r) t[code] = static_cast<uint16_t>(t[code] | (1u << n));
+        }
+    }
+    return t;
+}
+
+} // namespace detail
+
+// a + b + carryIn with the carry out of bit 63; uses the host's add-with-
+// overflow builtins where available.
+inline uint64_t addWithCarry(uint64_t a, uint64_t b, uint64_t carryIn, bool& carryOut) {
+#if defined(__GNUC__) || defined(__clang__)
+    uint64_t t = 0, r = 0;
+    const bool c1 = __builtin_add_overflow(a, b, &t);
+    const bool c2 = __builtin_add_overflow(t, carryIn, &r);
+    carryOut = c1 || c2;
+    return r;
+#else
+    const uint64_t t = a + b;
+    const uint64_t r = t + carryIn;
+    carryOut = (t < a) || (r < t);
+    return r;
+#endif
+}
+
+// Processor state flags, evaluated lazily.
+//
+// Flag-setting instructions only record their operands and width (setSub,
+// setAdd, setLogic); condition() answers one condition code from them, and
+// NZCV are only materialized when asked for (nzcv(), carry(), print).
+// Operands are stored shifted to the top of the 64-bit word, so 32-bit
+// operations use the same 64-bit comparisons and the same N/Z/C/V as 64-bit
+// ones. Subtractions (CMP/SUBS) are answered with direct compares; other
+// kinds pack NZCV and test it through a 16-entry condition table.
+class ProcessorState {
+public:
+    struct Nzcv {
+        bool N{false}; // Negative
+        bool Z{false}; // Zero
+        bool C{false}; // Carry (for subs: NOT borrow)
+        bool V{false}; // Overflow (signed)
+    };
+
+    // Record a - b computed at the given width (32 or 64).
+    void setSub(uint64_t a, uint64_t b, unsigned width) {
+        const unsigned sh = 64u - width;
+        a_ = a << sh;
+        b_ = b << sh;
+        kind_ = Kind::Sub;
+    }
+
+    // Record a + b + carryIn (ADDS, CMN, ADCS; SUBS-with-borrow as a + ~b + C).
+    void setAdd(uint64_t a, uint64_t b, bool carryIn, unsigned width) {
+        const unsigned sh = 64u - width;
+        a_ = a << sh;
+        b_ = b << sh;
+        cin_ = static_cast<uint64_t>(carryIn) << sh;
+        kind_ = Kind::Add;
+    }
+
+    // Record a logical result (ANDS, TST): N and Z from res, C and V clear.
+    void setLogic(uint64_t res, unsigned width) {
+        a_ = res << (64u - width);
+        kind_ = Kind::Logic;
+    }
+
+    // Set the flags explicitly.
+    void setNzcv(const Nzcv& f) {
+        setNzcvBits(static_cast<unsigned>((f.N << 3) | (f.Z << 2) | (f.C << 1) | f.V));
+    }
+
+    // Set the flags from the A64 4-bit NZCV encoding (N = bit 3 ... V = bit 0).
+    void setNzcvBits(unsigned bits) {
+        bits_ = static_cast<uint8_t>(bits & 0xF);
+        kind_ = Kind::Nzcv;
+    }
+
+    // Materialize N, Z, C and V.
+    Nzcv nzcv() const {
+        const unsigned bits = nzcvBits();
+        Nzcv f;
+        f.N = (bits >> 3) & 1;
+        f.Z = (bits >> 2) & 1;
+        f.C = (bits >> 1) & 1;
+        f.V = bits & 1;
+        return f;
+    }
+
+    // The C flag alone (carry-in for ADC/SBC).
+    bool carry() const {
+        if (kind_ == Kind::Sub) return a_ >= b_;
+        return (nzcvBits() >> 1) & 1;
+    }
+
+    // Evaluate an A64 condition code (EQ=0, NE=1, ... AL=14, NV=15). Even
+    // codes test a condition and the following odd code is its inverse.
+    bool condition(unsigned code) const {
+        if (kind_ != Kind::Sub) return (kCondTable[code & 0xF] >> nzcvBits()) & 1;
+
+        bool r = true;
+        const int64_t sa = static_cast<int64_t>(a_);
+        const int64_t sb = static_cast<int64_t>(b_);
+        switch (code >> 1) {
+        case 0: r = (a_ == b_); break;                                  // EQ
+        case 1: r = (a_ >= b_); break;                                  // CS
+        case 2: r = (static_cast<int64_t>(a_ - b_) < 0); break;         // MI
+        case 3: r = ((((a_ ^ b_) & (a_ ^ (a_ - b_))) >> 63) & 1); break; // VS
+        case 4: r = (a_ > b_); break;                                   // HI
+        case 5: r = (sa >= sb); break;                                  // GE
+        case 6: r = (sa > sb); break;                                   // GT
+        default: return true;                                           // AL, NV
+        }
+        return r != static_cast<bool>(code & 1);
+    }
+
+private:
+    enum class Kind : uint8_t { Nzcv, Sub, Add, Logic };
+
+    static unsigned pack(bool N, bool Z, bool C, bool V) {
+        return (static_cast<unsigned>(N) << 3) | (static_cast<unsigned>(Z) << 2) |
+               (static_cast<unsigned>(C) << 1) | static_cast<unsigned>(V);
+    }
+
+    unsigned nzcvBits() const {
+        switch (kind_) {
+        case Kind::Sub: {
+            const uint64_t res = a_ - b_;
+            return pack(res >> 63, res == 0, a_ >= b_, ((a_ ^ b_) & (a_ ^ res)) >> 63);
+        }
+        case Kind::Add: {
+            bool c = false;
+            const uint64_t res = addWithCarry(a_, b_, cin_, c);
+            return pack(res >> 63, res == 0, c, ((a_ ^ res) & (b_ ^ res)) >> 63);
+        }
+        case Kind::Logic:
+            return pack(a_ >> 63, a_ == 0, false, false);
+        default:
+            return bits_;
+        }
+    }
+
+    static constexpr std::array<uint16_t, 16> kCondTable = detail::buildCondTable();
+
+    Kind     kind_{Kind::Nzcv};
+    uint8_t  bits_{0};
+    uint64_t a_{0};
+    uint64_t b_{0};
+    uint64_t cin_{0};
 };
 
+// One 128-bit AdvSIMD register. Lanes are stored in host byte order, element
+// 0 first, so on little-endian hosts the bytes are the architectural layout
+// and 128-bit host SIMD loads see the lanes in place.
+struct alignas(16) VReg {
+    uint8_t b[16]{};
 
+    // Element i of 1 << esz bytes (esz: 0 = B, 1 = H, 2 = S, 3 = D), zero-extended.
+    uint64_t lane(unsigned esz, unsigned i) const {
+        uint64_t v = 0;
+        std::memcpy(&v, b + (i << esz), std::size_t{1} << esz);
+        return v;
+    }
+    void setLane(unsigned esz, unsigned i, uint64_t v) {
+        std::memcpy(b + (i << esz), &v, std::size_t{1} << esz);
+    }
 
+    uint64_t lo() const { return lane(3, 0); }
+    uint64_t hi() const { return lane(3, 1); }
+    void clearHi() { std::memset(b + 8, 0, 8); } // 64-bit vector writes zero the top half
+};
 
 class Registers {
 public:
+    static constexpr unsigned kVRegs = 32;
+
+    static constexpr unsigned XZR_INDEX = 31; // index noting this is XZR
+    static constexpr unsigned SP_INDEX  = 32; // slot holding the stack pointer
+    static constexpr unsigned kSlots    = 33; // X0..X30, XZR, SP
+
     Registers() {
-        x_.fill(0);
-        sp_ = 0;
+        r_.fill(0);
         pc_ = 0;
     }
 
+    // Unchecked slot access for predecoded instructions. Reading XZR_INDEX
+    // yields 0 as long as the executor calls clearZeroSlot() after an
+    // instruction that may have written to it.
+    uint64_t get(unsigned slot) const     { return r_[slot]; }
+    void     set(unsigned slot, uint64_t v) { r_[slot] = v; }
+    void     clearZeroSlot()              { r_[XZR_INDEX] = 0; }
+
     // Read/write 64-bit Xn.
     uint64_t readX(unsigned n) const {
         if (n == XZR_INDEX) return 0;
         if (n > 30) throw std::out_of_range("readX: invalid index");
-        return x_[n];
+        return r_[n];
     }
 
     void writeX(unsigned n, uint64_t value) {
         if (n == XZR_INDEX) return; // writes to XZR are ignored
         if (n > 30) throw std::out_of_range("writeX: invalid index");
-        x_[n] = value;
+        r_[n] = value;
     }
 
     // Read/write 32-bit Wn aliases.
@@ -66,20 +268,34 @@ public:
     void writeW(unsigned n, uint32_t value) {
         if (n == XZR_INDEX) return; // writes to WZR are ignored
         if (n > 30) throw std::out_of_range("writeW: invalid index");
-        x_[n] = static_cast<uint64_t>(value);
+        r_[n] = static_cast<uint64_t>(value);
     }
 
     // Stack Pointer and Program Counter
-    uint64_t readSP() const { return sp_; }
-    void     writeSP(uint64_t v) { sp_ = v; } // Sets stack pointer to specified value
+    uint64_t readSP() const { return r_[SP_INDEX]; }
+    void     writeSP(uint64_t v) { r_[SP_INDEX] = v; } // Sets stack pointer to specified value
 
     uint64_t readPC() const { return pc_; }
     void     writePC(uint64_t v) { pc_ = v; } // Sets program counter to specified value
 
+    // V0-V31, unchecked like get()/set(); n comes from predecoded operands.
+    VReg&       v(unsigned n)       { return v_[n]; }
+    const VReg& v(unsigned n) const { return v_[n]; }
+
     // Processor state flags
     const ProcessorState& state() const { return psr_; }
     ProcessorState&       state()       { return psr_; }
 
+    // Floating-point control (FPCR.RMode in bits 23:22) and status registers
+    uint32_t fpcr() const { return fpcr_; }
+    void     setFpcr(uint32_t v) { fpcr_ = v; }
+    uint32_t fpsr() const { return fpsr_; }
+    void     setFpsr(uint32_t v) { fpsr_ = v; }
+
+    // TPIDR_EL0 (MRS/MSR); 0 at reset, as the kernel starts a thread
+    uint64_t tpidr() const { return tpidr_; }
+    void     setTpidr(uint64_t v) { tpidr_ = v; }
+
     // Printing to match the sample format
     void print(std::ostream& os) const {
         static constexpr const char* SEP =
@@ -101,23 +317,46 @@ public:
            << "PC: " << hex64(readPC()) << " "
            << "X30: " << hex64(readX(30)) << "\n\n";
 
-        os << "Processor State N bit: " << (psr_.N ? 1 : 0) << "\n\n";
-        os << "Processor State Z bit: " << (psr_.Z ? 1 : 0) << "\n";
+        const ProcessorState::Nzcv f = psr_.nzcv();
+        os << "Processor State N bit: " << (f.N ? 1 : 0) << "\n\n";
+        os << "Processor State Z bit: " << (f.Z ? 1 : 0) << "\n";
     }
 
-    static constexpr unsigned XZR_INDEX = 31; // index noting this is XZR
+    // V0-V31 as 128-bit hex values, two per line.
+    void printVector(std::ostream& os) const {
+        static constexpr const char* SEP =
+            "-------------------------------------------------------------------------------------------------------------------------------";
+
+        os << SEP << "\n\n";
+        os << "Vector Registers:\n\n";
+        os << SEP << "\n\n";
+        for (unsigned n = 0; n < kVRegs; n += 2) {
+            os << "V" << n << ": " << hex128(v_[n]) << " "
+               << "V" << (n + 1) << ": " << hex128(v_[n + 1]) << "\n\n";
+        }
+    }
 
 private:
+    static std::string hex128(const VReg& v) {
+        std::ostringstream ss;
+        ss << "0x" << std::hex << std::setfill('0') << std::nouppercase
+           << std::setw(16) << v.hi() << std::setw(16) << v.lo();
+        return ss.str();
+    }
+
     static std::string hex64(uint64_t v) {
         std::ostringstream ss;
         ss << "0x" << std::hex << std::setfill('0') << std::setw(16) << std::nouppercase << v;
         return ss.str();
     }
 
-    std::array<uint64_t, 31> x_{};
-    uint64_t sp_{0};
+    std::array<uint64_t, kSlots> r_{};
+    std::array<VReg, kVRegs> v_{};
     uint64_t pc_{0};
     ProcessorState psr_{};
+    uint32_t fpcr_{0};
+    uint32_t fpsr_{0};
+    uint64_t tpidr_{0};
 };
 
 } // namespace arm64
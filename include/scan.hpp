@@ -0,0 +1,63 @@
+/*
+* ARM64 Listing Scanner
+*
+* Byte-scanning primitives used by the parser and program builder to walk
+* assembly text a vector register at a time instead of one char at a time.
+*
+* - findFirstOf(): first byte matching a small set (newline, ':', ';', '/',
+*   '[' / ']', ',' ...), the building block for comment stripping, address
+*   prefix detection and bracket-aware operand splitting.
+* - spanHex() / spanHexOrSpace(): length of the leading hex-digit run, used to
+*   recognise objdump address prefixes and opcode words.
+* - forEachLine(): splits a whole in-memory listing into lines.
+* - AVX2 (when the compiler targets it), SSE2 (any x86-64 build) and a scalar
+*   fallback (also forced by defining ARM64_NO_SIMD); the path is chosen at
+*   compile time. The scan fixtures build this file once per path and check
+*   all of them against the same expected results.
+*
+* Author: Kyle Mather and Braeden Allen
+*/
+
+#ifndef ARM64_SCAN_HPP
+#define ARM64_SCAN_HPP
+
+#include <cstddef>
+#include <string_view>
+
+namespace arm64 {
+namespace scan {
+
+// Offset of the first byte of s that is in set, or npos. Sets of 1 to 4
+// bytes are scanned with SIMD; larger ones fall back to a scalar scan.
+std::size_t findFirstOf(std::string_view s, std::string_view set);
+
+// Offset of the first occurrence of c, or npos.
+inline std::size_t find(std::string_view s, char c) {
+    return findFirstOf(s, std::string_view(&c, 1));
+}
+
+// Length of the leading run of ASCII hex digits.
+std::size_t spanHex(std::string_view s);
+
+// Length of the leading run of ASCII hex digits and whitespace.
+std::size_t spanHexOrSpace(std::string_view s);
+
+// Name of the scanning path compiled in ("avx2", "sse2" or "scalar").
+const char* backend();
+
+// Calls f(line) for every line in buf (without the '\n'; a trailing '\r' is
+// left for the caller's trim). A final line without a newline is included.
+template <class F>
+void forEachLine(std::string_view buf, F&& f) {
+    while (!buf.empty()) {
+        const std::size_t nl = find(buf, '\n');
+        if (nl == std::string_view::npos) { f(buf); return; }
+        f(buf.substr(0, nl));
+        buf.remove_prefix(nl + 1);
+    }
+}
+
+} // namespace scan
+} // namespace arm64
+
+#endif // ARM64_SCAN_HPP
@@ -0,0 +1,47 @@
+/*
+* ARM64 AdvSIMD Lane Operations
+*
+* Integer vector kernels the executor uses for AdvSIMD instructions
+* (ADD, SUB, MUL, AND, ORR, EOR, CMEQ, ADDV, DUP) on VReg values.
+*
+* - Every kernel works on the full 128 bits; the executor clears the top
+*   half afterwards for 64-bit arrangements (8B, 4H, 2S, 1D).
+* - Element size is passed as esz (0 = B, 1 = H, 2 = S, 3 = D).
+* - SSE4.1 (when the compiler targets it), SSE2 (any x86-64 build) and a
+*   scalar fallback (also forced by defining ARM64_NO_SIMD); the path is
+*   chosen at compile time. The simd_* fixtures build this file once per
+*   path and check each against a lane-by-lane reference.
+*
+* Author: Kyle Mather and Braeden Allen
+*/
+
+#ifndef ARM64_SIMD_HPP
+#define ARM64_SIMD_HPP
+
+#include <cstdint>
+
+#include "registers.hpp"
+
+namespace arm64 {
+namespace simd {
+
+enum class BinOp : uint8_t { Add, Sub, Mul, And, Orr, Eor, Cmeq };
+
+// d = a op b in every lane. CMEQ sets a lane to all ones when equal, else 0.
+// MUL has no 64-bit lane form; callers reject esz 3 for it.
+void binary(BinOp op, unsigned esz, VReg& d, const VReg& a, const VReg& b);
+
+// Sum of the lanes in the low 64 bits (q = false) or all 128 bits, modulo the
+// element size.
+uint64_t addAcross(unsigned esz, const VReg& a, bool q);
+
+// Every lane of d set to v (truncated to the element size).
+void dup(unsigned esz, VReg& d, uint64_t v);
+
+// Name of the kernel path compiled in ("sse4.1", "sse2" or "scalar").
+const char* backend();
+
+} // namespace simd
+} // namespace arm64
+
+#endif // ARM64_SIMD_HPP
@@ -6,8 +6,11 @@
 *
 * - Provides a contiguous 256-byte buffer with a configurable base address.
 * - Little-endian layout for multi-byte values.
-* - Read/write helpers for bytes (read8/write8); 32-/64-bit helpers are
-*   implemented in the executor using these primitives.
+* - Read/write helpers for bytes (read8/write8) and byte blocks
+*   (readBlock/writeBlock); 32-/64-bit and pair helpers are implemented in
+*   the executor using these primitives.
+* - data() exposes the raw bytes so syscalls can hand guest buffers to the
+*   host without copying; callers bounds-check against size() themselves.
 * - Optional fill_random() to seed demo data.
 * - print_dump() pretty-prints a hex+ASCII view matching the spec.
 * - Bounds-checked accesses; throws on out-of-range operations.
@@ -42,6 +45,9 @@ public:
     uint64_t base() const { return base_; }
     std::size_t size() const { return stackSize; }
 
+    uint8_t*       data()       { return mem_.data(); }
+    const uint8_t* data() const { return mem_.data(); }
+
 
     // Fill with random bytes for random example, potentially used later on for testing
     void fillRandom(uint32_t seed = 0xC0FFEEu) {
@@ -96,6 +102,17 @@ public:
         return mem_[offset];
     }
 
+    // Multi-byte copies with one bounds check (LDP/STP move up to 16 bytes).
+    void readBlock(std::size_t offset, uint8_t* out, std::size_t n) const {
+        boundsCheck(offset, n);
+        std::memcpy(out, mem_.data() + offset, n);
+    }
+
+    void writeBlock(std::size_t offset, const uint8_t* in, std::size_t n) {
+        boundsCheck(offset, n);
+        std::memcpy(mem_.data() + offset, in, n);
+    }
+
 private:
     void boundsCheck(std::size_t offset, std::size_t width) const {
         if (offset + width > stackSize) {
@@ -0,0 +1,47 @@
+/*
+* ARM64 Linux System Calls
+*
+* SVC #0 handling: a small subset of the Linux AArch64 syscall ABI, mapped
+* onto host calls so freestanding programs can print, read input, time
+* themselves and exit with a status.
+*
+* - Number in X8, arguments in X0-X5, result (or -errno) in X0.
+* - write/read hand the guest buffer straight to the host call (no copy);
+*   only fds 0, 1 and 2 are open in the guest.
+* - exit/exit_group stop execution and record the status in ExecState.
+* - clock_gettime fills a guest struct timespec from the host clocks.
+* - brk, anonymous mmap and munmap go to the guest heap (ExecState::memory,
+*   see memory.hpp). Without one, brk cannot grow and mmap reports ENOMEM.
+* - Any other number returns -ENOSYS, as the kernel does.
+*
+* Author: Kyle Mather and Braeden Allen
+*/
+
+#ifndef ARM64_SYSCALLS_HPP
+#define ARM64_SYSCALLS_HPP
+
+#include <cstdint>
+
+#include "executor.hpp"
+
+namespace arm64 {
+
+// Linux AArch64 (asm-generic) syscall numbers handled by emulateSyscall().
+namespace sys {
+constexpr uint64_t kRead         = 63;
+constexpr uint64_t kWrite        = 64;
+constexpr uint64_t kExit         = 93;
+constexpr uint64_t kExitGroup    = 94;
+constexpr uint64_t kClockGettime = 113;
+constexpr uint64_t kBrk          = 214;
+constexpr uint64_t kMunmap       = 215;
+constexpr uint64_t kMmap         = 222;
+} // namespace sys
+
+// Run the syscall selected by X8 and write its result to X0. Returns false
+// when the guest exited (st.exited/st.exitCode are set), true otherwise.
+bool emulateSyscall(Registers& regs, Stack& stack, ExecState& st);
+
+} // namespace arm64
+
+#endif // ARM64_SYSCALLS_HPP
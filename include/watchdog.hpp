@@ -0,0 +1,81 @@
+/*
+* ARM64 Run Limits and Watchdog
+*
+* Step and wall-clock limits for a run, and the reason a run stopped.
+*
+* - RunLimits: a step budget and a timeout; 0 means no limit for either.
+* - The step limit is exact: a run stops with exactly that many instructions
+*   retired, as the original per-instruction check did. A superinstruction
+*   that would cross it runs one instruction at a time instead, and loop
+*   fast-forwarding skips no further than the budget left. The timeout is
+*   polled only at block boundaries (wherever control did not just fall
+*   through).
+* - Watchdog: a thread that sleeps until the timeout and then raises a flag
+*   the loop polls with one relaxed load, so the clock is never read on the
+*   hot path. Destroying it early stops the thread at once.
+* - StopReason names why a run ended, with a stable spelling and process
+*   exit status for each (stopReasonName(), stopReasonStatus()).
+*
+* Author: Kyle Mather and Braeden Allen
+*/
+
+#ifndef ARM64_WATCHDOG_HPP
+#define ARM64_WATCHDOG_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace arm64 {
+
+struct RunLimits {
+    static constexpr std::size_t kDefaultMaxSteps = 100000;
+
+    std::size_t maxSteps{kDefaultMaxSteps}; // 0 = unlimited
+    uint64_t    timeoutMs{0};               // 0 = none
+};
+
+enum class StopReason : uint8_t {
+    End,        // fell off the end of the program
+    Halt,       // RET from the entry function (RetPolicy)
+    Exit,       // exit/exit_group syscall
+    StepLimit,  // RunLimits::maxSteps reached
+    Timeout,    // RunLimits::timeoutMs elapsed
+    BadPc,      // PC left the program
+    Breakpoint, // reached the address given to Machine::runUntil()
+    Error,      // an instruction raised an error
+};
+
+// "end", "halt", "exit", "step-limit", "timeout", "bad-pc", "breakpoint",
+// "error"
+const char* stopReasonName(StopReason r);
+
+// Exit status for a stop other than End/Halt/Exit/Breakpoint: 3 step-limit,
+// 4 timeout, 5 bad-pc, 2 error.
+int stopReasonStatus(StopReason r);
+
+class Watchdog {
+public:
+    explicit Watchdog(std::chrono::milliseconds timeout);
+    ~Watchdog();
+
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    bool expired() const { return expired_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> expired_{false};
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool cancelled_{false};
+    std::thread thread_;
+};
+
+} // namespace arm64
+
+#endif // ARM64_WATCHDOG_HPP
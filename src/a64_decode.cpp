@@ -0,0 +1,463 @@
+#include "a64_decode.hpp"
+
+#include <cmath>
+#include <cstdio>
+
+namespace arm64 {
+
+static uint32_t bits(uint32_t w, unsigned hi, unsigned lo) {
+    return (w >> lo) & ((1u << (hi - lo + 1)) - 1);
+}
+
+static int64_t signExtend(uint64_t v, unsigned width) {
+    const uint64_t m = 1ull << (width - 1);
+    return static_cast<int64_t>((v ^ m) - m);
+}
+
+static std::string hex(uint64_t v) {
+    char buf[24];
+    std::snprintf(buf, sizeof buf, "0x%llx", static_cast<unsigned long long>(v));
+    return buf;
+}
+
+static std::string imm(int64_t v) { return "#" + std::to_string(v); }
+static std::string uimm(uint64_t v) { return "#" + std::to_string(v); }
+
+// Xn/Wn; register 31 is SP where the encoding allows it, else XZR/WZR.
+static std::string reg(uint32_t n, bool x, bool spOk = false) {
+    if (n == 31) return spOk ? (x ? "sp" : "wsp") : (x ? "xzr" : "wzr");
+    return (x ? "x" : "w") + std::to_string(n);
+}
+
+static std::string fpreg(uint32_t n, char view) { return std::string(1, view) + std::to_string(n); }
+
+static std::string unsupported(uint32_t w) {
+    char buf[24];
+    std::snprintf(buf, sizeof buf, ".inst 0x%08x", w);
+    return buf;
+}
+
+static const char* const kConds[16] = {"eq", "ne", "cs", "cc", "mi", "pl", "vs", "vc",
+                                       "hi", "ls", "ge", "lt", "gt", "le", "al", "nv"};
+static const char* const kShifts[4] = {"lsl", "lsr", "asr", "ror"};
+static const char* const kExtends[8] = {"uxtb", "uxth", "uxtw", "uxtx", "sxtb", "sxth", "sxtw", "sxtx"};
+
+// DecodeBitMasks for logical immediates; false for reserved encodings.
+static bool bitmaskImm(uint32_t n, uint32_t immr, uint32_t imms, bool x, uint64_t& out) {
+    const uint32_t combined = (n << 6) | (~imms & 0x3F);
+    if (combined == 0) return false;
+    unsigned len = 6;
+    while (!(combined & (1u << len))) --len;
+    if (len < 1 || (!x && len > 5)) return false;
+
+    const unsigned size = 1u << len;
+    const uint32_t levels = size - 1;
+    const uint32_t s = imms & levels, r = immr & levels;
+    if (s == levels) return false;
+
+    const uint64_t emask = size == 64 ? ~0ull : (1ull << size) - 1;
+    uint64_t elem = (s + 1 == 64) ? ~0ull : (1ull << (s + 1)) - 1;
+    if (r) elem = ((elem >> r) | (elem << (size - r))) & emask;
+    uint64_t v = 0;
+    for (unsigned i = 0; i < 64; i += size) v |= elem << i;
+    out = x ? v : v & 0xFFFFFFFFull;
+    return true;
+}
+
+// VFPExpandImm: FMOV's 8-bit floating-point immediate.
+static std::string fpImm(uint32_t imm8) {
+    const uint32_t b = (imm8 >> 6) & 1, cd = (imm8 >> 4) & 3;
+    const int exp = b ? static_cast<int>(cd) - 3 : static_cast<int>(cd) + 1;
+    double v = std::ldexp(1.0 + (imm8 & 0xF) / 16.0, exp);
+    if (imm8 & 0x80) v = -v;
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "#%.17g", v);
+    return buf;
+}
+
+/* Data processing -- immediate */
+
+static std::string dpImmediate(uint32_t w, uint64_t pc) {
+    const bool x = bits(w, 31, 31);
+    const uint32_t rd = bits(w, 4, 0), rn = bits(w, 9, 5);
+
+    // ADR/ADRP: the address is known now
+    if ((w & 0x1F000000) == 0x10000000) {
+        const int64_t off = signExtend((bits(w, 23, 5) << 2) | bits(w, 30, 29), 21);
+        const uint64_t addr = (w & 0x80000000) ? (pc & ~0xFFFull) + static_cast<uint64_t>(off * 4096)
+                                               : pc + static_cast<uint64_t>(off);
+        return "mov " + reg(rd, true) + ", #" + hex(addr);
+    }
+
+    // ADD/SUB{S} #imm12{, LSL #12}
+    if ((w & 0x1F800000) == 0x11000000) {
+        const bool sub = bits(w, 30, 30), s = bits(w, 29, 29);
+        const uint64_t v = static_cast<uint64_t>(bits(w, 21, 10)) << (bits(w, 22, 22) ? 12 : 0);
+        if (s && rd == 31) return std::string(sub ? "cmp " : "cmn ") + reg(rn, x, true) + ", " + uimm(v);
+        return std::string(sub ? "sub" : "add") + (s ? "s " : " ") + reg(rd, x, !s) + ", " +
+               reg(rn, x, true) + ", " + uimm(v);
+    }
+
+    // AND/ORR/EOR/ANDS #bitmask
+    if ((w & 0x1F800000) == 0x12000000) {
+        uint64_t v = 0;
+        if (!bitmaskImm(bits(w, 22, 22), bits(w, 21, 16), bits(w, 15, 10), x, v)) return unsupported(w);
+        const uint32_t opc = bits(w, 30, 29);
+        if (opc == 3 && rd == 31) return "tst " + reg(rn, x) + ", #" + hex(v);
+        if (opc == 1 && rn == 31) return "mov " + reg(rd, x, true) + ", #" + hex(v);
+        static const char* const kOps[4] = {"and ", "orr ", "eor ", "ands "};
+        return kOps[opc] + reg(rd, x, opc != 3) + ", " + reg(rn, x) + ", #" + hex(v);
+    }
+
+    // MOVN/MOVZ/MOVK #imm16, LSL #hw*16
+    if ((w & 0x1F800000) == 0x12800000) {
+        const uint32_t opc = bits(w, 30, 29), hw = bits(w, 22, 21);
+        if (opc == 1 || (!x && hw > 1)) return unsupported(w);
+        static const char* const kOps[4] = {"movn ", "", "movz ", "movk "};
+        return kOps[opc] + reg(rd, x) + ", " + uimm(bits(w, 20, 5)) + ", lsl " + uimm(hw * 16);
+    }
+
+    // SBFM/BFM/UBFM, with the shift aliases spelled out
+    if ((w & 0x1F800000) == 0x13000000) {
+        const uint32_t opc = bits(w, 30, 29), immr = bits(w, 21, 16), imms = bits(w, 15, 10);
+        const uint32_t top = x ? 63 : 31;
+        if (opc == 3 || bits(w, 22, 22) != static_cast<uint32_t>(x) || immr > top || imms > top)
+            return unsupported(w);
+        const std::string regs = reg(rd, x) + ", " + reg(rn, x) + ", ";
+        if (opc == 2 && imms != top && imms + 1 == immr) return "lsl " + regs + uimm(top - imms);
+        if (opc == 2 && imms == top) return "lsr " + regs + uimm(immr);
+        if (opc == 0 && imms == top) return "asr " + regs + uimm(immr);
+        static const char* const kOps[3] = {"sbfm ", "bfm ", "ubfm "};
+        return kOps[opc] + regs + uimm(immr) + ", " + uimm(imms);
+    }
+
+    // EXTR with Rn == Rm is ROR #imm
+    if ((w & 0x7FA00000) == 0x13800000) {
+        const uint32_t rm = bits(w, 20, 16), lsb = bits(w, 15, 10);
+        if (rm != rn || bits(w, 22, 22) != static_cast<uint32_t>(x) || lsb > (x ? 63u : 31u)) return unsupported(w);
+        return "ror " + reg(rd, x) + ", " + reg(rn, x) + ", " + uimm(lsb);
+    }
+    return unsupported(w);
+}
+
+/* Branches, exceptions and system instructions */
+
+static std::string branchSystem(uint32_t w, uint64_t pc) {
+    // B/BL imm26
+    if ((w & 0x7C000000) == 0x14000000) {
+        const uint64_t target = pc + static_cast<uint64_t>(signExtend(bits(w, 25, 0), 26) * 4);
+        return std::string((w & 0x80000000) ? "bl " : "b ") + hex(target);
+    }
+    // B.cond imm19
+    if ((w & 0xFF000010) == 0x54000000) {
+        const uint64_t target = pc + static_cast<uint64_t>(signExtend(bits(w, 23, 5), 19) * 4);
+        return std::string("b.") + kConds[bits(w, 3, 0)] + " " + hex(target);
+    }
+    // CBZ/CBNZ Rt, imm19
+    if ((w & 0x7E000000) == 0x34000000) {
+        const uint64_t target = pc + static_cast<uint64_t>(signExtend(bits(w, 23, 5), 19) * 4);
+        return std::string(bits(w, 24, 24) ? "cbnz " : "cbz ") + reg(bits(w, 4, 0), bits(w, 31, 31)) +
+               ", " + hex(target);
+    }
+    // TBZ/TBNZ Rt, #bit, imm14
+    if ((w & 0x7E000000) == 0x36000000) {
+        const uint64_t target = pc + static_cast<uint64_t>(signExtend(bits(w, 18, 5), 14) * 4);
+        const uint32_t bit = (bits(w, 31, 31) << 5) | bits(w, 23, 19);
+        return std::string(bits(w, 24, 24) ? "tbnz " : "tbz ") + reg(bits(w, 4, 0), bit >= 32) + ", " +
+               uimm(bit) + ", " + hex(target);
+    }
+    // BR/BLR/RET Xn
+    switch (w & 0xFFFFFC1F) {
+    case 0xD61F0000: return "br " + reg(bits(w, 9, 5), true);
+    case 0xD63F0000: return "blr " + reg(bits(w, 9, 5), true);
+    case 0xD65F0000: return bits(w, 9, 5) == 30 ? std::string("ret") : "ret " + reg(bits(w, 9, 5), true);
+    default: break;
+    }
+    // SVC #imm16
+    if ((w & 0xFFE0001F) == 0xD4000001) return "svc " + uimm(bits(w, 20, 5));
+    // Hints (NOP, YIELD, BTI, PAC*SP, ...) and DSB/DMB/ISB
+    if ((w & 0xFFFFF01F) == 0xD503201F || (w & 0xFFFFF01F) == 0xD503301F) return "nop";
+
+    // MRS/MSR (register) for NZCV, FPCR, FPSR and TPIDR_EL0
+    if ((w & 0xFFD00000) == 0xD5100000) {
+        const char* name = nullptr;
+        switch (bits(w, 19, 5)) {
+        case 0x5A10: name = "nzcv"; break;
+        case 0x5A20: name = "fpcr"; break;
+        case 0x5A21: name = "fpsr"; break;
+        case 0x5E82: name = "tpidr_el0"; break;
+        default: return unsupported(w);
+        }
+        const std::string rt = reg(bits(w, 4, 0), true);
+        return bits(w, 21, 21) ? "mrs " + rt + ", " + name : std::string("msr ") + name + ", " + rt;
+    }
+    return unsupported(w);
+}
+
+/* Loads and stores */
+
+static std::string memOffset(uint32_t rn, int64_t off) {
+    return off ? "[" + reg(rn, true, true) + ", " + imm(off) + "]" : "[" + reg(rn, true, true) + "]";
+}
+
+// Rt for a single-register load/store; empty if the size/opc pair is not one
+// the executor implements. PRFM comes back as "prfm".
+static std::string loadStoreRt(uint32_t w, unsigned& scale, bool& load) {
+    const uint32_t size = bits(w, 31, 30), opc = bits(w, 23, 22), rt = bits(w, 4, 0);
+    if (bits(w, 26, 26)) {
+        // FP/SIMD: size 0 with opc 1x is the 128-bit Q form
+        scale = size == 0 && (opc & 2) ? 4 : size;
+        if ((opc & 2) && size != 0) return {};
+        load = opc & 1;
+        return fpreg(rt, "bhsdq"[scale]);
+    }
+    scale = size;
+    if (size == 3 && opc == 2) return "prfm";
+    if (size >= 2 && opc == 3) return {};
+    // opc 2 sign-extends into Xt, opc 3 into Wt
+    load = opc != 0;
+    return reg(rt, size == 3 || opc == 2);
+}
+
+static std::string loadStoreMnemonic(uint32_t w, bool load) {
+    if (bits(w, 26, 26)) return load ? "ldr " : "str ";
+    const uint32_t size = bits(w, 31, 30);
+    std::string m = load ? (bits(w, 23, 23) ? "ldrs" : "ldr") : "str";
+    if (size == 0)      m += 'b';
+    else if (size == 1) m += 'h';
+    else if (size == 2 && bits(w, 23, 23)) m += 'w';
+    return m + " ";
+}
+
+static std::string loadStore(uint32_t w) {
+    const uint32_t rn = bits(w, 9, 5);
+
+    // LDP/STP: signed offset, pre- and post-index (LDNP/STNP as plain pairs)
+    if ((w & 0x3A000000) == 0x28000000) {
+        const uint32_t opc = bits(w, 31, 30), mode = bits(w, 24, 23);
+        if (bits(w, 26, 26) || (opc != 0 && opc != 2)) return unsupported(w);
+        const bool x = opc == 2;
+        const int64_t off = signExtend(bits(w, 21, 15), 7) * (x ? 8 : 4);
+        const std::string head = std::string(bits(w, 22, 22) ? "ldp " : "stp ") + reg(bits(w, 4, 0), x) +
+                                 ", " + reg(bits(w, 14, 10), x) + ", ";
+        if (mode == 1) return head + "[" + reg(rn, true, true) + "], " + imm(off);
+        if (mode == 3) return head + "[" + reg(rn, true, true) + ", " + imm(off) + "]!";
+        return head + memOffset(rn, off);
+    }
+
+    if ((w & 0x3B000000) != 0x39000000 && (w & 0x3B200000) != 0x38000000 &&
+        (w & 0x3B200C00) != 0x38200800)
+        return unsupported(w);
+    // LDTR/STTR (unprivileged) exist only for general registers, where at EL0
+    // they act as LDUR/STUR; the SIMD&FP encodings there are unallocated
+    if ((w & 0x3B200C00) == 0x38000800 && bits(w, 26, 26)) return unsupported(w);
+
+    unsigned scale = 0;
+    bool load = false;
+    const std::string rt = loadStoreRt(w, scale, load);
+    if (rt.empty()) return unsupported(w);
+    if (rt == "prfm") return "nop";
+    const std::string head = loadStoreMnemonic(w, load) + rt + ", ";
+
+    // Unsigned, scaled 12-bit offset
+    if ((w & 0x3B000000) == 0x39000000)
+        return head + memOffset(rn, static_cast<int64_t>(bits(w, 21, 10)) << scale);
+
+    // Register offset: [Xn, (Xm|Wm){, extend/LSL #scale}]
+    if ((w & 0x3B200C00) == 0x38200800) {
+        const uint32_t option = bits(w, 15, 13), rm = bits(w, 20, 16);
+        if (!(option & 2)) return unsupported(w);
+        const bool sh = bits(w, 12, 12);
+        std::string idx = "[" + reg(rn, true, true) + ", " + reg(rm, option & 1);
+        if (option == 3) idx += sh ? ", lsl " + uimm(scale) : "";
+        else             idx += std::string(", ") + kExtends[option] + (sh ? " " + uimm(scale) : "");
+        return head + idx + "]";
+    }
+
+    // 9-bit signed offset: unscaled (LDUR/STUR), post-index, pre-index
+    const int64_t off = signExtend(bits(w, 20, 12), 9);
+    switch (bits(w, 11, 10)) {
+    case 1:  return head + "[" + reg(rn, true, true) + "], " + imm(off);
+    case 3:  return head + "[" + reg(rn, true, true) + ", " + imm(off) + "]!";
+    default: return head + memOffset(rn, off);
+    }
+}
+
+/* Data processing -- register */
+
+static std::string dpRegister(uint32_t w) {
+    const bool x = bits(w, 31, 31);
+    const uint32_t rd = bits(w, 4, 0), rn = bits(w, 9, 5), rm = bits(w, 20, 16);
+
+    // AND/ORR/EOR/ANDS shifted register; of the inverted forms only MVN
+    if ((w & 0x1F000000) == 0x0A000000) {
+        const uint32_t opc = bits(w, 30, 29), sh = bits(w, 23, 22), amt = bits(w, 15, 10);
+        if (!x && amt > 31) return unsupported(w);
+        const std::string shift = amt ? std::string(", ") + kShifts[sh] + " " + uimm(amt) : "";
+        if (bits(w, 21, 21)) {
+            if (opc != 1 || rn != 31 || amt) return unsupported(w);
+            return "eor " + reg(rd, x) + ", " + reg(rm, x) + ", #" + hex(x ? ~0ull : 0xFFFFFFFFull);
+        }
+        if (opc == 3 && rd == 31) return "tst " + reg(rn, x) + ", " + reg(rm, x) + shift;
+        if (opc == 1 && rn == 31 && !amt) return "mov " + reg(rd, x) + ", " + reg(rm, x);
+        static const char* const kOps[4] = {"and ", "orr ", "eor ", "ands "};
+        return kOps[opc] + reg(rd, x) + ", " + reg(rn, x) + ", " + reg(rm, x) + shift;
+    }
+
+    // ADD/SUB{S} shifted register
+    if ((w & 0x1F200000) == 0x0B000000) {
+        const bool sub = bits(w, 30, 30), s = bits(w, 29, 29);
+        const uint32_t sh = bits(w, 23, 22), amt = bits(w, 15, 10);
+        if (sh == 3 || (!x && amt > 31)) return unsupported(w);
+        const std::string tail = reg(rm, x) + (amt ? std::string(", ") + kShifts[sh] + " " + uimm(amt) : "");
+        if (s && rd == 31) return std::string(sub ? "cmp " : "cmn ") + reg(rn, x) + ", " + tail;
+        return std::string(sub ? "sub" : "add") + (s ? "s " : " ") + reg(rd, x) + ", " + reg(rn, x) + ", " + tail;
+    }
+
+    // ADD/SUB{S} extended register
+    if ((w & 0x1F200000) == 0x0B200000) {
+        const bool sub = bits(w, 30, 30), s = bits(w, 29, 29);
+        const uint32_t option = bits(w, 15, 13), amt = bits(w, 12, 10);
+        if (amt > 4 || bits(w, 23, 22)) return unsupported(w);
+        std::string tail = reg(rm, x && (option & 3) == 3);
+        if (x && option == 3) tail += amt ? ", lsl " + uimm(amt) : "";
+        else                  tail += std::string(", ") + kExtends[option] + (amt ? " " + uimm(amt) : "");
+        if (s && rd == 31) return std::string(sub ? "cmp " : "cmn ") + reg(rn, x, true) + ", " + tail;
+        return std::string(sub ? "sub" : "add") + (s ? "s " : " ") + reg(rd, x, !s) + ", " +
+               reg(rn, x, true) + ", " + tail;
+    }
+
+    // ADC/ADCS/SBC/SBCS
+    if ((w & 0x1FE0FC00) == 0x1A000000) {
+        static const char* const kOps[4] = {"adc ", "adcs ", "sbc ", "sbcs "};
+        return kOps[bits(w, 30, 29)] + reg(rd, x) + ", " + reg(rn, x) + ", " + reg(rm, x);
+    }
+
+    // CCMN/CCMP (register or #imm5), #nzcv, cond
+    if ((w & 0x3FE00410) == 0x3A400000) {
+        const std::string op2 = bits(w, 11, 11) ? uimm(rm) : reg(rm, x);
+        return std::string(bits(w, 30, 30) ? "ccmp " : "ccmn ") + reg(rn, x) + ", " + op2 + ", " +
+               uimm(bits(w, 3, 0)) + ", " + kConds[bits(w, 15, 12)];
+    }
+
+    // CSEL/CSINC/CSINV/CSNEG
+    if ((w & 0x3FE00800) == 0x1A800000) {
+        static const char* const kOps[4] = {"csel ", "csinc ", "csinv ", "csneg "};
+        return kOps[(bits(w, 30, 30) << 1) | bits(w, 10, 10)] + reg(rd, x) + ", " + reg(rn, x) + ", " +
+               reg(rm, x) + ", " + kConds[bits(w, 15, 12)];
+    }
+
+    // UDIV/SDIV and LSLV/LSRV/ASRV/RORV
+    if ((w & 0x7FE00000) == 0x1AC00000) {
+        const char* name = nullptr;
+        switch (bits(w, 15, 10)) {
+        case 2:  name = "udiv "; break;
+        case 3:  name = "sdiv "; break;
+        case 8:  name = "lsl "; break;
+        case 9:  name = "lsr "; break;
+        case 10: name = "asr "; break;
+        case 11: name = "ror "; break;
+        default: return unsupported(w);
+        }
+        return name + reg(rd, x) + ", " + reg(rn, x) + ", " + reg(rm, x);
+    }
+
+    // MADD/MSUB, SMADDL/UMADDL with XZR (SMULL/UMULL), SMULH/UMULH
+    if ((w & 0x7F000000) == 0x1B000000) {
+        const uint32_t op31 = bits(w, 23, 21), o0 = bits(w, 15, 15), ra = bits(w, 14, 10);
+        const std::string nm = reg(rn, x) + ", " + reg(rm, x);
+        switch ((op31 << 1) | o0) {
+        case 0:  return ra == 31 ? "mul " + reg(rd, x) + ", " + nm
+                                 : "madd " + reg(rd, x) + ", " + nm + ", " + reg(ra, x);
+        case 1:  return ra == 31 ? "mneg " + reg(rd, x) + ", " + nm
+                                 : "msub " + reg(rd, x) + ", " + nm + ", " + reg(ra, x);
+        case 2:  if (x && ra == 31) return "smull " + reg(rd, true) + ", " + reg(rn, false) + ", " + reg(rm, false); break;
+        case 10: if (x && ra == 31) return "umull " + reg(rd, true) + ", " + reg(rn, false) + ", " + reg(rm, false); break;
+        case 4:  if (x) return "smulh " + reg(rd, true) + ", " + nm; break;
+        case 12: if (x) return "umulh " + reg(rd, true) + ", " + nm; break;
+        default: break;
+        }
+        return unsupported(w);
+    }
+    return unsupported(w);
+}
+
+/* Scalar floating point */
+
+static std::string fpScalar(uint32_t w) {
+    const uint32_t type = bits(w, 23, 22);
+    if (type > 1) return unsupported(w);
+    const char v = type ? 'd' : 's';
+    const uint32_t rd = bits(w, 4, 0), rn = bits(w, 9, 5), rm = bits(w, 20, 16);
+
+    // FMADD/FMSUB
+    if ((w & 0xFF200000) == 0x1F000000) {
+        const std::string ops = fpreg(rd, v) + ", " + fpreg(rn, v) + ", " + fpreg(rm, v) + ", " +
+                                fpreg(bits(w, 14, 10), v);
+        return (bits(w, 15, 15) ? "fmsub " : "fmadd ") + ops;
+    }
+    if ((w & 0xFF200000) != 0x1E200000) return unsupported(w);
+
+    // Conversions between general and FP registers
+    if (bits(w, 15, 10) == 0) {
+        const bool x = bits(w, 31, 31);
+        switch ((bits(w, 20, 19) << 3) | bits(w, 18, 16)) {
+        case 2:  return "scvtf " + fpreg(rd, v) + ", " + reg(rn, x);
+        case 3:  return "ucvtf " + fpreg(rd, v) + ", " + reg(rn, x);
+        case 6:  if (x == (type == 1)) return "fmov " + reg(rd, x) + ", " + fpreg(rn, v); break;
+        case 7:  if (x == (type == 1)) return "fmov " + fpreg(rd, v) + ", " + reg(rn, x); break;
+        case 24: return "fcvtzs " + reg(rd, x) + ", " + fpreg(rn, v);
+        case 25: return "fcvtzu " + reg(rd, x) + ", " + fpreg(rn, v);
+        default: break;
+        }
+        return unsupported(w);
+    }
+    if (bits(w, 31, 29)) return unsupported(w);
+
+    // One source: FMOV, FABS, FNEG, FSQRT, FCVT
+    if (bits(w, 14, 10) == 0x10) {
+        const std::string src = fpreg(rn, v);
+        switch (bits(w, 20, 15)) {
+        case 0: return "fmov " + fpreg(rd, v) + ", " + src;
+        case 1: return "fabs " + fpreg(rd, v) + ", " + src;
+        case 2: return "fneg " + fpreg(rd, v) + ", " + src;
+        case 3: return "fsqrt " + fpreg(rd, v) + ", " + src;
+        case 4: if (type == 1) return "fcvt " + fpreg(rd, 's') + ", " + src; break;
+        case 5: if (type == 0) return "fcvt " + fpreg(rd, 'd') + ", " + src; break;
+        default: break;
+        }
+        return unsupported(w);
+    }
+
+    // FCMP/FCMPE (register or #0.0)
+    if (bits(w, 13, 10) == 0x8 && bits(w, 15, 14) == 0 && bits(w, 2, 0) == 0) {
+        const std::string op2 = bits(w, 3, 3) ? std::string("#0.0") : fpreg(rm, v);
+        return (bits(w, 4, 4) ? "fcmpe " : "fcmp ") + fpreg(rn, v) + ", " + op2;
+    }
+
+    // FMOV #imm8
+    if (bits(w, 12, 10) == 0x4 && bits(w, 9, 5) == 0)
+        return "fmov " + fpreg(rd, v) + ", " + fpImm(bits(w, 20, 13));
+
+    // Two sources: FMUL, FDIV, FADD, FSUB
+    if (bits(w, 11, 10) == 0x2) {
+        static const char* const kOps[4] = {"fmul ", "fdiv ", "fadd ", "fsub "};
+        const uint32_t opc = bits(w, 15, 12);
+        if (opc > 3) return unsupported(w);
+        return kOps[opc] + fpreg(rd, v) + ", " + fpreg(rn, v) + ", " + fpreg(rm, v);
+    }
+    return unsupported(w);
+}
+
+std::string disassemble(uint32_t w, uint64_t pc) {
+    switch (bits(w, 28, 25)) {
+    case 0x8: case 0x9:  return dpImmediate(w, pc);
+    case 0xA: case 0xB:  return branchSystem(w, pc);
+    case 0x4: case 0x6: case 0xC: case 0xE: return loadStore(w);
+    case 0x5: case 0xD:  return dpRegister(w);
+    case 0xF:            return fpScalar(w);
+    default:             return unsupported(w);
+    }
+}
+
+} // namespace arm64
@@ -0,0 +1,353 @@
+#include "cfg.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <unordered_map>
+
+namespace arm64 {
+
+static constexpr uint32_t kNone = BasicBlock::kNone;
+
+// Instructions after which a new block starts.
+static bool endsBlock(Opcode op) {
+    switch (op) {
+    case Opcode::B: case Opcode::BCond: case Opcode::Cbz: case Opcode::Cbnz:
+    case Opcode::Tbz: case Opcode::Tbnz: case Opcode::Bl: case Opcode::Blr:
+    case Opcode::Br: case Opcode::Ret: case Opcode::Udf:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool intraEdge(EdgeKind k) { return k == EdgeKind::Fallthrough || k == EdgeKind::Taken; }
+
+std::vector<bool> blockLeaders(const AsmProgram& prog, uint64_t entry) {
+    const std::size_t n = prog.code.size();
+    std::vector<bool> leader(n + 1, false);
+    if (n == 0) return leader;
+    leader[0] = true;
+    auto e = prog.addr2idx.find(entry);
+    if (e != prog.addr2idx.end()) leader[e->second] = true;
+
+    for (std::size_t i = 0; i < n; ++i) {
+        const AsmInst& ai = prog.code[i];
+        if (ai.pre.targetIdx != Predecoded::kNoTarget) leader[ai.pre.targetIdx] = true;
+        if (endsBlock(ai.inst.op)) leader[i + 1] = true;
+        if (ai.pre.host) leader[i] = true;
+    }
+    return leader;
+}
+
+ControlFlowGraph::ControlFlowGraph(const AsmProgram& prog, uint64_t entry) : prog_(prog) {
+    const std::size_t n = prog.code.size();
+    const std::vector<bool> leader = blockLeaders(prog, entry);
+    blockOf_.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (leader[i]) {
+            blocks_.emplace_back();
+            blocks_.back().first = static_cast<uint32_t>(i);
+        }
+        blockOf_[i] = static_cast<uint32_t>(blocks_.size() - 1);
+        ++blocks_.back().size;
+    }
+
+    // Intra-procedural edges, and the calls for return edges below
+    std::vector<std::pair<uint32_t, uint32_t>> calls; // (calling block, callee entry)
+    for (uint32_t b = 0; b < blocks_.size(); ++b) {
+        const std::size_t end = blocks_[b].first + blocks_[b].size;
+        const AsmInst& last = prog.code[end - 1];
+        const uint32_t next = end < n ? blockOf_[end] : kNone;
+        const uint32_t idx = last.pre.targetIdx;
+        const uint32_t target = idx != Predecoded::kNoTarget && idx < n ? blockOf_[idx] : kNone;
+
+        switch (last.inst.op) {
+        case Opcode::B:
+            if (target != kNone) addEdge(b, target, EdgeKind::Taken);
+            break;
+        case Opcode::BCond: case Opcode::Cbz: case Opcode::Cbnz: case Opcode::Tbz: case Opcode::Tbnz:
+            if (target != kNone) addEdge(b, target, EdgeKind::Taken);
+            if (next != kNone)   addEdge(b, next, EdgeKind::Fallthrough);
+            break;
+        case Opcode::Bl:
+            if (target != kNone) { addEdge(b, target, EdgeKind::Call); calls.emplace_back(b, target); }
+            if (next != kNone)   addEdge(b, next, EdgeKind::Fallthrough);
+            break;
+        case Opcode::Br: case Opcode::Ret: case Opcode::Udf:
+            break;
+        default: // BLR, or a block cut short by the next leader
+            if (next != kNone) addEdge(b, next, EdgeKind::Fallthrough);
+            break;
+        }
+    }
+
+    // Every callee is analysed from its own entry
+    std::vector<uint32_t> entries;
+    auto e = prog.addr2idx.find(entry);
+    if (e != prog.addr2idx.end()) entries.push_back(blockOf_[e->second]);
+    for (const auto& c : calls) entries.push_back(c.second);
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+
+    // RET blocks of each callee return to the block after each of its call sites
+    std::unordered_map<uint32_t, std::vector<uint32_t>> rets; // callee entry -> RET blocks
+    for (const auto& [site, callee] : calls) {
+        auto it = rets.find(callee);
+        if (it == rets.end()) {
+            std::vector<uint32_t> found, work{callee};
+            std::vector<bool> seen(blocks_.size(), false);
+            seen[callee] = true;
+            while (!work.empty()) {
+                const uint32_t x = work.back();
+                work.pop_back();
+                const BasicBlock& bb = blocks_[x];
+                if (prog.code[bb.first + bb.size - 1].inst.op == Opcode::Ret) found.push_back(x);
+                for (uint32_t ei : bb.succs) {
+                    const CfgEdge& edge = edges_[ei];
+                    if (intraEdge(edge.kind) && !seen[edge.to]) { seen[edge.to] = true; work.push_back(edge.to); }
+                }
+            }
+            it = rets.emplace(callee, std::move(found)).first;
+        }
+        const std::size_t after = blocks_[site].first + blocks_[site].size;
+        if (after >= n) continue;
+        for (uint32_t r : it->second) addEdge(r, blockOf_[after], EdgeKind::Return);
+    }
+
+    computeDominators(entries);
+    findLoops();
+}
+
+void ControlFlowGraph::addEdge(uint32_t from, uint32_t to, EdgeKind kind) {
+    const uint32_t id = static_cast<uint32_t>(edges_.size());
+    edges_.push_back(CfgEdge{from, to, kind});
+    blocks_[from].succs.push_back(id);
+    blocks_[to].preds.push_back(id);
+}
+
+// Cooper, Harvey and Kennedy, "A Simple, Fast Dominance Algorithm", over a
+// virtual root whose successors are the entries.
+void ControlFlowGraph::computeDominators(const std::vector<uint32_t>& entries) {
+    const uint32_t nb = static_cast<uint32_t>(blocks_.size());
+    const uint32_t root = nb;
+
+    // Reverse postorder by an explicit-stack DFS
+    std::vector<uint32_t> post(nb + 1, kNone), rpo;
+    std::vector<bool> seen(nb + 1, false);
+    std::vector<std::pair<uint32_t, std::size_t>> stack{{root, 0}};
+    seen[root] = true;
+    while (!stack.empty()) {
+        auto& [x, i] = stack.back();
+        uint32_t child = kNone;
+        if (x == root) {
+            if (i < entries.size()) child = entries[i++];
+        } else {
+            const std::vector<uint32_t>& succs = blocks_[x].succs;
+            while (i < succs.size() && child == kNone) {
+                const CfgEdge& e = edges_[succs[i++]];
+                if (intraEdge(e.kind)) child = e.to;
+            }
+        }
+        if (child == kNone) {
+            post[x] = static_cast<uint32_t>(rpo.size());
+            rpo.push_back(x);
+            stack.pop_back();
+        } else if (!seen[child]) {
+            seen[child] = true;
+            stack.emplace_back(child, 0);
+        }
+    }
+    std::reverse(rpo.begin(), rpo.end());
+
+    std::vector<uint32_t> idom(nb + 1, kNone);
+    idom[root] = root;
+    std::vector<bool> isEntry(nb, false);
+    for (uint32_t en : entries) isEntry[en] = true;
+
+    auto intersect = [&](uint32_t a, uint32_t b) {
+        while (a != b) {
+            while (post[a] < post[b]) a = idom[a];
+            while (post[b] < post[a]) b = idom[b];
+        }
+        return a;
+    };
+
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (uint32_t b : rpo) {
+            if (b == root) continue;
+            uint32_t d = isEntry[b] ? root : kNone;
+            for (uint32_t ei : blocks_[b].preds) {
+                const CfgEdge& e = edges_[ei];
+                if (!intraEdge(e.kind) || idom[e.from] == kNone) continue;
+                d = d == kNone ? e.from : intersect(e.from, d);
+            }
+            if (d != idom[b]) { idom[b] = d; changed = true; }
+        }
+    }
+
+    for (uint32_t b = 0; b < nb; ++b) {
+        blocks_[b].reachable = seen[b];
+        blocks_[b].idom = idom[b] == root ? kNone : idom[b];
+    }
+}
+
+bool ControlFlowGraph::dominates(uint32_t a, uint32_t b) const {
+    if (!blocks_[b].reachable) return false;
+    for (uint32_t x = b; x != kNone; x = blocks_[x].idom)
+        if (x == a) return true;
+    return false;
+}
+
+void ControlFlowGraph::findLoops() {
+    // Back edges, grouped by header in block order
+    std::vector<std::vector<uint32_t>> latches(blocks_.size());
+    for (const CfgEdge& e : edges_)
+        if (intraEdge(e.kind) && dominates(e.to, e.from)) latches[e.to].push_back(e.from);
+
+    for (uint32_t h = 0; h < blocks_.size(); ++h) {
+        if (latches[h].empty()) continue;
+        Loop loop{h, latches[h], {h}};
+        std::vector<bool> in(blocks_.size(), false);
+        in[h] = true;
+        std::vector<uint32_t> work = latches[h];
+        while (!work.empty()) {
+            const uint32_t x = work.back();
+            work.pop_back();
+            if (in[x]) continue;
+            in[x] = true;
+            loop.blocks.push_back(x);
+            for (uint32_t ei : blocks_[x].preds) {
+                const CfgEdge& e = edges_[ei];
+                if (intraEdge(e.kind) && blocks_[e.from].reachable && !in[e.from]) work.push_back(e.from);
+            }
+        }
+        std::sort(loop.blocks.begin(), loop.blocks.end());
+        loops_.push_back(std::move(loop));
+    }
+
+    // Natural loops with different headers nest or are disjoint: a loop's
+    // parent is the smallest other loop holding its header. Outer loops
+    // first, so parents have their depth before their children.
+    std::vector<uint32_t> order(loops_.size());
+    for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return loops_[a].blocks.size() > loops_[b].blocks.size();
+    });
+    for (uint32_t li : order) {
+        Loop& l = loops_[li];
+        for (uint32_t mi : order) {
+            const Loop& m = loops_[mi];
+            if (mi == li || m.blocks.size() <= l.blocks.size()) continue;
+            if (!std::binary_search(m.blocks.begin(), m.blocks.end(), l.header)) continue;
+            if (l.parent == kNone || m.blocks.size() < loops_[l.parent].blocks.size()) l.parent = mi;
+        }
+        l.depth = l.parent == kNone ? 1 : loops_[l.parent].depth + 1;
+        for (uint32_t b : l.blocks) blocks_[b].loop = li; // smaller loops come later and win
+    }
+}
+
+static std::string hexAddr(uint64_t v) {
+    char buf[24];
+    std::snprintf(buf, sizeof buf, "0x%llx", static_cast<unsigned long long>(v));
+    return buf;
+}
+
+static const char* edgeName(EdgeKind k) {
+    switch (k) {
+    case EdgeKind::Fallthrough: return "fallthrough";
+    case EdgeKind::Taken:       return "taken";
+    case EdgeKind::Call:        return "call";
+    case EdgeKind::Return:      return "return";
+    }
+    return "?";
+}
+
+// "mnem op1, op2" with DOT's string escapes
+static std::string dotText(const DecodedInstruction& inst) {
+    std::string s = inst.mnem;
+    for (std::size_t i = 0; i < inst.operands.size(); ++i) { s += i ? ", " : " "; s += inst.operands[i].raw(); }
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+std::string ControlFlowGraph::toDot(const std::vector<uint64_t>* counts) const {
+    std::ostringstream os;
+    os << "digraph cfg {\n"
+       << "  node [shape=box, fontname=\"monospace\"];\n";
+    for (uint32_t b = 0; b < blocks_.size(); ++b) {
+        const BasicBlock& bb = blocks_[b];
+        os << "  b" << b << " [label=\"B" << b << "  " << hexAddr(prog_.code[bb.first].addr);
+        if (counts) os << "  count " << (*counts)[b];
+        if (bb.loop != kNone && loops_[bb.loop].header == b) os << "  loop header, depth " << loops_[bb.loop].depth;
+        os << "\\l";
+        for (uint32_t i = bb.first; i < bb.first + bb.size; ++i) os << dotText(prog_.code[i].inst) << "\\l";
+        os << "\"";
+        if (bb.loop != kNone && loops_[bb.loop].header == b) os << ", penwidth=2";
+        if (!bb.reachable) os << ", style=dashed";
+        os << "];\n";
+    }
+    for (const CfgEdge& e : edges_) {
+        os << "  b" << e.from << " -> b" << e.to;
+        switch (e.kind) {
+        case EdgeKind::Fallthrough: os << " [style=dashed]"; break;
+        case EdgeKind::Call:        os << " [style=dotted, color=blue]"; break;
+        case EdgeKind::Return:      os << " [style=dotted, color=gray]"; break;
+        case EdgeKind::Taken:
+            if (dominates(e.to, e.from)) os << " [color=red]"; // back edge
+            break;
+        }
+        os << ";\n";
+    }
+    os << "}\n";
+    return os.str();
+}
+
+static std::string jsonIndex(uint32_t v) { return v == kNone ? "null" : std::to_string(v); }
+
+std::string ControlFlowGraph::toJson(const std::vector<uint64_t>* counts) const {
+    std::ostringstream os;
+    auto list = [&](const std::vector<uint32_t>& v) {
+        os << '[';
+        for (std::size_t i = 0; i < v.size(); ++i) os << (i ? "," : "") << v[i];
+        os << ']';
+    };
+
+    os << "{\n  \"blocks\": [";
+    for (uint32_t b = 0; b < blocks_.size(); ++b) {
+        const BasicBlock& bb = blocks_[b];
+        const uint64_t start = prog_.code[bb.first].addr;
+        os << (b ? ",\n" : "\n") << "    {\"id\": " << b << ", \"start\": \"" << hexAddr(start)
+           << "\", \"end\": \"" << hexAddr(start + 4ull * bb.size) << "\", \"instructions\": " << bb.size
+           << ", \"reachable\": " << (bb.reachable ? "true" : "false") << ", \"idom\": " << jsonIndex(bb.idom)
+           << ", \"loop\": " << jsonIndex(bb.loop);
+        if (counts) os << ", \"count\": " << (*counts)[b];
+        os << '}';
+    }
+    os << "\n  ],\n  \"edges\": [";
+    for (std::size_t i = 0; i < edges_.size(); ++i) {
+        const CfgEdge& e = edges_[i];
+        os << (i ? ",\n" : "\n") << "    {\"from\": " << e.from << ", \"to\": " << e.to << ", \"kind\": \""
+           << edgeName(e.kind) << "\"}";
+    }
+    os << "\n  ],\n  \"loops\": [";
+    for (std::size_t i = 0; i < loops_.size(); ++i) {
+        const Loop& l = loops_[i];
+        os << (i ? ",\n" : "\n") << "    {\"header\": " << l.header << ", \"depth\": " << l.depth
+           << ", \"parent\": " << jsonIndex(l.parent) << ", \"latches\": ";
+        list(l.latches);
+        os << ", \"blocks\": ";
+        list(l.blocks);
+        if (counts) os << ", \"headerCount\": " << (*counts)[l.header];
+        os << '}';
+    }
+    os << "\n  ]\n}\n";
+    return os.str();
+}
+
+} // namespace arm64
@@ -0,0 +1,271 @@
+#include "elf_loader.hpp"
+#include "a64_decode.hpp"
+#include "hle.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+namespace arm64 {
+
+// ELF constants used below
+static constexpr uint16_t kEtExec    = 2;
+static constexpr uint16_t kEmAarch64 = 183;
+static constexpr uint32_t kPtLoad    = 1;
+static constexpr uint32_t kPtDynamic = 2;
+static constexpr uint32_t kPtInterp  = 3;
+static constexpr uint32_t kPtPhdr    = 6;
+static constexpr uint32_t kPfX       = 1;
+static constexpr uint32_t kShtSymtab = 2;
+static constexpr uint8_t  kSttFunc   = 2;
+static constexpr uint8_t  kStbGlobal = 1;
+
+// Auxiliary vector keys
+static constexpr uint64_t kAtNull   = 0;
+static constexpr uint64_t kAtPhdr   = 3;
+static constexpr uint64_t kAtPhent  = 4;
+static constexpr uint64_t kAtPhnum  = 5;
+static constexpr uint64_t kAtPagesz = 6;
+static constexpr uint64_t kAtBase   = 7;
+static constexpr uint64_t kAtFlags  = 8;
+static constexpr uint64_t kAtEntry  = 9;
+static constexpr uint64_t kAtUid    = 11;
+static constexpr uint64_t kAtEuid   = 12;
+static constexpr uint64_t kAtGid    = 13;
+static constexpr uint64_t kAtEgid   = 14;
+static constexpr uint64_t kAtHwcap  = 16;
+static constexpr uint64_t kAtClktck = 17;
+static constexpr uint64_t kAtSecure = 23;
+static constexpr uint64_t kAtRandom = 25;
+static constexpr uint64_t kAtExecfn = 31;
+
+// AT_HWCAP bits for what the executor implements: FP and (integer) AdvSIMD,
+// which the AArch64 Linux ABI guarantees anyway
+static constexpr uint64_t kHwcapFp    = 1u << 0;
+static constexpr uint64_t kHwcapAsimd = 1u << 1;
+
+// Little-endian field reads, independent of the host's byte order
+static uint64_t readLE(const char* p, unsigned n) {
+    uint64_t v = 0;
+    for (unsigned i = 0; i < n; ++i) v |= static_cast<uint64_t>(static_cast<uint8_t>(p[i])) << (8 * i);
+    return v;
+}
+
+static void writeLE(Memory& mem, uint64_t addr, uint64_t v) {
+    uint8_t* p = mem.translate(addr, 8);
+    if (!p) throw std::runtime_error("initial stack does not fit in the guest stack");
+    for (unsigned i = 0; i < 8; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+static void writeBytes(Memory& mem, uint64_t addr, const void* src, std::size_t n) {
+    uint8_t* p = mem.translate(addr, n);
+    if (!p) throw std::runtime_error("initial stack does not fit in the guest stack");
+    std::memcpy(p, src, n);
+}
+
+bool isElfFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[4] = {};
+    return in.read(magic, 4) && std::memcmp(magic, "\x7f" "ELF", 4) == 0;
+}
+
+ElfExecutable::ElfExecutable(const std::string& path) : file_(path) {
+    const std::string_view f = file_.view();
+    auto bad = [&](const std::string& why) { return std::runtime_error(path + ": " + why); };
+
+    if (f.size() < 64 || f.substr(0, 4) != "\x7f" "ELF") throw bad("not an ELF file");
+    if (f[4] != 2 || f[5] != 1) throw bad("not a 64-bit little-endian ELF file");
+    const char* h = f.data();
+    if (readLE(h + 18, 2) != kEmAarch64) throw bad("not an AArch64 executable");
+    if (readLE(h + 16, 2) != kEtExec) throw bad("only static (ET_EXEC) executables are supported");
+
+    entry_ = readLE(h + 24, 8);
+    const uint64_t phoff = readLE(h + 32, 8);
+    phent_ = readLE(h + 54, 2);
+    phnum_ = readLE(h + 56, 2);
+    if (phent_ < 56 || phoff > f.size() || phnum_ * phent_ > f.size() - phoff)
+        throw bad("truncated program header table");
+
+    uint64_t top = 0;
+    for (uint64_t i = 0; i < phnum_; ++i) {
+        const char* ph = h + phoff + i * phent_;
+        const uint32_t type = static_cast<uint32_t>(readLE(ph, 4));
+        if (type == kPtInterp || type == kPtDynamic) throw bad("dynamically linked executables are not supported");
+        if (type == kPtPhdr) phdrAddr_ = readLE(ph + 16, 8);
+        if (type != kPtLoad) continue;
+
+        Segment s{readLE(ph + 16, 8), readLE(ph + 40, 8), readLE(ph + 8, 8), readLE(ph + 32, 8),
+                  static_cast<uint32_t>(readLE(ph + 4, 4))};
+        if (s.filesz > s.memsz || s.offset > f.size() || s.filesz > f.size() - s.offset)
+            throw bad("segment extends past the end of the file");
+        top = std::max(top, s.vaddr + s.memsz);
+        segments_.push_back(s);
+
+        // Without PT_PHDR, the headers are wherever the segment holding them loads
+        if (!phdrAddr_ && phoff >= s.offset && phoff - s.offset < s.filesz)
+            phdrAddr_ = s.vaddr + (phoff - s.offset);
+    }
+    if (segments_.empty()) throw bad("no loadable segments");
+    brkBase_ = (top + Memory::kPageSize - 1) & ~(Memory::kPageSize - 1);
+    readSymbols();
+}
+
+// STT_FUNC entries of .symtab, uppercased like listing labels. Stripped
+// files simply have none; a malformed table is skipped rather than fatal.
+void ElfExecutable::readSymbols() {
+    const std::string_view f = file_.view();
+    const char* h = f.data();
+    const uint64_t shoff = readLE(h + 40, 8), shent = readLE(h + 58, 2), shnum = readLE(h + 60, 2);
+    if (shoff == 0 || shent < 64 || shoff > f.size() || shnum * shent > f.size() - shoff) return;
+
+    auto inFile = [&](uint64_t off, uint64_t size) { return off <= f.size() && size <= f.size() - off; };
+    for (uint64_t i = 0; i < shnum; ++i) {
+        const char* sh = h + shoff + i * shent;
+        if (readLE(sh + 4, 4) != kShtSymtab) continue;
+        const uint64_t off = readLE(sh + 24, 8), size = readLE(sh + 32, 8), ent = readLE(sh + 56, 8);
+        const uint64_t link = readLE(sh + 40, 4);
+        if (ent < 24 || link >= shnum || !inFile(off, size)) continue;
+        const char* strsh = h + shoff + link * shent;
+        const uint64_t stroff = readLE(strsh + 24, 8), strsize = readLE(strsh + 32, 8);
+        if (!inFile(stroff, strsize)) continue;
+
+        for (uint64_t o = 0; o + ent <= size; o += ent) {
+            const char* sym = h + off + o;
+            const uint8_t info = static_cast<uint8_t>(sym[4]);
+            const uint64_t name = readLE(sym, 4), value = readLE(sym + 8, 8);
+            if ((info & 0xF) != kSttFunc || value == 0 || name >= strsize) continue;
+
+            const char* p = h + stroff + name;
+            std::string key(p, static_cast<std::size_t>(std::find(p, h + stroff + strsize, '\0') - p));
+            if (key.empty()) continue;
+            std::transform(key.begin(), key.end(), key.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+            // A global definition wins over file-local ones of the same name
+            if ((info >> 4) == kStbGlobal) symbols_[key] = value;
+            else                           symbols_.emplace(key, value);
+        }
+    }
+}
+
+void ElfExecutable::load(Memory& mem) const {
+    // Map the page span of every segment once; segments may share pages.
+    std::vector<std::pair<uint64_t, uint64_t>> spans;
+    for (const Segment& s : segments_) {
+        if (s.memsz == 0) continue;
+        spans.emplace_back(s.vaddr & ~(Memory::kPageSize - 1),
+                           (s.vaddr + s.memsz + Memory::kPageSize - 1) & ~(Memory::kPageSize - 1));
+    }
+    std::sort(spans.begin(), spans.end());
+    for (std::size_t i = 0; i < spans.size();) {
+        uint64_t lo = spans[i].first, hi = spans[i].second;
+        for (++i; i < spans.size() && spans[i].first <= hi; ++i) hi = std::max(hi, spans[i].second);
+        if (!mem.map(lo, hi - lo)) throw std::runtime_error("ELF segment overlaps guest memory in use");
+    }
+
+    for (const Segment& s : segments_) {
+        if (s.filesz == 0) continue;
+        uint8_t* dst = mem.translate(s.vaddr, s.filesz);
+        std::memcpy(dst, file_.view().data() + s.offset, static_cast<std::size_t>(s.filesz));
+    }
+}
+
+AsmProgram ElfExecutable::decode(const Parser& parser) const {
+    uint64_t lo = ~0ull, hi = 0;
+    for (const Segment& s : segments_) {
+        if (!(s.flags & kPfX)) continue;
+        lo = std::min<uint64_t>(lo, s.vaddr & ~3ull);
+        hi = std::max<uint64_t>(hi, (s.vaddr + s.memsz + 3) & ~3ull);
+    }
+    if (lo >= hi) throw std::runtime_error("ELF file has no executable segment");
+
+    AsmProgram prog;
+    prog.base = lo;
+    prog.labels = symbols_;
+    const std::size_t n = static_cast<std::size_t>((hi - lo) / 4);
+    prog.code.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const uint64_t addr = lo + i * 4;
+        uint32_t word = 0; // gaps and bss between executable segments
+        for (const Segment& s : segments_) {
+            if ((s.flags & kPfX) && addr >= s.vaddr && addr + 4 <= s.vaddr + s.filesz) {
+                word = static_cast<uint32_t>(readLE(file_.view().data() + s.offset + (addr - s.vaddr), 4));
+                break;
+            }
+        }
+
+        AsmInst ai;
+        ai.addr = addr;
+        ai.instrIndex = i + 1;
+        std::optional<DecodedInstruction> d;
+        try {
+            d = parser.parseLine(disassemble(word, addr));
+        } catch (const std::exception&) {
+            // An operand form the parser does not take: keep the raw word
+        }
+        if (!d) {
+            char buf[24];
+            std::snprintf(buf, sizeof buf, ".inst 0x%08x", word);
+            d = parser.parseLine(buf);
+        }
+        ai.inst = std::move(*d);
+        prog.addr2idx[addr] = i;
+        prog.code.push_back(std::move(ai));
+    }
+
+    for (AsmInst& ai : prog.code) predecode(ai, prog.labels, prog.code.size(), prog.base);
+    bindHostFunctions(prog);
+    fuseSuperinstructions(prog);
+    return prog;
+}
+
+uint64_t ElfExecutable::setupStack(Memory& mem, const std::vector<std::string>& argv,
+                                   const std::vector<std::string>& envp) const {
+    const uint64_t bottom = kStackTop - kStackSize;
+    if (!mem.map(bottom, kStackSize)) throw std::runtime_error("could not map the guest stack");
+
+    // Strings and the AT_RANDOM bytes at the top, highest first
+    uint64_t p = kStackTop;
+    auto pushString = [&](const std::string& s) {
+        p -= s.size() + 1;
+        writeBytes(mem, p, s.c_str(), s.size() + 1);
+        return p;
+    };
+    std::vector<uint64_t> argAddrs, envAddrs;
+    for (const std::string& e : envp) envAddrs.push_back(pushString(e));
+    for (const std::string& a : argv) argAddrs.push_back(pushString(a));
+    const uint64_t execfn = argAddrs.empty() ? 0 : argAddrs[0];
+
+    // AT_RANDOM seeds stack protectors and pointer guards; fixed so runs repeat
+    std::mt19937 rng(0xC0FFEEu);
+    uint8_t random[16];
+    for (uint8_t& b : random) b = static_cast<uint8_t>(rng());
+    p = (p - sizeof random) & ~15ull;
+    writeBytes(mem, p, random, sizeof random);
+    const uint64_t randomAddr = p;
+
+    const std::vector<std::pair<uint64_t, uint64_t>> auxv = {
+        {kAtPhdr, phdrAddr_}, {kAtPhent, phent_},  {kAtPhnum, phnum_},
+        {kAtPagesz, Memory::kPageSize}, {kAtBase, 0}, {kAtFlags, 0}, {kAtEntry, entry_},
+        {kAtUid, 0}, {kAtEuid, 0}, {kAtGid, 0}, {kAtEgid, 0}, {kAtHwcap, kHwcapFp | kHwcapAsimd}, {kAtClktck, 100},
+        {kAtSecure, 0}, {kAtRandom, randomAddr}, {kAtExecfn, execfn}, {kAtNull, 0},
+    };
+
+    // argc, argv[], NULL, envp[], NULL, auxv pairs; SP 16-byte aligned
+    const uint64_t words = 1 + (argv.size() + 1) + (envp.size() + 1) + 2 * auxv.size();
+    const uint64_t sp = (p - 8 * words) & ~15ull;
+    uint64_t w = sp;
+    auto push = [&](uint64_t v) { writeLE(mem, w, v); w += 8; };
+    push(argv.size());
+    for (uint64_t a : argAddrs) push(a);
+    push(0);
+    for (uint64_t e : envAddrs) push(e);
+    push(0);
+    for (const auto& [key, value] : auxv) { push(key); push(value); }
+    return sp;
+}
+
+} // namespace arm64
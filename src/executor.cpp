@@ -1,40 +1,66 @@
 #include "executor.hpp"
+#include "cfg.hpp"
+#include "mapped_file.hpp"
+#include "scan.hpp"
+#include "fp.hpp"
+#include "hle.hpp"
+#include "memory.hpp"
+#include "simd.hpp"
+#include "syscalls.hpp"
 
-#include <fstream>
-#include <sstream>
 #include <stdexcept>
 #include <algorithm>
 #include <cctype>
+#include <cstring>
+#include <sstream>
+#include <string_view>
+#include <vector>
 
 namespace arm64 {
 
 // String helpers
-static std::string trimCopy(std::string s) {
+static std::string trimCopy(std::string_view v) {
+    std::string s(v);
     auto not_space = [](int ch){ return !std::isspace(ch); };
     s.erase(s.begin(), std::find_if(s.begin(), s.end(), not_space));
     s.erase(std::find_if(s.rbegin(), s.rend(), not_space).base(), s.end());
     return s;
 }
 
-static std::string upperCopy(std::string s) {
+static std::string upperCopy(std::string_view v) {
+    std::string s(v);
     std::transform(s.begin(), s.end(), s.begin(),
                    [](unsigned char c){ return static_cast<char>(std::toupper(c)); });
     return s;
 }
 
 // Label collection
-static std::string collectLeadingLabels(std::string line,
-                                        uint64_t next_instr_addr,
-                                        std::unordered_map<std::string, uint64_t>& out) {
-    std::string s = trimCopy(std::move(line));
+static std::string_view trimView(std::string_view s) {
+    std::size_t b = 0, e = s.size();
+    while (b < e && std::isspace(static_cast<unsigned char>(s[b]))) ++b;
+    while (e > b && std::isspace(static_cast<unsigned char>(s[e - 1]))) --e;
+    return s.substr(b, e - b);
+}
+
+std::string_view collectLeadingLabels(std::string_view line,
+                                      uint64_t next_instr_addr,
+                                      LabelMap& out) {
+    std::string_view s = trimView(line);
     while (true) {
-        auto pos = s.find(':');
-        if (pos == std::string::npos) break;
-        std::string left = trimCopy(s.substr(0, pos));
-        std::string right = (pos + 1 < s.size()) ? trimCopy(s.substr(pos + 1)) : std::string{};
+        auto pos = scan::find(s, ':');
+        if (pos == std::string_view::npos) break;
+        std::string_view left = trimView(s.substr(0, pos));
+        std::string_view right = trimView(s.substr(pos + 1));
         if (left.empty()) break;
-        if (left.find_first_of(" \t") != std::string::npos) break;
-        out[upperCopy(left)] = next_instr_addr;
+        if (left.find_first_of(" \t") != std::string_view::npos) {
+            // objdump symbol header: "0000000000400580 <memcpy>:"
+            const std::size_t lt = left.find('<');
+            if (lt == std::string_view::npos || lt == 0 || left.back() != '>' || lt + 2 >= left.size()) break;
+            const std::string_view addr = trimView(left.substr(0, lt));
+            if (!std::all_of(addr.begin(), addr.end(), [](unsigned char c) { return std::isxdigit(c); })) break;
+            left = left.substr(lt + 1, left.size() - lt - 2);
+        }
+        out[upperCopy(std::string(left))] = next_instr_addr;
         s = right;
         if (s.empty()) break;
     }
@@ -45,10 +71,11 @@ static std::string collectLeadingLabels(std::string line,
 static bool isWReg(const std::string& tokU) { return !tokU.empty() && tokU[0] == 'W'; }
 // static bool isXReg(const std::string& tokU) { return !tokU.empty() && tokU[0] == 'X'; } // (unused)
 
+// Registers slot for an operand token: 0-30, XZR_INDEX or SP_INDEX; 999 if invalid.
 static unsigned regIndex(std::string tok) {
     std::string u = upperCopy(trimCopy(tok));
     if (u == "XZR" || u == "WZR") return Registers::XZR_INDEX;
-    if (u == "SP") return Registers::XZR_INDEX + 1; // sentinel for SP
+    if (u == "SP") return Registers::SP_INDEX;
     if ((u[0] == 'X' || u[0] == 'W') && u.size() >= 2) {
         for (size_t i = 1; i < u.size(); ++i)
             if (!std::isdigit(static_cast<unsigned char>(u[i]))) return 999;
@@ -58,6 +85,9 @@ static unsigned regIndex(std::string tok) {
     return 999;
 }
 
+// Value mask for a predecoded register view: all ones for Xn, low 32 bits for Wn.
+static inline uint64_t viewMask(uint8_t w) { return ~0ull >> (w * 32u); }
+
 // Memory helpers
 static uint64_t parseImm(std::string s) {
     s = trimCopy(s);
@@ -68,10 +98,15 @@ static uint64_t parseImm(std::string s) {
     return static_cast<uint64_t>(std::stoull(s, nullptr, 10));
 }
 
-static uint64_t effectiveAddr(const Operand& mem, const Registers& regs) {
-    const std::string& t = mem.raw;
+// Decode [base], [base, #imm], [base, #imm]! or [base, Rm{, LSL #n}] into pre.mem*.
+static void decodeMem(const Operand& mem, Predecoded& pre) {
+    std::string t(mem.raw());
+    if (!t.empty() && t.back() == '!') {
+        t.pop_back();
+        pre.memWb = 1; // pre-index
+    }
     if (t.size() < 2 || t.front() != '[' || t.back() != ']') {
-        throw std::runtime_error("invalid memory operand: " + t);
+        throw std::runtime_error("invalid memory operand: " + std::string(mem.raw()));
     }
 
     std::string inside = trimCopy(std::string(t.begin() + 1, t.end() - 1));
@@ -85,24 +120,12 @@ static uint64_t effectiveAddr(const Operand& mem, const Registers& regs) {
         rest = trimCopy(inside.substr(comma + 1));
     }
 
-    // base register
-    std::string bu = upperCopy(base);
-    unsigned b = regIndex(bu);
-
-    uint64_t base_val = 0;
-    if (b == Registers::XZR_INDEX) {
-        base_val = 0;
-    } else if (b == Registers::XZR_INDEX + 1) { // SP
-        base_val = regs.readSP();
-    } else if (b != 999) {
-        base_val = regs.readX(b); // base is always 64-bit address
-    } else {
-        throw std::runtime_error("invalid base register in memory operand: " + base);
-    }
+    // base register (always a 64-bit address)
+    unsigned b = regIndex(upperCopy(base));
+    if (b == 999) throw std::runtime_error("invalid base register in memory operand: " + base);
+    pre.memBase = static_cast<uint8_t>(b);
 
-    if (rest.empty()) {
-        return base_val;
-    }
+    if (rest.empty()) return;
 
     std::string idxTok = rest;
     std::string shiftTok;
@@ -112,107 +135,184 @@ static uint64_t effectiveAddr(const Operand& mem, const Registers& regs) {
         shiftTok = upperCopy(trimCopy(rest.substr(comma2 + 1)));
     }
 
-    uint64_t idx_val = 0;
     if (!idxTok.empty() && (idxTok[0] == '#' || std::isdigit(static_cast<unsigned char>(idxTok[0])))) {
-        idx_val = parseImm(idxTok);
-    } else {
-        // Register offset (Xn or Wn)
-        std::string iu = upperCopy(idxTok);
-        unsigned r = regIndex(iu);
-        if (r == 999) {
-            throw std::runtime_error("invalid index in memory operand: " + idxTok);
+        pre.memOffset = static_cast<int64_t>(parseImm(idxTok));
+        return;
+    }
+
+    // Register offset (Xn or Wn, zero-extended)
+    if (pre.memWb) throw std::runtime_error("writeback needs an immediate offset: " + std::string(mem.raw()));
+    std::string iu = upperCopy(idxTok);
+    unsigned r = regIndex(iu);
+    if (r == 999) {
+        throw std::runtime_error("invalid index in memory operand: " + idxTok);
+    }
+    pre.memIndex  = static_cast<uint8_t>(r);
+    pre.memIndexW = isWReg(iu) ? 1 : 0;
+
+    if (!shiftTok.empty()) {
+        const bool lsl  = shiftTok.rfind("LSL", 0) == 0;
+        const bool sxtw = shiftTok.rfind("SXTW", 0) == 0;
+        if (!lsl && !sxtw && shiftTok.rfind("UXTW", 0) != 0 && shiftTok.rfind("SXTX", 0) != 0) {
+            throw std::runtime_error("unsupported index shift (only LSL/UXTW/SXTW/SXTX allowed): " + shiftTok);
         }
-        if (r == Registers::XZR_INDEX) {
-            idx_val = 0;
-        } else if (iu.size() && iu[0] == 'W') {
-            idx_val = static_cast<uint64_t>(regs.readW(r)); // zero-extended
-        } else { // Xn
-            idx_val = regs.readX(r);
+        auto hash = shiftTok.find('#');
+        if (hash != std::string::npos) {
+            pre.memLsl = static_cast<uint8_t>(parseImm(shiftTok.substr(hash)) & 63);
+        } else if (lsl) {
+            throw std::runtime_error("missing shift immediate in: " + shiftTok);
         }
+        pre.memIndexSxt = sxtw ? 1 : 0;
+    }
+}
 
-        if (!shiftTok.empty()) {
-            if (shiftTok.rfind("LSL", 0) != 0) {
-                throw std::runtime_error("unsupported index shift (only LSL #imm allowed): " + shiftTok);
-            }
-            auto hash = shiftTok.find('#');
-            if (hash == std::string::npos) {
-                throw std::runtime_error("missing shift immediate in: " + shiftTok);
-            }
-            uint64_t sh = parseImm(shiftTok.substr(hash));
-            idx_val <<= (sh & 63);
-        }
+static inline uint64_t effectiveAddr(const Predecoded& p, const Registers& regs) {
+    const uint64_t sx = static_cast<uint64_t>(p.memIndexSxt) << 31; // (x ^ sx) - sx sign-extends a 32-bit x
+    const uint64_t idx = ((regs.get(p.memIndex) & viewMask(p.memIndexW)) ^ sx) - sx;
+    return regs.get(p.memBase) + (idx << p.memLsl) + static_cast<uint64_t>(p.memOffset);
+}
+
+// Shift or extend v (already masked to its register view) at the operation
+// width (w = 1 for 32-bit); callers mask the result to the destination.
+static inline uint64_t applyShift(uint64_t v, ShiftOp op, unsigned amt, uint8_t w) {
+    const unsigned bits = 64u >> w;
+    switch (op) {
+    case ShiftOp::Lsl:  return v << amt;
+    case ShiftOp::Lsr:  return v >> amt;
+    case ShiftOp::Asr:
+        return w ? static_cast<uint32_t>(static_cast<int32_t>(static_cast<uint32_t>(v)) >> amt)
+                 : static_cast<uint64_t>(static_cast<int64_t>(v) >> amt);
+    case ShiftOp::Ror:  return ((v >> amt) | (v << ((bits - amt) & 63))) & viewMask(w);
+    case ShiftOp::Uxtb: return (v & 0xFF) << amt;
+    case ShiftOp::Uxth: return (v & 0xFFFF) << amt;
+    case ShiftOp::Uxtw: return (v & 0xFFFF'FFFFull) << amt;
+    case ShiftOp::Sxtb: return static_cast<uint64_t>(static_cast<int64_t>(static_cast<int8_t>(v))) << amt;
+    case ShiftOp::Sxth: return static_cast<uint64_t>(static_cast<int64_t>(static_cast<int16_t>(v))) << amt;
+    case ShiftOp::Sxtw: return static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(v))) << amt;
+    case ShiftOp::Uxtx: case ShiftOp::Sxtx: return v << amt;
+    default:            return v;
+    }
+}
+
+// High 64 bits of the 128-bit product (SMULH/UMULH).
+static inline uint64_t mulHigh(uint64_t a, uint64_t b, bool sign) {
+#if defined(__SIZEOF_INT128__)
+    if (sign) return static_cast<uint64_t>((static_cast<__int128>(static_cast<int64_t>(a)) *
+                                            static_cast<int64_t>(b)) >> 64);
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+    // 32x32 partial products, then the two's-complement correction for signed operands
+    const uint64_t al = a & 0xFFFF'FFFFull, ah = a >> 32;
+    const uint64_t bl = b & 0xFFFF'FFFFull, bh = b >> 32;
+    const uint64_t ll = al * bl, lh = al * bh, hl = ah * bl, hh = ah * bh;
+    const uint64_t mid = (ll >> 32) + (lh & 0xFFFF'FFFFull) + (hl & 0xFFFF'FFFFull);
+    uint64_t hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    if (sign) {
+        if (static_cast<int64_t>(a) < 0) hi -= b;
+        if (static_cast<int64_t>(b) < 0) hi -= a;
+    }
+    return hi;
+#endif
+}
+
+// SDIV/UDIV at the operation width. A64 division never traps: x / 0 is 0 and
+// INT_MIN / -1 wraps back to INT_MIN.
+static inline uint64_t divide(uint64_t a, uint64_t b, bool sign, uint8_t w) {
+    if (b == 0) return 0;
+    if (!sign) return a / b;
+    if (w) {
+        const int32_t x = static_cast<int32_t>(static_cast<uint32_t>(a));
+        const int32_t y = static_cast<int32_t>(static_cast<uint32_t>(b));
+        if (y == -1) return static_cast<uint32_t>(0u - static_cast<uint32_t>(x));
+        return static_cast<uint32_t>(x / y);
     }
+    const int64_t x = static_cast<int64_t>(a), y = static_cast<int64_t>(b);
+    if (y == -1) return 0 - a;
+    return static_cast<uint64_t>(x / y);
+}
 
-    return base_val + idx_val;
+// Guest memory access. The stack is checked first; other addresses go to
+// the guest heap when one is attached (ExecState::memory). what names the
+// access in the error for unmapped addresses.
+static uint8_t* guestBytes(Stack& st, Memory* mem, uint64_t addr, std::size_t n, const char* what) {
+    if (addr >= st.base() && addr - st.base() <= st.size() && n <= st.size() - (addr - st.base()))
+        return st.data() + (addr - st.base());
+    if (mem) {
+        if (uint8_t* p = mem->translate(addr, n)) return p;
+    }
+    std::ostringstream ss;
+    ss << what << " of " << n << " bytes at 0x" << std::hex << addr << " out of guest memory bounds";
+    throw std::runtime_error(ss.str());
 }
 
-// Stack read/write
-static void stackWrite64(Stack& st, uint64_t addr, uint64_t v) {
-    if (addr < st.base() || addr + 8 > st.base() + st.size())
-        throw std::runtime_error("STR out of stack bounds");
-    std::size_t o = static_cast<std::size_t>(addr - st.base());
-    for (int i = 0; i < 8; ++i) st.write8(o + i, static_cast<uint8_t>((v >> (i*8)) & 0xFF));
+static void storeLE(uint8_t* p, uint64_t v, unsigned size) {
+    for (unsigned i = 0; i < size; ++i) p[i] = static_cast<uint8_t>(v >> (i * 8));
 }
-static uint64_t stackRead64(const Stack& st, uint64_t addr) {
-    if (addr < st.base() || addr + 8 > st.base() + st.size())
-        throw std::runtime_error("LDR out of stack bounds");
-    std::size_t o = static_cast<std::size_t>(addr - st.base());
+static uint64_t loadLE(const uint8_t* p, unsigned size) {
     uint64_t v = 0;
-    for (int i = 0; i < 8; ++i) v |= (static_cast<uint64_t>(st.read8(o + i)) << (i*8));
+    for (unsigned i = 0; i < size; ++i) v |= static_cast<uint64_t>(p[i]) << (i * 8);
     return v;
 }
-static void stackWrite8(Stack& st, uint64_t addr, uint8_t v) {
-    if (addr < st.base() || addr + 1 > st.base() + st.size())
-        throw std::runtime_error("STRB out of stack bounds");
-    std::size_t o = static_cast<std::size_t>(addr - st.base());
-    st.write8(o, v);
+
+static void stackWrite64(Stack& st, Memory* mem, uint64_t addr, uint64_t v) {
+    storeLE(guestBytes(st, mem, addr, 8, "STR"), v, 8);
+}
+static uint64_t stackRead64(Stack& st, Memory* mem, uint64_t addr) {
+    return loadLE(guestBytes(st, mem, addr, 8, "LDR"), 8);
+}
+static void stackWrite8(Stack& st, Memory* mem, uint64_t addr, uint8_t v) {
+    *guestBytes(st, mem, addr, 1, "STRB") = v;
+}
+static uint8_t stackRead8(Stack& st, Memory* mem, uint64_t addr) {
+    return *guestBytes(st, mem, addr, 1, "LDRB");
+}
+
+// 16-bit width
+static void stackWrite16(Stack& st, Memory* mem, uint64_t addr, uint16_t v) {
+    storeLE(guestBytes(st, mem, addr, 2, "STRH"), v, 2);
 }
-static uint8_t stackRead8(const Stack& st, uint64_t addr) {
-    if (addr < st.base() || addr + 1 > st.base() + st.size())
-        throw std::runtime_error("LDRB out of stack bounds");
-    std::size_t o = static_cast<std::size_t>(addr - st.base());
-    return st.read8(o);
+static uint16_t stackRead16(Stack& st, Memory* mem, uint64_t addr) {
+    return static_cast<uint16_t>(loadLE(guestBytes(st, mem, addr, 2, "LDRH"), 2));
 }
 
 // 32-bit width
-static void stackWrite32(Stack& st, uint64_t addr, uint32_t v) {
-    if (addr < st.base() || addr + 4 > st.base() + st.size())
-        throw std::runtime_error("STR (32) out of stack bounds");
-    std::size_t o = static_cast<std::size_t>(addr - st.base());
-    for (int i = 0; i < 4; ++i) st.write8(o + i, static_cast<uint8_t>((v >> (i*8)) & 0xFF));
-}
-static uint32_t stackRead32(const Stack& st, uint64_t addr) {
-    if (addr < st.base() || addr + 4 > st.base() + st.size())
-        throw std::runtime_error("LDR (32) out of stack bounds");
-    std::size_t o = static_cast<std::size_t>(addr - st.base());
-    uint32_t v = 0;
-    for (int i = 0; i < 4; ++i) v |= (static_cast<uint32_t>(st.read8(o + i)) << (i*8));
-    return v;
+static void stackWrite32(Stack& st, Memory* mem, uint64_t addr, uint32_t v) {
+    storeLE(guestBytes(st, mem, addr, 4, "STR (32)"), v, 4);
+}
+static uint32_t stackRead32(Stack& st, Memory* mem, uint64_t addr) {
+    return static_cast<uint32_t>(loadLE(guestBytes(st, mem, addr, 4, "LDR (32)"), 4));
+}
+
+// Register pairs (LDP/STP): elements of size bytes, one bounds check for the
+// whole pair.
+static void stackWritePair(Stack& st, Memory* mem, uint64_t addr, unsigned size, uint64_t a, uint64_t b) {
+    uint8_t* p = guestBytes(st, mem, addr, 2 * size, "STP");
+    storeLE(p, a, size);
+    storeLE(p + size, b, size);
+}
+static void stackReadPair(Stack& st, Memory* mem, uint64_t addr, unsigned size, uint64_t& a, uint64_t& b) {
+    const uint8_t* p = guestBytes(st, mem, addr, 2 * size, "LDP");
+    a = loadLE(p, size);
+    b = loadLE(p + size, size);
 }
 
-// Flags for SUB/CMP
-static void stackSubFlags64(ProcessorState& ps, uint64_t a, uint64_t b, uint64_t res) {
-    ps.N = (res >> 63) & 1;
-    ps.Z = (res == 0);
-    ps.C = (a >= b); // NOT borrow
-    const bool sa = (a >> 63) & 1;
-    const bool sb = (b >> 63) & 1;
-    const bool sr = (res >> 63) & 1;
-    ps.V = (sa != sb) && (sr != sa);
+// LD1/ST1 and FP/SIMD LDR/STR: n contiguous bytes with one bounds check.
+static void stackWriteBlock(Stack& st, Memory* mem, uint64_t addr, const uint8_t* in, std::size_t n,
+                            const char* what) {
+    std::memcpy(guestBytes(st, mem, addr, n, what), in, n);
 }
-static void stackSubFlags32(ProcessorState& ps, uint32_t a, uint32_t b, uint32_t res) {
-    ps.N = (res >> 31) & 1;
-    ps.Z = (res == 0);
-    ps.C = (a >= b);
-    const bool sa = (a >> 31) & 1;
-    const bool sb = (b >> 31) & 1;
-    const bool sr = (res >> 31) & 1;
-    ps.V = (sa != sb) && (sr != sa);
+static void stackReadBlock(Stack& st, Memory* mem, uint64_t addr, uint8_t* out, std::size_t n,
+                           const char* what) {
+    std::memcpy(out, guestBytes(st, mem, addr, n, what), n);
 }
 
+// ProcessorState::condition() takes the A64 encoding, which Cond follows.
+static_assert(static_cast<unsigned>(Cond::EQ) == 0 && static_cast<unsigned>(Cond::GT) == 12 &&
+              static_cast<unsigned>(Cond::NV) == 15, "Cond must use A64 condition encodings");
+
 //  Branch target resolver
-static bool tryParseHexAddrLabelish(std::string labelish, uint64_t& out_addr) {
-    std::string t = trimCopy(std::move(labelish));
+static bool tryParseHexAddrLabelish(std::string_view labelish, uint64_t& out_addr) {
+    std::string t = trimCopy(labelish);
     size_t cut = t.find_first_of(" <");
     if (cut != std::string::npos) t = t.substr(0, cut);
     t = trimCopy(t);
@@ -229,201 +329,1564 @@ static bool tryParseHexAddrLabelish(std::string labelish, uint64_t& out_addr) {
     catch (...) { return false; }
 }
 
-static uint64_t resolveBranchTarget(const AsmProgram& prog, const std::string& op_text) {
+static uint64_t resolveBranchTarget(const LabelMap& labels, std::string_view op_text) {
     uint64_t addr = 0;
     if (tryParseHexAddrLabelish(op_text, addr)) return addr;
     std::string key = upperCopy(trimCopy(op_text));
-    auto it = prog.labels.find(key);
-    if (it != prog.labels.end()) return it->second;
-    throw std::runtime_error("undefined label: " + op_text);
+    auto it = labels.find(key);
+    if (it != labels.end()) return it->second;
+    throw std::runtime_error("undefined label: " + std::string(op_text));
+}
+
+// objdump names a branch target "400580 <memcpy>"; with no +offset the
+// annotation is a symbol at that address. Existing labels win.
+static void collectTargetSymbol(const DecodedInstruction& inst, LabelMap& out) {
+    const int li = branchLabelOperand(inst.op);
+    if (li < 0 || inst.operands.size() <= static_cast<std::size_t>(li)) return;
+    const std::string_view raw = inst.operands[static_cast<std::size_t>(li)].raw();
+    const std::size_t lt = raw.find('<'), gt = raw.rfind('>');
+    if (lt == std::string_view::npos || gt == std::string_view::npos || gt <= lt + 1) return;
+    const std::string name(raw.substr(lt + 1, gt - lt - 1));
+    if (name.find_first_of("+- \t") != std::string::npos) return;
+    uint64_t addr = 0;
+    if (tryParseHexAddrLabelish(raw, addr)) out.emplace(upperCopy(name), addr);
+}
+
+// Resolved at build time; an undefined label is only an error if the branch executes.
+static uint64_t branchTarget(const AsmInst& ai) {
+    if (!ai.pre.hasTarget) {
+        const int li = branchLabelOperand(ai.inst.op);
+        throw std::runtime_error("undefined label: " + std::string(ai.inst.operands[static_cast<std::size_t>(li)].raw()));
+    }
+    return ai.pre.target;
+}
+
+// Operand decoding. Throws the error executing the instruction would raise;
+// predecode() records the failure and executeInst() re-raises it on execution.
+static void decodeReg(const Operand& o, uint8_t& slot, uint8_t& w, bool dest) {
+    std::string u = upperCopy(o.raw());
+    unsigned r = regIndex(u);
+    if (r == 999) throw std::runtime_error(dest ? std::string("invalid dest register")
+                                                : "invalid register: " + std::string(o.raw()));
+    slot = static_cast<uint8_t>(r);
+    w = isWReg(u) ? 1 : 0;
+}
+
+// "LSL #3", "SXTW", ... following a second source register.
+static void decodeShift(const Operand& o, Predecoded& p, bool allowExtend, uint8_t w,
+                        const std::string& up) {
+    static constexpr struct { std::string_view name; ShiftOp op; } kShiftNames[] = {
+        {"LSL", ShiftOp::Lsl},   {"LSR", ShiftOp::Lsr},   {"ASR", ShiftOp::Asr},   {"ROR", ShiftOp::Ror},
+        {"UXTB", ShiftOp::Uxtb}, {"UXTH", ShiftOp::Uxth}, {"UXTW", ShiftOp::Uxtw}, {"UXTX", ShiftOp::Uxtx},
+        {"SXTB", ShiftOp::Sxtb}, {"SXTH", ShiftOp::Sxth}, {"SXTW", ShiftOp::Sxtw}, {"SXTX", ShiftOp::Sxtx},
+    };
+    const std::string u = upperCopy(trimCopy(o.raw()));
+    const std::string name = u.substr(0, u.find_first_of(" \t#"));
+    ShiftOp op = ShiftOp::None;
+    for (const auto& k : kShiftNames)
+        if (k.name == name) op = k.op;
+    if (o.type != OperandType::Shift || op == ShiftOp::None)
+        throw std::runtime_error(up + ": expected a shift or extend, got: " + std::string(o.raw()));
+
+    const bool extend = op >= ShiftOp::Uxtb;
+    if (extend && !allowExtend)
+        throw std::runtime_error(up + " does not take an extended register: " + std::string(o.raw()));
+    if (!extend && u.find('#') == std::string::npos)
+        throw std::runtime_error("missing shift immediate in: " + std::string(o.raw()));
+    const int64_t limit = extend ? 4 : (w ? 31 : 63);
+    if (o.imm < 0 || o.imm > limit)
+        throw std::runtime_error(up + " shift amount out of range: " + std::string(o.raw()));
+
+    p.shift = op;
+    p.shiftAmt = static_cast<uint8_t>(o.imm);
+    p.shiftW = w;
+}
+
+// An AdvSIMD register operand: "v3.4s", "v3.s[1]", "v3.4s[1]", or a scalar
+// view "s0". esz/q/lane are -1 when the text does not give them.
+struct VecOperand {
+    uint8_t reg{0};
+    char    view{'V'};  // 'V', or B/H/S/D/Q for a scalar view
+    int     esz{-1};
+    int     q{-1};
+    int     lane{-1};
+};
+
+static VecOperand decodeVec(std::string_view raw, const std::string& up) {
+    const std::string u = upperCopy(trimCopy(raw));
+    auto bad = [&]() { return std::runtime_error(up + ": invalid vector register: " + std::string(raw)); };
+    VecOperand v;
+    std::size_t i = 1;
+    while (i < u.size() && std::isdigit(static_cast<unsigned char>(u[i]))) ++i;
+    if (u.empty() || i == 1 || i > 3) throw bad();
+    const int n = std::stoi(u.substr(1, i - 1));
+    if (n > 31) throw bad();
+    v.reg = static_cast<uint8_t>(n);
+    v.view = u[0];
+    if (i == u.size()) return v;
+    if (v.view != 'V' || u[i] != '.') throw bad();
+
+    std::size_t j = ++i;
+    while (j < u.size() && std::isdigit(static_cast<unsigned char>(u[j]))) ++j;
+    const int count = j > i ? std::stoi(u.substr(i, j - i)) : 0;
+    if (j == u.size()) throw bad();
+    switch (u[j]) {
+    case 'B': v.esz = 0; break;
+    case 'H': v.esz = 1; break;
+    case 'S': v.esz = 2; break;
+    case 'D': v.esz = 3; break;
+    default: throw bad();
+    }
+    if (count) {
+        const int bits = count * (8 << v.esz);
+        if (bits != 64 && bits != 128) throw bad();
+        v.q = bits == 128 ? 1 : 0;
+    }
+    if (++j < u.size()) {
+        if (u[j] != '[' || u.back() != ']' || j + 2 >= u.size()) throw bad();
+        const std::string idx = u.substr(j + 1, u.size() - j - 2);
+        for (char c : idx)
+            if (!std::isdigit(static_cast<unsigned char>(c))) throw bad();
+        v.lane = std::stoi(idx);
+        if (v.lane >= (16 >> v.esz)) throw std::runtime_error(up + ": element index out of range: " + std::string(raw));
+    }
+    return v;
+}
+
+// A whole vector operand ("v0.4s"): arrangement required, no element index.
+static VecOperand decodeVecArr(const Operand& o, const std::string& up) {
+    if (o.type != OperandType::Vector) throw std::runtime_error(up + ": expected a vector register, got: " + std::string(o.raw()));
+    const VecOperand v = decodeVec(o.raw(), up);
+    if (v.view != 'V' || v.q < 0 || v.lane >= 0)
+        throw std::runtime_error(up + ": expected Vn.<T> (8B, 16B, 4H, 8H, 2S, 4S, 1D, 2D): " + std::string(o.raw()));
+    return v;
+}
+
+// A vector element operand ("v0.s[1]").
+static VecOperand decodeVecElem(const Operand& o, const std::string& up) {
+    if (o.type != OperandType::Vector) throw std::runtime_error(up + ": expected a vector element, got: " + std::string(o.raw()));
+    const VecOperand v = decodeVec(o.raw(), up);
+    if (v.view != 'V' || v.lane < 0) throw std::runtime_error(up + ": expected Vn.<T>[index]: " + std::string(o.raw()));
+    return v;
+}
+
+// The general register paired with a vector element: Xn for D elements, Wn otherwise.
+static void decodeElemGpr(const Operand& o, Predecoded& p, uint8_t& slot, uint8_t& w, bool dest,
+                          const std::string& up) {
+    decodeReg(o, slot, w, dest);
+    if (w != (p.vesz == 3 ? 0 : 1))
+        throw std::runtime_error(up + (p.vesz == 3 ? ": D elements pair with Xn: " : ": B/H/S elements pair with Wn: ")
+                                 + std::string(o.raw()));
+}
+
+// LD1/ST1 {Vt.T, ...}, [Xn]{, #imm}
+static void decodeVecMem(const AsmInst& ai, Predecoded& p) {
+    const std::string& up = ai.inst.mnem;
+    const auto& ops = ai.inst.operands;
+    const bool post = ops.size() == 3 && ops[2].type == OperandType::Immediate;
+    if ((ops.size() != 2 && !post) || ops[0].type != OperandType::VList || ops[1].type != OperandType::Memory)
+        throw std::runtime_error(up + " expects {Vt.T, ...}, [Xn]{, #imm}");
+
+    const std::string list(ops[0].raw());
+    const std::string inside = list.substr(1, list.size() - 2);
+    std::size_t start = 0;
+    int first = -1, esz = -1, q = -1, count = 0;
+    while (start <= inside.size()) {
+        std::size_t comma = inside.find(',', start);
+        if (comma == std::string::npos) comma = inside.size();
+        const Operand elem{OperandType::Vector, trimCopy(inside.substr(start, comma - start))};
+        const VecOperand v = decodeVecArr(elem, up);
+        if (count == 0) { first = v.reg; esz = v.esz; q = v.q; }
+        else if (v.reg != ((first + count) & 31) || v.esz != esz || v.q != q)
+            throw std::runtime_error(up + ": list registers must be consecutive with one arrangement: " + list);
+        if (++count > 4) throw std::runtime_error(up + ": at most 4 registers: " + list);
+        start = comma + 1;
+    }
+
+    decodeMem(ops[1], p);
+    if (p.memWb || p.memOffset != 0 || p.memIndex != Registers::XZR_INDEX)
+        throw std::runtime_error(up + " addresses a plain [Xn]: " + std::string(ops[1].raw()));
+    p.rd = static_cast<uint8_t>(first);
+    p.vcount = static_cast<uint8_t>(count);
+    p.vesz = static_cast<uint8_t>(esz);
+    p.vq = static_cast<uint8_t>(q);
+    if (post) {
+        if (ops[2].imm != count * (q ? 16 : 8))
+            throw std::runtime_error(up + ": post-index must equal the bytes transferred: " + std::string(ops[2].raw()));
+        p.memWb = 1;
+        p.imm = ops[2].imm;
+    }
+}
+
+// AdvSIMD register operands.
+static void decodeVector(const AsmInst& ai, Predecoded& p) {
+    const std::string& up = ai.inst.mnem;
+    const auto& ops = ai.inst.operands;
+    const Opcode op = ai.inst.op;
+
+    auto setArr = [&](const VecOperand& v) {
+        p.vesz = static_cast<uint8_t>(v.esz);
+        p.vq = static_cast<uint8_t>(v.q);
+    };
+
+    switch (op) {
+    case Opcode::VAdd: case Opcode::VSub: case Opcode::VMul:
+    case Opcode::VAnd: case Opcode::VOrr: case Opcode::VEor: case Opcode::Cmeq: {
+        const bool zero = op == Opcode::Cmeq && ops.size() == 3 && ops[2].type == OperandType::Immediate;
+        if (ops.size() != 3) throw std::runtime_error(up + " expects Vd.T, Vn.T, Vm.T");
+        const VecOperand d = decodeVecArr(ops[0], up);
+        const VecOperand n = decodeVecArr(ops[1], up);
+        const VecOperand m = zero ? d : decodeVecArr(ops[2], up);
+        if (n.esz != d.esz || n.q != d.q || m.esz != d.esz || m.q != d.q)
+            throw std::runtime_error(up + ": operands must share one arrangement");
+        if (zero && ops[2].imm != 0) throw std::runtime_error(up + ": only #0 compares against an immediate");
+        if (op == Opcode::VMul && d.esz == 3) throw std::runtime_error(up + " has no 64-bit element form");
+        if ((op == Opcode::VAnd || op == Opcode::VOrr || op == Opcode::VEor) && d.esz != 0)
+            throw std::runtime_error(up + " expects an 8B or 16B arrangement");
+        p.rd = d.reg;
+        p.rn = n.reg;
+        p.rm = m.reg;
+        p.imm = zero ? 1 : 0; // CMEQ ..., #0
+        setArr(d);
+        break;
+    }
+
+    case Opcode::VMov: {
+        // MOV Vd.T, Vn.T (ORR Vd, Vn, Vn)
+        if (ops.size() != 2) throw std::runtime_error(up + " expects Vd.T, Vn.T");
+        const VecOperand d = decodeVecArr(ops[0], up);
+        const VecOperand n = decodeVecArr(ops[1], up);
+        if (d.esz != 0 || n.esz != 0 || n.q != d.q)
+            throw std::runtime_error(up + " expects Vd.8B, Vn.8B or Vd.16B, Vn.16B");
+        p.rd = d.reg;
+        p.rn = n.reg;
+        setArr(d);
+        break;
+    }
+
+    case Opcode::Ins: {
+        // INS Vd.T[i], Rn | INS Vd.T[i], Vn.T[j]
+        if (ops.size() != 2) throw std::runtime_error(up + " expects Vd.T[i], (Rn|Vn.T[j])");
+        const VecOperand d = decodeVecElem(ops[0], up);
+        p.rd = d.reg;
+        p.vesz = static_cast<uint8_t>(d.esz);
+        p.vlane = static_cast<uint8_t>(d.lane);
+        if (ops[1].type == OperandType::Register) {
+            p.vgpr = 1;
+            decodeElemGpr(ops[1], p, p.rn, p.rnW, false, up);
+        } else {
+            const VecOperand n = decodeVecElem(ops[1], up);
+            if (n.esz != d.esz) throw std::runtime_error(up + ": element sizes differ");
+            p.rn = n.reg;
+            p.vlane2 = static_cast<uint8_t>(n.lane);
+        }
+        break;
+    }
+
+    case Opcode::Umov: {
+        if (ops.size() != 2 || ops[0].type != OperandType::Register)
+            throw std::runtime_error(up + " expects Rd, Vn.T[i]");
+        const VecOperand n = decodeVecElem(ops[1], up);
+        p.rn = n.reg;
+        p.vesz = static_cast<uint8_t>(n.esz);
+        p.vlane = static_cast<uint8_t>(n.lane);
+        p.vgpr = 1;
+        decodeElemGpr(ops[0], p, p.rd, p.rdW, true, up);
+        break;
+    }
+
+    case Opcode::Dup: {
+        // DUP Vd.T, Rn | DUP Vd.T, Vn.Ts[j]
+        if (ops.size() != 2) throw std::runtime_error(up + " expects Vd.T, (Rn|Vn.T[j])");
+        const VecOperand d = decodeVecArr(ops[0], up);
+        p.rd = d.reg;
+        setArr(d);
+        if (d.esz == 3 && !d.q) throw std::runtime_error(up + " has no 1D form");
+        if (ops[1].type == OperandType::Register) {
+            p.vgpr = 1;
+            decodeElemGpr(ops[1], p, p.rn, p.rnW, false, up);
+        } else {
+            const VecOperand n = decodeVecElem(ops[1], up);
+            if (n.esz != d.esz) throw std::runtime_error(up + ": element sizes differ");
+            p.rn = n.reg;
+            p.vlane = static_cast<uint8_t>(n.lane);
+        }
+        break;
+    }
+
+    case Opcode::Addv: {
+        // ADDV <B|H|S>d, Vn.T
+        if (ops.size() != 2 || ops[0].type != OperandType::Vector)
+            throw std::runtime_error(up + " expects (Bd|Hd|Sd), Vn.T");
+        const VecOperand d = decodeVec(ops[0].raw(), up);
+        const VecOperand n = decodeVecArr(ops[1], up);
+        static constexpr char kViews[] = {'B', 'H', 'S'};
+        if (n.esz == 3 || (n.esz == 2 && !n.q))
+            throw std::runtime_error(up + " expects 8B, 16B, 4H, 8H or 4S: " + std::string(ops[1].raw()));
+        if (d.esz >= 0 || d.view != kViews[n.esz])
+            throw std::runtime_error(up + ": destination must be " + kViews[n.esz] + "n: " + std::string(ops[0].raw()));
+        p.rd = d.reg;
+        p.rn = n.reg;
+        setArr(n);
+        break;
+    }
+
+    case Opcode::Ld1: case Opcode::St1:
+        decodeVecMem(ai, p);
+        break;
+
+    default:
+        break;
+    }
+}
+
+// Sn or Dn for scalar FP; sets *esz to 2 or 3.
+static uint8_t decodeFpReg(const Operand& o, uint8_t& esz, const std::string& up) {
+    if (o.type != OperandType::Vector) throw std::runtime_error(up + ": expected Sn or Dn, got: " + std::string(o.raw()));
+    const VecOperand v = decodeVec(o.raw(), up);
+    if (v.esz >= 0 || (v.view != 'S' && v.view != 'D'))
+        throw std::runtime_error(up + ": expected Sn or Dn, got: " + std::string(o.raw()));
+    esz = v.view == 'S' ? 2 : 3;
+    return v.reg;
+}
+
+// "#1.5", "#-2.0e+00", "#0.0" as a double.
+static double parseFpImm(std::string_view raw, const std::string& up) {
+    std::string t = trimCopy(raw);
+    if (!t.empty() && t[0] == '#') t.erase(t.begin());
+    std::size_t used = 0;
+    double v = 0;
+    try { v = std::stod(t, &used); } catch (...) { used = 0; }
+    if (used == 0 || used != t.size()) throw std::runtime_error(up + ": invalid floating-point immediate: " + std::string(raw));
+    return v;
+}
+
+// Scalar FP and the FP system registers. form: FMOV 0 Vd<-Vn, 1 Vd<-Rn,
+// 2 Rd<-Vn, 3 Vd<-#imm; FCMP 1 against #0.0; MRS/MSR 0 NZCV, 1 FPCR, 2 FPSR,
+// 3 TPIDR_EL0.
+static void decodeFp(const AsmInst& ai, Predecoded& p) {
+    const std::string& up = ai.inst.mnem;
+    const auto& ops = ai.inst.operands;
+    const Opcode op = ai.inst.op;
+    auto isReg = [&](size_t i){ return i < ops.size() && ops[i].type == OperandType::Register; };
+    auto isImm = [&](size_t i){ return i < ops.size() && ops[i].type == OperandType::Immediate; };
+
+    // The general register that pairs with an FP value: Wn with Sn, Xn with Dn
+    auto pairedGpr = [&](const Operand& o, uint8_t& slot, uint8_t& w, bool dest, bool anyWidth) {
+        decodeReg(o, slot, w, dest);
+        if (!anyWidth && w != (p.vesz == 2 ? 1 : 0))
+            throw std::runtime_error(up + ": Sn pairs with Wn and Dn with Xn: " + std::string(o.raw()));
+    };
+
+    switch (op) {
+    case Opcode::Fmov:
+        if (ops.size() != 2) throw std::runtime_error(up + " expects 2 operands");
+        if (isReg(0)) {
+            p.rn = decodeFpReg(ops[1], p.vesz, up);
+            pairedGpr(ops[0], p.rd, p.rdW, true, false);
+            p.form = 2;
+        } else {
+            p.rd = decodeFpReg(ops[0], p.vesz, up);
+            if (isReg(1)) {
+                pairedGpr(ops[1], p.rn, p.rnW, false, false);
+                p.form = 1;
+            } else if (isImm(1)) {
+                const double v = parseFpImm(ops[1].raw(), up);
+                p.imm = static_cast<int64_t>(p.vesz == 2 ? fp::bitsOf(static_cast<float>(v)) : fp::bitsOf(v));
+                p.form = 3;
+            } else {
+                uint8_t esz = 0;
+                p.rn = decodeFpReg(ops[1], esz, up);
+                if (esz != p.vesz) throw std::runtime_error(up + ": operands must have the same precision");
+            }
+        }
+        break;
+
+    case Opcode::Fadd: case Opcode::Fsub: case Opcode::Fmul: case Opcode::Fdiv:
+    case Opcode::Fmadd: case Opcode::Fmsub: case Opcode::Fneg: case Opcode::Fabs: case Opcode::Fsqrt: {
+        const std::size_t n = (op == Opcode::Fmadd || op == Opcode::Fmsub) ? 4
+                            : (op == Opcode::Fneg || op == Opcode::Fabs || op == Opcode::Fsqrt) ? 2 : 3;
+        if (ops.size() != n) throw std::runtime_error(up + " expects " + std::to_string(n) + " FP registers");
+        uint8_t e1 = 0, e2 = 0, e3 = 0;
+        p.rd = decodeFpReg(ops[0], p.vesz, up);
+        p.rn = decodeFpReg(ops[1], e1, up);
+        e2 = e3 = e1;
+        if (n >= 3) p.rm = decodeFpReg(ops[2], e2, up);
+        if (n == 4) p.ra = decodeFpReg(ops[3], e3, up);
+        if (e1 != p.vesz || e2 != p.vesz || e3 != p.vesz)
+            throw std::runtime_error(up + ": operands must have the same precision");
+        break;
+    }
+
+    case Opcode::Fcmp: case Opcode::Fcmpe:
+        if (ops.size() != 2) throw std::runtime_error(up + " expects Vn, (Vm|#0.0)");
+        p.rn = decodeFpReg(ops[0], p.vesz, up);
+        if (isImm(1)) {
+            if (parseFpImm(ops[1].raw(), up) != 0.0) throw std::runtime_error(up + ": only #0.0 is allowed: " + std::string(ops[1].raw()));
+            p.form = 1;
+        } else {
+            uint8_t esz = 0;
+            p.rm = decodeFpReg(ops[1], esz, up);
+            if (esz != p.vesz) throw std::runtime_error(up + ": operands must have the same precision");
+        }
+        break;
+
+    case Opcode::Fcvt:
+        if (ops.size() != 2) throw std::runtime_error(up + " expects (Sd, Dn | Dd, Sn)");
+        p.rd = decodeFpReg(ops[0], p.vesz, up);
+        p.rn = decodeFpReg(ops[1], p.vesz2, up);
+        if (p.vesz == p.vesz2) throw std::runtime_error(up + " converts between S and D");
+        break;
+
+    case Opcode::Fcvtzs: case Opcode::Fcvtzu:
+        if (ops.size() != 2 || !isReg(0)) throw std::runtime_error(up + " expects Rd, (Sn|Dn)");
+        p.rn = decodeFpReg(ops[1], p.vesz, up);
+        pairedGpr(ops[0], p.rd, p.rdW, true, true);
+        break;
+
+    case Opcode::Scvtf: case Opcode::Ucvtf:
+        if (ops.size() != 2 || !isReg(1)) throw std::runtime_error(up + " expects (Sd|Dd), Rn");
+        p.rd = decodeFpReg(ops[0], p.vesz, up);
+        pairedGpr(ops[1], p.rn, p.rnW, false, true);
+        break;
+
+    case Opcode::Mrs: case Opcode::Msr: {
+        if (ops.size() != 2) throw std::runtime_error(up + " expects 2 operands");
+        const bool mrs = op == Opcode::Mrs;
+        const std::string name = upperCopy(trimCopy(ops[mrs ? 1 : 0].raw()));
+        if      (name == "NZCV") p.form = 0;
+        else if (name == "FPCR") p.form = 1;
+        else if (name == "FPSR") p.form = 2;
+        else if (name == "TPIDR_EL0") p.form = 3;
+        else throw std::runtime_error(up + ": unsupported system register: " + std::string(ops[mrs ? 1 : 0].raw()));
+        if (!isReg(mrs ? 0 : 1)) throw std::runtime_error(up + " expects an Xt register");
+        decodeReg(ops[mrs ? 0 : 1], mrs ? p.rd : p.rn, mrs ? p.rdW : p.rnW, mrs);
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+// UBFM/SBFM/BFM and the aliases that rewrite to them.
+static void decodeBitfield(const AsmInst& ai, Predecoded& p) {
+    const std::string& up = ai.inst.mnem;
+    const auto& ops = ai.inst.operands;
+    const Opcode op = ai.inst.op;
+    const bool extend = op >= Opcode::Uxtb && op <= Opcode::Sxtw;
+
+    auto isKind = [&](size_t i, OperandType t){ return i < ops.size() && ops[i].type == t; };
+    if (extend) {
+        if (ops.size() != 2 || !isKind(0, OperandType::Register) || !isKind(1, OperandType::Register))
+            throw std::runtime_error(up + " expects Rd, Rn");
+    } else if (ops.size() != 4 || !isKind(0, OperandType::Register) || !isKind(1, OperandType::Register) ||
+               !isKind(2, OperandType::Immediate) || !isKind(3, OperandType::Immediate)) {
+        throw std::runtime_error(up + " expects Rd, Rn, #imm, #imm");
+    }
+    decodeReg(ops[1], p.rn, p.rnW, false);
+    decodeReg(ops[0], p.rd, p.rdW, true);
+
+    const int64_t bits = p.rdW ? 32 : 64;
+    const int64_t a = extend ? 0 : ops[2].imm;
+    const int64_t b = extend ? 0 : ops[3].imm;
+    int64_t immr = a, imms = b;
+    switch (op) {
+    case Opcode::Ubfx: case Opcode::Sbfx: case Opcode::Bfxil:   // #lsb, #width
+    case Opcode::Ubfiz: case Opcode::Sbfiz: case Opcode::Bfi:
+        if (a < 0 || b < 1 || a + b > bits)
+            throw std::runtime_error(up + " bitfield out of range");
+        if (op == Opcode::Ubfx || op == Opcode::Sbfx || op == Opcode::Bfxil) {
+            immr = a;
+            imms = a + b - 1;
+        } else {
+            immr = (bits - a) & (bits - 1);
+            imms = b - 1;
+        }
+        break;
+    case Opcode::Uxtb: case Opcode::Sxtb: immr = 0; imms = 7;  break;
+    case Opcode::Uxth: case Opcode::Sxth: immr = 0; imms = 15; break;
+    case Opcode::Sxtw:                    immr = 0; imms = 31; break;
+    default: break; // UBFM/SBFM/BFM take immr, imms directly
+    }
+    if (immr < 0 || immr >= bits || imms < 0 || imms >= bits)
+        throw std::runtime_error(up + " bitfield out of range");
+
+    switch (op) {
+    case Opcode::Bfm: case Opcode::Bfi: case Opcode::Bfxil:
+        p.bf = 3; break;
+    case Opcode::Sbfm: case Opcode::Sbfx: case Opcode::Sbfiz:
+    case Opcode::Sxtb: case Opcode::Sxth: case Opcode::Sxtw:
+        p.bf = 2; break;
+    default:
+        p.bf = 1; break;
+    }
+
+    // DecodeBitMasks(immN, imms, immr) with the element size equal to the register size.
+    const unsigned W = static_cast<unsigned>(bits);
+    const unsigned r = static_cast<unsigned>(immr);
+    const unsigned s = static_cast<unsigned>(imms);
+    auto ones = [](unsigned n) { return n >= 64 ? ~0ull : (1ull << n) - 1; };
+    const uint64_t welem = ones(s + 1);
+    p.bfWmask = ((welem >> r) | (welem << ((W - r) & 63))) & ones(W);
+    p.bfTmask = ones(((s - r) & (W - 1)) + 1);
+    p.shiftAmt = static_cast<uint8_t>(r);
+    p.bfS = static_cast<uint8_t>(s);
+}
+
+static void decodeOperands(const AsmInst& ai, Predecoded& p) {
+    const std::string& up = ai.inst.mnem;
+    const auto& ops = ai.inst.operands;
+
+    auto isImm = [&](size_t i){ return i < ops.size() && ops[i].type == OperandType::Immediate; };
+    auto isReg = [&](size_t i){ return i < ops.size() && ops[i].type == OperandType::Register; };
+    auto isMem = [&](size_t i){ return i < ops.size() && ops[i].type == OperandType::Memory; };
+
+    // Second source: a register, or the zero slot plus an immediate.
+    auto decodeOp2 = [&](size_t i) {
+        if (isImm(i)) p.imm = ops[i].imm;
+        else          decodeReg(ops[i], p.rm, p.rmW, false);
+    };
+    // "#imm, LSL #12" folds into the immediate; other shifts take registers only
+    auto shiftImmediate = [&](size_t i) {
+        if (!isImm(i)) return;
+        if (p.shift != ShiftOp::Lsl) throw std::runtime_error(up + ": only LSL applies to an immediate");
+        p.imm = static_cast<int64_t>(static_cast<uint64_t>(p.imm) << p.shiftAmt);
+        p.shift = ShiftOp::None;
+        p.shiftAmt = 0;
+    };
+
+    switch (ai.inst.op) {
+    case Opcode::Mov:
+        if (ops.size() != 2) throw std::runtime_error("MOV expects 2 operands");
+        decodeOp2(1);
+        decodeReg(ops[0], p.rd, p.rdW, true);
+        break;
+
+    case Opcode::Movz: case Opcode::Movn: case Opcode::Movk: {
+        // Rd, #imm16{, LSL #(0|16|32|48)}; the shifted value is kept in imm
+        if ((ops.size() != 2 && ops.size() != 3) || !isReg(0) || !isImm(1))
+            throw std::runtime_error(up + " expects Rd, #imm16{, LSL #n}");
+        decodeReg(ops[0], p.rd, p.rdW, true);
+        if (ops[1].imm < 0 || ops[1].imm > 0xFFFF)
+            throw std::runtime_error(up + " immediate out of range: " + std::string(ops[1].raw()));
+        if (ops.size() == 3) {
+            decodeShift(ops[2], p, false, p.rdW, up);
+            if (p.shift != ShiftOp::Lsl || p.shiftAmt % 16 != 0)
+                throw std::runtime_error(up + " shift must be LSL #0, #16, #32 or #48: " + std::string(ops[2].raw()));
+        }
+        const unsigned lane = p.shiftAmt;
+        p.shift = ShiftOp::None;
+        p.shiftAmt = 0;
+        const uint64_t v = static_cast<uint64_t>(ops[1].imm) << lane;
+        p.imm = static_cast<int64_t>(ai.inst.op == Opcode::Movn ? ~v & viewMask(p.rdW) : v);
+        if (ai.inst.op == Opcode::Movk) p.bfWmask = 0xFFFFull << lane;
+        break;
+    }
+
+    case Opcode::Madd: case Opcode::Msub: case Opcode::Mneg:
+    case Opcode::Smull: case Opcode::Umull: case Opcode::Smulh: case Opcode::Umulh:
+    case Opcode::Sdiv: case Opcode::Udiv: {
+        const bool acc = ai.inst.op == Opcode::Madd || ai.inst.op == Opcode::Msub;
+        const std::size_t n = acc ? 4 : 3;
+        if (ops.size() != n || !isReg(0) || !isReg(1) || !isReg(2) || (acc && !isReg(3)))
+            throw std::runtime_error(up + (acc ? " expects Rd, Rn, Rm, Ra" : " expects Rd, Rn, Rm"));
+        decodeReg(ops[1], p.rn, p.rnW, false);
+        decodeReg(ops[2], p.rm, p.rmW, false);
+        uint8_t raW = 0;
+        if (acc) decodeReg(ops[3], p.ra, raW, false);
+        decodeReg(ops[0], p.rd, p.rdW, true);
+
+        const bool widen = ai.inst.op == Opcode::Smull || ai.inst.op == Opcode::Umull;
+        const bool high  = ai.inst.op == Opcode::Smulh || ai.inst.op == Opcode::Umulh;
+        if (widen && (p.rdW || !p.rnW || !p.rmW))
+            throw std::runtime_error(up + " expects Xd, Wn, Wm");
+        if (high && (p.rdW || p.rnW || p.rmW))
+            throw std::runtime_error(up + " expects Xd, Xn, Xm");
+        if (!widen && (p.rnW != p.rdW || p.rmW != p.rdW || (acc && raW != p.rdW)))
+            throw std::runtime_error(up + ": operands must all be Wn or all be Xn");
+        break;
+    }
+
+    case Opcode::Add: case Opcode::Sub: case Opcode::And: case Opcode::Orr: case Opcode::Eor:
+    case Opcode::Mul: case Opcode::Adds: case Opcode::Subs: case Opcode::Ands: {
+        const bool shifted = ai.inst.op != Opcode::Mul && ops.size() == 4;
+        if (ops.size() != 3 && !shifted) throw std::runtime_error(up + " expects 3 operands");
+        decodeReg(ops[1], p.rn, p.rnW, false);
+        decodeOp2(2);
+        decodeReg(ops[0], p.rd, p.rdW, true);
+        if (shifted) {
+            const bool arith = ai.inst.op == Opcode::Add || ai.inst.op == Opcode::Sub ||
+                               ai.inst.op == Opcode::Adds || ai.inst.op == Opcode::Subs;
+            decodeShift(ops[3], p, arith, p.rdW, up);
+            shiftImmediate(2);
+        }
+        break;
+    }
+
+    case Opcode::Adc: case Opcode::Adcs: case Opcode::Sbc: case Opcode::Sbcs:
+        if (ops.size() != 3 || !isReg(0) || !isReg(1) || !isReg(2))
+            throw std::runtime_error(up + " expects Rd, Rn, Rm");
+        decodeReg(ops[1], p.rn, p.rnW, false);
+        decodeReg(ops[2], p.rm, p.rmW, false);
+        decodeReg(ops[0], p.rd, p.rdW, true);
+        break;
+
+    case Opcode::Cmp: case Opcode::Cmn: case Opcode::Tst:
+        if ((ops.size() != 2 && ops.size() != 3) || !isReg(0))
+            throw std::runtime_error(up + " expects Rn, (Rm|#imm)");
+        decodeReg(ops[0], p.rn, p.rnW, false);
+        decodeOp2(1);
+        if (ops.size() == 3) {
+            decodeShift(ops[2], p, ai.inst.op != Opcode::Tst, p.rnW, up);
+            shiftImmediate(1);
+        }
+        break;
+
+    case Opcode::Lsl: case Opcode::Lsr: case Opcode::Asr: case Opcode::Ror:
+        // Immediate (UBFM/SBFM/EXTR alias) or register (LSLV, ...) amount
+        if (ops.size() != 3 || !isReg(0) || !isReg(1))
+            throw std::runtime_error(up + " expects Rd, Rn, (Rm|#imm)");
+        decodeReg(ops[1], p.rn, p.rnW, false);
+        decodeOp2(2);
+        decodeReg(ops[0], p.rd, p.rdW, true);
+        if (isImm(2) && (p.imm < 0 || p.imm >= (p.rdW ? 32 : 64)))
+            throw std::runtime_error(up + " shift amount out of range: " + std::string(ops[2].raw()));
+        p.shift = ai.inst.op == Opcode::Lsl ? ShiftOp::Lsl
+                : ai.inst.op == Opcode::Lsr ? ShiftOp::Lsr
+                : ai.inst.op == Opcode::Asr ? ShiftOp::Asr : ShiftOp::Ror;
+        p.shiftW = p.rdW;
+        break;
+
+    case Opcode::Ubfm: case Opcode::Sbfm: case Opcode::Bfm:
+    case Opcode::Ubfx: case Opcode::Sbfx: case Opcode::Ubfiz: case Opcode::Sbfiz:
+    case Opcode::Bfi: case Opcode::Bfxil:
+    case Opcode::Uxtb: case Opcode::Uxth: case Opcode::Sxtb: case Opcode::Sxth: case Opcode::Sxtw:
+        decodeBitfield(ai, p);
+        break;
+
+    case Opcode::Csel: case Opcode::Csinc: case Opcode::Csinv: case Opcode::Csneg:
+        if (ops.size() != 4) throw std::runtime_error(up + " expects Rd, Rn, Rm, cond");
+        decodeReg(ops[1], p.rn, p.rnW, false);
+        decodeReg(ops[2], p.rm, p.rmW, false);
+        decodeReg(ops[0], p.rd, p.rdW, true);
+        p.cond = static_cast<uint8_t>(ai.inst.cond);
+        p.selInvert = (ai.inst.op == Opcode::Csinv || ai.inst.op == Opcode::Csneg) ? 1 : 0;
+        p.imm = (ai.inst.op == Opcode::Csinc || ai.inst.op == Opcode::Csneg) ? 1 : 0;
+        break;
+
+    case Opcode::Cset: case Opcode::Csetm:
+        // CSET Rd, c == CSINC Rd, ZR, ZR, !c; CSETM Rd, c == CSINV Rd, ZR, ZR, !c
+        if (ops.size() != 2) throw std::runtime_error(up + " expects Rd, cond");
+        decodeReg(ops[0], p.rd, p.rdW, true);
+        p.cond = static_cast<uint8_t>(static_cast<unsigned>(ai.inst.cond) ^ 1u);
+        p.selInvert = (ai.inst.op == Opcode::Csetm) ? 1 : 0;
+        p.imm = (ai.inst.op == Opcode::Cset) ? 1 : 0;
+        break;
+
+    case Opcode::Cinc: case Opcode::Cinv: case Opcode::Cneg:
+        // CINC Rd, Rn, c == CSINC Rd, Rn, Rn, !c (likewise CINV/CSINV, CNEG/CSNEG)
+        if (ops.size() != 3) throw std::runtime_error(up + " expects Rd, Rn, cond");
+        decodeReg(ops[1], p.rn, p.rnW, false);
+        p.rm = p.rn;
+        p.rmW = p.rnW;
+        decodeReg(ops[0], p.rd, p.rdW, true);
+        p.cond = static_cast<uint8_t>(static_cast<unsigned>(ai.inst.cond) ^ 1u);
+        p.selInvert = (ai.inst.op == Opcode::Cinc) ? 0 : 1;
+        p.imm = (ai.inst.op == Opcode::Cinv) ? 0 : 1;
+        break;
+
+    case Opcode::Ccmp: case Opcode::Ccmn:
+        if (ops.size() != 4 || !isReg(0) || !isImm(2))
+            throw std::runtime_error(up + " expects Rn, (Rm|#imm), #nzcv, cond");
+        decodeReg(ops[0], p.rn, p.rnW, false);
+        decodeOp2(1);
+        if (ops[2].imm < 0 || ops[2].imm > 15)
+            throw std::runtime_error(up + " flags must be #0-#15: " + std::string(ops[2].raw()));
+        p.nzcv = static_cast<uint8_t>(ops[2].imm);
+        p.cond = static_cast<uint8_t>(ai.inst.cond);
+        break;
+
+    case Opcode::Ldr: case Opcode::Ldrb: case Opcode::Ldrh: case Opcode::Str: case Opcode::Strb:
+    case Opcode::Strh: case Opcode::Ldrsb: case Opcode::Ldrsh: case Opcode::Ldrsw: case Opcode::Ldp: case Opcode::Stp: case Opcode::VLdr: case Opcode::VStr: {
+        const bool pair = ai.inst.op == Opcode::Ldp || ai.inst.op == Opcode::Stp;
+        const bool fpsimd = ai.inst.op == Opcode::VLdr || ai.inst.op == Opcode::VStr;
+        const std::size_t m = pair ? 2 : 1; // index of the memory operand
+        const bool post = ops.size() == m + 2 && isImm(m + 1);
+        const bool rtOk = fpsimd ? ops[0].type == OperandType::Vector : isReg(0);
+        if ((ops.size() != m + 1 && !post) || !rtOk || (pair && !isReg(1)) || !isMem(m))
+            throw std::runtime_error(up + (pair ? " expects Rt, Rt2, [base{,#off}]" : " expects Rt, [base{,#off}]")
+                                     + " with optional writeback");
+        decodeMem(ops[m], p);
+        if (post) {
+            if (p.memWb || p.memOffset != 0 || p.memIndex != Registers::XZR_INDEX)
+                throw std::runtime_error(up + ": post-index needs a plain [base]: " + std::string(ops[m].raw()));
+            p.memWb = 1;
+            p.imm = ops[m + 1].imm;
+        }
+        if (pair && p.memIndex != Registers::XZR_INDEX)
+            throw std::runtime_error(up + " needs an immediate offset: " + std::string(ops[m].raw()));
+        if (fpsimd) {
+            // Bt/Ht/St/Dt/Qt: vesz is log2 of the access size (4 for Q)
+            static constexpr std::string_view kViews = "BHSDQ";
+            const VecOperand t = decodeVec(ops[0].raw(), up);
+            const std::size_t sz = kViews.find(t.view);
+            if (t.esz >= 0 || sz == std::string_view::npos)
+                throw std::runtime_error(up + " expects Bt, Ht, St, Dt or Qt: " + std::string(ops[0].raw()));
+            p.rd = t.reg;
+            p.vesz = static_cast<uint8_t>(sz);
+            break;
+        }
+        const Opcode op = ai.inst.op;
+        const bool load = op != Opcode::Str && op != Opcode::Strb && op != Opcode::Strh && op != Opcode::Stp;
+        decodeReg(ops[0], p.rd, p.rdW, load); // Rt
+        if (op == Opcode::Ldrsw && p.rdW) throw std::runtime_error(up + " needs an Xt destination");
+        if (pair) {
+            decodeReg(ops[1], p.rn, p.rnW, load); // Rt2
+            if (p.rnW != p.rdW) throw std::runtime_error(up + ": Rt and Rt2 must be the same width");
+        }
+        break;
+    }
+
+    case Opcode::Ld1: case Opcode::St1:
+    case Opcode::VAdd: case Opcode::VSub: case Opcode::VMul: case Opcode::VAnd: case Opcode::VOrr:
+    case Opcode::VEor: case Opcode::VMov: case Opcode::Cmeq: case Opcode::Addv: case Opcode::Dup:
+    case Opcode::Ins: case Opcode::Umov:
+        decodeVector(ai, p);
+        break;
+
+    case Opcode::Fmov: case Opcode::Fadd: case Opcode::Fsub: case Opcode::Fmul: case Opcode::Fdiv:
+    case Opcode::Fmadd: case Opcode::Fmsub: case Opcode::Fneg: case Opcode::Fabs: case Opcode::Fsqrt:
+    case Opcode::Fcmp: case Opcode::Fcmpe: case Opcode::Fcvt: case Opcode::Fcvtzs: case Opcode::Fcvtzu:
+    case Opcode::Scvtf: case Opcode::Ucvtf: case Opcode::Mrs: case Opcode::Msr:
+        decodeFp(ai, p);
+        break;
+
+    case Opcode::Svc:
+        if (ops.size() != 1 || ops[0].type != OperandType::Immediate
+            || ops[0].imm < 0 || ops[0].imm > 0xFFFF)
+            throw std::runtime_error("SVC expects #imm16");
+        p.imm = ops[0].imm;
+        break;
+
+    case Opcode::Udf: {
+        // "UDF #imm16", or ".inst 0x<word>" as objdump prints it
+        uint64_t word = 0;
+        if (ops.size() == 1 && ops[0].type == OperandType::Immediate)
+            word = static_cast<uint64_t>(ops[0].imm);
+        else if (ops.size() != 1 || !tryParseHexAddrLabelish(ops[0].raw(), word))
+            throw std::runtime_error(up + " expects a single immediate");
+        p.imm = static_cast<int64_t>(word);
+        break;
+    }
+
+    case Opcode::B:
+        if (ops.size() != 1 || ops[0].type != OperandType::Label)
+            throw std::runtime_error("B expects a single label/address operand");
+        break;
+
+    case Opcode::BCond: case Opcode::Bl:
+        if (ops.size() != 1 || ops[0].type != OperandType::Label)
+            throw std::runtime_error(up + " expects a single label/address operand");
+        break;
+
+    case Opcode::Blr: case Opcode::Br:
+        if (ops.size() != 1 || !isReg(0)) throw std::runtime_error(up + " expects a single register");
+        decodeReg(ops[0], p.rn, p.rnW, false);
+        break;
+
+    case Opcode::Ret:
+        // RET {Xn}; X30 by default
+        if (ops.size() > 1 || (ops.size() == 1 && !isReg(0)))
+            throw std::runtime_error("RET expects at most one register");
+        p.rn = 30;
+        if (ops.size() == 1) decodeReg(ops[0], p.rn, p.rnW, false);
+        break;
+
+    case Opcode::Cbz: case Opcode::Cbnz:
+        if (ops.size() != 2 || !isReg(0) || ops[1].type != OperandType::Label)
+            throw std::runtime_error(up + " expects Rt, label");
+        decodeReg(ops[0], p.rn, p.rnW, false);
+        break;
+
+    case Opcode::Tbz: case Opcode::Tbnz:
+        if (ops.size() != 3 || !isReg(0) || !isImm(1) || ops[2].type != OperandType::Label)
+            throw std::runtime_error(up + " expects Rt, #bit, label");
+        decodeReg(ops[0], p.rn, p.rnW, false);
+        if (ops[1].imm < 0 || ops[1].imm >= (p.rnW ? 32 : 64))
+            throw std::runtime_error(up + " bit number out of range: " + std::string(ops[1].raw()));
+        p.imm = ops[1].imm;
+        break;
+
+    default:
+        break;
+    }
 }
 
 // Build program
-AsmProgram buildFileProgram(const std::string& path, const Parser& parser) {
-    std::ifstream in(path);
-    if (!in) throw std::runtime_error("could not open input file: " + path);
+void predecode(AsmInst& ai, const LabelMap& labels, std::size_t codeSize, uint64_t base) {
+    Predecoded p{};
+    try {
+        decodeOperands(ai, p);
+        p.ok = true;
+    } catch (const std::exception&) {
+        p = Predecoded{};
+    }
+    ai.pre = p;
 
+    const int li = branchLabelOperand(ai.inst.op);
+    if (li < 0 || ai.inst.operands.size() <= static_cast<std::size_t>(li)) return;
+
+    uint64_t target = 0;
+    try {
+        target = resolveBranchTarget(labels, ai.inst.operands[static_cast<std::size_t>(li)].raw());
+    } catch (const std::exception&) {
+        return;
+    }
+    ai.pre.target = target;
+    ai.pre.hasTarget = true;
+    // Addresses are assigned 4 bytes apart from base, so the index is implied.
+    // Branching to the end address (index == codeSize) halts.
+    if (target >= base && (target - base) % 4 == 0 && (target - base) / 4 <= codeSize)
+        ai.pre.targetIdx = static_cast<uint32_t>((target - base) / 4);
+}
+
+AsmProgram buildProgramFromText(std::string_view text, const Parser& parser) {
     AsmProgram prog;
-    std::string line;
+    LabelMap symbols; // from "<name>" branch annotations
     std::size_t src_line = 0;
     std::size_t instrIndex = 0;
 
-    while (std::getline(in, line)) {
+    // At most one instruction per line. Reserving up front keeps a large
+    // listing from holding both the old and the grown array while it loads;
+    // pages past the last instruction are never touched.
+    prog.code.reserve(static_cast<std::size_t>(std::count(text.begin(), text.end(), '\n')) + 1);
+
+    scan::forEachLine(text, [&](std::string_view line) {
         ++src_line;
         const uint64_t next_addr = static_cast<uint64_t>(instrIndex) * 4ull;
 
-        std::string rest = collectLeadingLabels(line, next_addr, prog.labels);
-
-        std::string s = trimCopy(rest);
-        if (s.empty()) continue;
-        if (s.rfind("//", 0) == 0 || s[0] == ';') continue;
+        std::string_view s = collectLeadingLabels(line, next_addr, prog.labels);
+        if (s.empty()) return;
+        if (s.substr(0, 2) == "//" || s[0] == ';') return;
 
         auto decoded = parser.parseLine(s);
-        if (!decoded) continue;
+        if (!decoded) return;
+        collectTargetSymbol(*decoded, symbols);
 
         AsmInst ai;
         ai.addr = next_addr;
         ai.instrIndex = ++instrIndex;
+        ai.srcLine = src_line;
         ai.inst = std::move(*decoded);
 
         prog.addr2idx[ai.addr] = prog.code.size();
         prog.code.push_back(std::move(ai));
-    }
+    });
+
+    prog.labels.insert(symbols.begin(), symbols.end());
 
+    // Second pass: with every label known, resolve direct branch targets.
+    for (AsmInst& ai : prog.code) predecode(ai, prog.labels, prog.code.size());
+    bindHostFunctions(prog);
+    fuseSuperinstructions(prog);
     return prog;
 }
 
+AsmProgram buildFileProgram(const std::string& path, const Parser& parser) {
+    const MappedFile file(path);
+    return buildProgramFromText(file.view(), parser);
+}
+
+// Superinstructions
+static bool sameMem(const Predecoded& a, const Predecoded& b) {
+    return a.memBase == b.memBase && a.memIndex == b.memIndex && a.memIndexW == b.memIndexW &&
+           a.memLsl == b.memLsl && a.memOffset == b.memOffset;
+}
+
+static Fusion matchFusion(const AsmInst* ai, std::size_t avail) {
+    const Predecoded& p = ai[0].pre;
+    const Opcode op0 = ai[0].inst.op;
+    if (avail < 2 || !p.ok || !ai[1].pre.ok) return Fusion::None;
+    const Predecoded& q = ai[1].pre;
+    const Opcode op1 = ai[1].inst.op;
+
+    // The branch must resolve so the fused form cannot fail after the compare.
+    if (op0 == Opcode::Cmp && op1 == Opcode::BCond && q.hasTarget) return Fusion::CmpBranch;
+
+    if (op0 == Opcode::Mov && op1 == Opcode::Add) return Fusion::MovAdd;
+
+    // Increment in memory: one register, one address that it does not feed.
+    if (op0 == Opcode::Ldr && op1 == Opcode::Add && avail >= 3 && ai[2].pre.ok &&
+        ai[2].inst.op == Opcode::Str) {
+        const Predecoded& r = ai[2].pre;
+        const uint8_t t = p.rd;
+        if (t >= Registers::XZR_INDEX || p.memBase == t || p.memIndex == t) return Fusion::None;
+        if (q.rd != t || q.rn != t || r.rd != t) return Fusion::None;
+        if (q.rdW != p.rdW || q.rnW != p.rdW || r.rdW != p.rdW) return Fusion::None;
+        if (!sameMem(p, r) || p.memWb || r.memWb) return Fusion::None;
+        return Fusion::LoadAddStore;
+    }
+    return Fusion::None;
+}
+
+static std::size_t fusionLength(Fusion f) {
+    switch (f) {
+    case Fusion::CmpBranch:    return 2;
+    case Fusion::LoadAddStore: return 3;
+    case Fusion::MovAdd:       return 2;
+    default:                   return 1;
+    }
+}
+
+// A constant built 16 bits at a time (MOVZ/MOVN/MOV #imm, then MOVKs into the
+// same register) folds into one load of the final value. Returns the chain
+// length; a chain stops before any branch target.
+static std::size_t foldConstant(AsmInst* ai, std::size_t avail, const std::vector<bool>& leader,
+                                std::size_t i) {
+    Predecoded& p = ai[0].pre;
+    const Opcode op0 = ai[0].inst.op;
+    const bool movImm = op0 == Opcode::Mov && p.rm == Registers::XZR_INDEX && p.shift == ShiftOp::None;
+    if (!p.ok || !(op0 == Opcode::Movz || op0 == Opcode::Movn || movImm)) return 1;
+    if (p.rd >= Registers::XZR_INDEX) return 1;
+
+    uint64_t v = static_cast<uint64_t>(p.imm) & viewMask(p.rdW);
+    std::size_t len = 1;
+    while (len < avail && len < kMaxFusedLength && !leader[i + len]) {
+        const AsmInst& k = ai[len];
+        if (!k.pre.ok || k.inst.op != Opcode::Movk || k.pre.rd != p.rd || k.pre.rdW != p.rdW) break;
+        v = (v & ~k.pre.bfWmask) | static_cast<uint64_t>(k.pre.imm);
+        ++len;
+    }
+    if (len > 1) p.fuseImm = v;
+    return len;
+}
+
+void fuseSuperinstructions(AsmProgram& prog) {
+    const std::size_t n = prog.code.size();
+
+    // Leaders: basic block starts (cfg.hpp), i.e. direct branch targets, the
+    // instruction after a branch and host-function entries. Labels alone do
+    // not count; objdump listings label every address. Entering a group
+    // anywhere else (e.g. an indirect jump) is still exact, since members
+    // keep their own blocks.
+    const std::vector<bool> leader = blockLeaders(prog);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        AsmInst& ai = prog.code[i];
+        // executeInst() has to see host-function entries
+        if (ai.pre.host) { ai.pre.fuse = Fusion::None; ai.pre.fuseLen = 1; continue; }
+        const std::size_t folded = foldConstant(&ai, n - i, leader, i);
+        if (folded > 1) {
+            ai.pre.fuse = Fusion::MovConst;
+            ai.pre.fuseLen = static_cast<uint8_t>(folded);
+            continue;
+        }
+        ai.pre.fuse = matchFusion(&ai, n - i);
+        ai.pre.fuseLen = static_cast<uint8_t>(fusionLength(ai.pre.fuse));
+        for (std::size_t k = 1; k < ai.pre.fuseLen; ++k) {
+            if (leader[i + k]) { ai.pre.fuse = Fusion::None; ai.pre.fuseLen = 1; break; }
+        }
+    }
+}
+
 // Execute one instruction
-bool step(const AsmProgram& prog, Registers& regs, Stack& stack, uint64_t& pc) {
+bool step(const AsmProgram& prog, Registers& regs, Stack& stack, uint64_t& pc, ExecState& st) {
     if (prog.code.empty()) return false;
-    const uint64_t endAddr = (prog.code.size() * 4ull);
+    const uint64_t endAddr = prog.base + prog.code.size() * 4ull;
     if (pc == endAddr) return false;
 
     auto it = prog.addr2idx.find(pc);
     if (it == prog.addr2idx.end()) {
         throw std::runtime_error("PC points to unknown address: " + std::to_string(pc));
     }
-    const AsmInst& ai = prog.code[it->second];
+    return executeInst(prog.code[it->second], endAddr, regs, stack, pc, st);
+}
+
+bool step(const AsmProgram& prog, Registers& regs, Stack& stack, uint64_t& pc) {
+    ExecState st;
+    st.retPolicy = RetPolicy::HaltAlways;
+    return step(prog, regs, stack, pc, st);
+}
+
+// Register file access by slot; Wn views are masked, destinations zero-extend,
+// and writes to XZR land in the zero slot.
+static inline uint64_t srcVal(const Registers& regs, uint8_t slot, uint8_t w) {
+    return regs.get(slot) & viewMask(w);
+}
+static inline uint64_t op2Val(const Registers& regs, const Predecoded& p) {
+    uint64_t v = srcVal(regs, p.rm, p.rmW);
+    if (p.shift != ShiftOp::None) v = applyShift(v, p.shift, p.shiftAmt, p.shiftW);
+    return v + static_cast<uint64_t>(p.imm);
+}
+static inline void setDest(Registers& regs, const Predecoded& p, uint64_t v) {
+    regs.set(p.rd, v & viewMask(p.rdW));
+}
+static inline void doCmp(Registers& regs, const Predecoded& p) {
+    regs.state().setSub(srcVal(regs, p.rn, p.rnW), op2Val(regs, p), p.rnW ? 32u : 64u);
+}
+static inline void doCmn(Registers& regs, const Predecoded& p) {
+    regs.state().setAdd(srcVal(regs, p.rn, p.rnW), op2Val(regs, p), false, p.rnW ? 32u : 64u);
+}
+
+// Scalar FP views: Sn/Dn are lane 0 of Vn, and writing one zeroes the rest of Vn.
+static inline uint64_t fpBits(const Registers& regs, uint8_t n, unsigned esz) {
+    return regs.v(n).lane(esz, 0);
+}
+static inline void setFpBits(Registers& regs, uint8_t n, unsigned esz, uint64_t bits) {
+    VReg r{};
+    r.setLane(esz, 0, bits);
+    regs.v(n) = r;
+}
+template <class T>
+static inline T fpVal(const Registers& regs, uint8_t n) {
+    if constexpr (sizeof(T) == 4) return fp::asFloat(fpBits(regs, n, 2));
+    else                          return fp::asDouble(fpBits(regs, n, 3));
+}
+
+// FADD ... FSQRT at precision T; FMSUB is Ra - Rn*Rm == fma(-Rn, Rm, Ra).
+template <class T>
+static void fpArith(Registers& regs, const Predecoded& p, Opcode op) {
+    const fp::Rounding rm = fp::rounding(regs.fpcr());
+    const T a = fpVal<T>(regs, p.rn), b = fpVal<T>(regs, p.rm), c = fpVal<T>(regs, p.ra);
+    T r{};
+    switch (op) {
+    case Opcode::Fadd:  r = fp::eval(fp::Op::Add, a, b, c, rm); break;
+    case Opcode::Fsub:  r = fp::eval(fp::Op::Sub, a, b, c, rm); break;
+    case Opcode::Fmul:  r = fp::eval(fp::Op::Mul, a, b, c, rm); break;
+    case Opcode::Fdiv:  r = fp::eval(fp::Op::Div, a, b, c, rm); break;
+    case Opcode::Fmadd: r = fp::eval(fp::Op::Fma, a, b, c, rm); break;
+    case Opcode::Fmsub: r = fp::eval(fp::Op::Fma, -a, b, c, rm); break;
+    case Opcode::Fsqrt: r = fp::eval(fp::Op::Sqrt, a, b, c, rm); break;
+    default: break;
+    }
+    setFpBits(regs, p.rd, p.vesz, fp::bitsOf(r));
+}
+
+// Pop the return-address stack for a RET to target; false when the RET
+// halts instead (st.retPolicy).
+static bool returnTo(uint64_t target, ExecState& st) {
+    if (st.retPolicy == RetPolicy::HaltAlways) return false;
+    if (st.returnStack.empty()) {
+        // Returning from the entry function
+        return st.retPolicy != RetPolicy::HaltFromEntry;
+    }
+    if (st.returnStack.back() == target) ++st.rasHits;
+    else                                 ++st.rasMisses;
+    st.returnStack.pop_back();
+    return true;
+}
+
+bool executeInst(const AsmInst& ai, uint64_t endAddr, Registers& regs, Stack& stack, uint64_t& pc) {
+    ExecState st;
+    st.retPolicy = RetPolicy::HaltAlways;
+    return executeInst(ai, endAddr, regs, stack, pc, st);
+}
+
+bool executeInst(const AsmInst& ai, uint64_t endAddr, Registers& regs, Stack& stack, uint64_t& pc,
+                 ExecState& st) {
+    const Predecoded& p = ai.pre;
+    // Entry of a routine run on the host (its own first instruction may be
+    // one the emulator lacks): do the whole call, then RET X30
+    if (p.host && st.hostFunctions && callHostFunction(static_cast<HostFn>(p.host), regs, stack, st)) {
+        ++st.hostCalls;
+        if (!returnTo(regs.get(30), st)) return false;
+        pc = regs.get(30);
+        regs.writePC(pc);
+        return (pc != endAddr);
+    }
+
+    if (!p.ok) {
+        // Malformed operands: raise the error decoding found.
+        Predecoded scratch{};
+        decodeOperands(ai, scratch);
+    }
 
     // Default next PC (sequential)
     uint64_t nextPC = pc + 4ull;
 
-    const std::string up = upperCopy(ai.inst.mnem);
-    const auto& ops = ai.inst.operands;
+    auto src  = [&](uint8_t slot, uint8_t w) { return srcVal(regs, slot, w); };
+    auto op2  = [&]() { return op2Val(regs, p); };
+    auto dest = [&](uint64_t v) { setDest(regs, p, v); };
 
-    auto isImm = [&](size_t i){ return i < ops.size() && ops[i].type == OperandType::Immediate; };
-    auto isReg = [&](size_t i){ return i < ops.size() && ops[i].type == OperandType::Register; };
-    auto isMem = [&](size_t i){ return i < ops.size() && ops[i].type == OperandType::Memory; };
+    // execute
+    switch (ai.inst.op) {
+    case Opcode::Nop:
+        break;
 
-    auto regU = [&](size_t i){ return upperCopy(ops.at(i).raw); };
+    case Opcode::Mov:
+        dest(op2());
+        break;
 
-    auto readSrc64 = [&](size_t i)->uint64_t {
-        std::string u = regU(i);
-        unsigned r = regIndex(u);
-        if (r == Registers::XZR_INDEX) return 0;
-        if (r == Registers::XZR_INDEX + 1) return regs.readSP();
-        if (r == 999) throw std::runtime_error("invalid register: " + ops[i].raw);
-        if (isWReg(u)) return static_cast<uint64_t>(regs.readW(r));
-        return regs.readX(r);
-    };
-    auto writeDest = [&](size_t i, uint64_t value){
-        std::string u = regU(i);
-        unsigned r = regIndex(u);
-        if (r == Registers::XZR_INDEX) return;              // writes to XZR/WZR ignored
-        if (r == Registers::XZR_INDEX + 1) { regs.writeSP(value); return; }
-        if (r == 999) throw std::runtime_error("invalid dest register");
-        if (isWReg(u)) regs.writeW(r, static_cast<uint32_t>(value));
-        else           regs.writeX(r, value);
-    };
+    case Opcode::Add: dest(src(p.rn, p.rnW) + op2());   break;
+    case Opcode::Sub: dest(src(p.rn, p.rnW) - op2());   break;
+    case Opcode::And: dest(src(p.rn, p.rnW) & op2());   break;
+    case Opcode::Orr: dest(src(p.rn, p.rnW) | op2());   break;
+    case Opcode::Eor: dest(src(p.rn, p.rnW) ^ op2());   break;
+    case Opcode::Mul: dest(src(p.rn, p.rnW) * op2());   break; // low 64
 
-    auto readImm64 = [&](size_t i)->uint64_t {
-        if (!isImm(i)) throw std::runtime_error("immediate expected");
-        return static_cast<uint64_t>(ops[i].imm);
-    };
+    // MOVZ/MOVN carry their final value in imm; MOVK inserts it into Rd
+    case Opcode::Movz: case Opcode::Movn: dest(static_cast<uint64_t>(p.imm)); break;
+    case Opcode::Movk: dest((regs.get(p.rd) & ~p.bfWmask) | static_cast<uint64_t>(p.imm)); break;
 
-    // execute
-    if (up == "NOP") {}
-    else if (up == "MOV") {
-        if (ops.size() != 2) throw std::runtime_error("MOV expects 2 operands");
-        uint64_t v = isImm(1) ? readImm64(1) : readSrc64(1);
-        writeDest(0, v);
-    }
-    else if (up == "ADD" || up == "SUB" || up == "AND" || up == "EOR" || up == "MUL") {
-        if (ops.size() != 3) throw std::runtime_error(up + " expects 3 operands");
-        uint64_t a = readSrc64(1);
-        uint64_t b = isImm(2) ? readImm64(2) : readSrc64(2);
-
-        uint64_t res = 0;
-        if      (up == "ADD") res = a + b;
-        else if (up == "SUB") res = a - b;
-        else if (up == "AND") res = (a & b);
-        else if (up == "EOR") res = (a ^ b);
-        else                  res = (a * b); // MUL (low 64)
-        writeDest(0, res);
-    }
-    else if (up == "CMP") {
-        if (ops.size() != 2 || !isReg(0))
-            throw std::runtime_error("CMP expects Rn, (Rm|#imm)");
-        std::string rnU = regU(0);
-        uint64_t a = readSrc64(0);
-        uint64_t b = isImm(1) ? readImm64(1) : readSrc64(1);
-
-        if (isWReg(rnU)) {
-            uint32_t aa = static_cast<uint32_t>(a);
-            uint32_t bb = static_cast<uint32_t>(b);
-            uint32_t rr = static_cast<uint32_t>(aa - bb);
-            stackSubFlags32(regs.state(), aa, bb, rr);
-        } else {
-            uint64_t rr = a - b;
-            stackSubFlags64(regs.state(), a, b, rr);
-        }
+    case Opcode::Madd: dest(src(p.ra, p.rdW) + src(p.rn, p.rnW) * src(p.rm, p.rmW)); break;
+    case Opcode::Msub:
+    case Opcode::Mneg: dest(src(p.ra, p.rdW) - src(p.rn, p.rnW) * src(p.rm, p.rmW)); break;
+
+    case Opcode::Smull:
+        dest(static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(src(p.rn, 1))) *
+                                   static_cast<int64_t>(static_cast<int32_t>(src(p.rm, 1)))));
+        break;
+    case Opcode::Umull: dest(src(p.rn, 1) * src(p.rm, 1)); break;
+    case Opcode::Smulh: dest(mulHigh(regs.get(p.rn), regs.get(p.rm), true));  break;
+    case Opcode::Umulh: dest(mulHigh(regs.get(p.rn), regs.get(p.rm), false)); break;
+
+    case Opcode::Sdiv: dest(divide(src(p.rn, p.rnW), src(p.rm, p.rmW), true, p.rdW));  break;
+    case Opcode::Udiv: dest(divide(src(p.rn, p.rnW), src(p.rm, p.rmW), false, p.rdW)); break;
+
+    case Opcode::Cmp:
+        doCmp(regs, p);
+        break;
+
+    case Opcode::Cmn:
+        doCmn(regs, p);
+        break;
+
+    case Opcode::Tst:
+        regs.state().setLogic(src(p.rn, p.rnW) & op2(), p.rnW ? 32u : 64u);
+        break;
+
+    case Opcode::Adds: {
+        const uint64_t a = src(p.rn, p.rnW), b = op2();
+        dest(a + b);
+        regs.state().setAdd(a, b, false, p.rdW ? 32u : 64u);
+        break;
     }
-    else if (up == "LDR" || up == "LDRB") {
-        if (ops.size() != 2 || !isReg(0) || !isMem(1))
-            throw std::runtime_error(up + " expects Rt, [base{,#off}]");
-
-        uint64_t ea = effectiveAddr(ops[1], regs);
-
-        if (up == "LDRB") {
-            uint8_t byte = stackRead8(stack, ea);
-            std::string rtU = regU(0);
-            if (isWReg(rtU)) writeDest(0, static_cast<uint32_t>(byte));
-            else             writeDest(0, static_cast<uint64_t>(byte));
-        } else { // LDR
-            std::string rtU = regU(0);
-            if (isWReg(rtU)) {
-                uint32_t w = stackRead32(stack, ea);
-                writeDest(0, static_cast<uint64_t>(w)); // zero-extend
-            } else {
-                uint64_t x = stackRead64(stack, ea);
-                writeDest(0, x);
+    case Opcode::Subs: {
+        const uint64_t a = src(p.rn, p.rnW), b = op2();
+        dest(a - b);
+        regs.state().setSub(a, b, p.rdW ? 32u : 64u);
+        break;
+    }
+    case Opcode::Ands: {
+        const uint64_t r = src(p.rn, p.rnW) & op2();
+        dest(r);
+        regs.state().setLogic(r, p.rdW ? 32u : 64u);
+        break;
+    }
+
+    // SBC is ADC of ~Rm: Rn + ~Rm + C == Rn - Rm - !C
+    case Opcode::Adc: case Opcode::Adcs: case Opcode::Sbc: case Opcode::Sbcs: {
+        const bool sub = ai.inst.op == Opcode::Sbc || ai.inst.op == Opcode::Sbcs;
+        const uint64_t a = src(p.rn, p.rnW);
+        const uint64_t b = sub ? ~src(p.rm, p.rmW) & viewMask(p.rdW) : src(p.rm, p.rmW);
+        const bool c = regs.state().carry();
+        bool carryOut = false;
+        dest(addWithCarry(a, b, c, carryOut));
+        if (ai.inst.op == Opcode::Adcs || ai.inst.op == Opcode::Sbcs)
+            regs.state().setAdd(a, b, c, p.rdW ? 32u : 64u);
+        break;
+    }
+
+    case Opcode::Lsl: case Opcode::Lsr: case Opcode::Asr: case Opcode::Ror: {
+        const unsigned amt = static_cast<unsigned>((src(p.rm, p.rmW) + static_cast<uint64_t>(p.imm))
+                                                   & ((64u >> p.rdW) - 1));
+        dest(applyShift(src(p.rn, p.rnW), p.shift, amt, p.rdW));
+        break;
+    }
+
+    case Opcode::Ubfm: case Opcode::Sbfm: case Opcode::Bfm:
+    case Opcode::Ubfx: case Opcode::Sbfx: case Opcode::Ubfiz: case Opcode::Sbfiz:
+    case Opcode::Bfi: case Opcode::Bfxil:
+    case Opcode::Uxtb: case Opcode::Uxth: case Opcode::Sxtb: case Opcode::Sxth: case Opcode::Sxtw: {
+        const uint64_t v    = src(p.rn, p.rnW);
+        const unsigned r    = p.shiftAmt;
+        const uint64_t rot  = ((v >> r) | (v << (((64u >> p.rdW) - r) & 63))) & viewMask(p.rdW);
+        const uint64_t keep = (p.bf == 3) ? regs.get(p.rd) : 0;                  // BFM keeps Rd
+        const uint64_t top  = (p.bf == 2) ? 0 - ((v >> p.bfS) & 1) : keep;      // SBFM sign-fills
+        const uint64_t bot  = (rot & p.bfWmask) | (keep & ~p.bfWmask);
+        dest((top & ~p.bfTmask) | (bot & p.bfTmask));
+        break;
+    }
+
+    case Opcode::Csel: case Opcode::Csinc: case Opcode::Csinv: case Opcode::Csneg:
+    case Opcode::Cset: case Opcode::Csetm: case Opcode::Cinc: case Opcode::Cinv: case Opcode::Cneg: {
+        const uint64_t take = 0 - static_cast<uint64_t>(regs.state().condition(p.cond));
+        const uint64_t alt  = (src(p.rm, p.rmW) ^ (0 - static_cast<uint64_t>(p.selInvert)))
+                            + static_cast<uint64_t>(p.imm);
+        dest((src(p.rn, p.rnW) & take) | (alt & ~take));
+        break;
+    }
+
+    case Opcode::Ccmp:
+        if (regs.state().condition(p.cond)) doCmp(regs, p);
+        else                                regs.state().setNzcvBits(p.nzcv);
+        break;
+
+    case Opcode::Ccmn:
+        if (regs.state().condition(p.cond)) doCmn(regs, p);
+        else                                regs.state().setNzcvBits(p.nzcv);
+        break;
+
+    // Loads write the base back before Rt, so a load into its own base keeps
+    // the loaded value; stores read Rt before the base moves.
+    case Opcode::Ldr: {
+        const uint64_t ea = effectiveAddr(p, regs);
+        const uint64_t v = p.rdW ? stackRead32(stack, st.memory, ea) : stackRead64(stack, st.memory, ea); // W zero-extends
+        if (p.memWb) regs.set(p.memBase, ea + static_cast<uint64_t>(p.imm));
+        dest(v);
+        break;
+    }
+
+    case Opcode::Ldrb: {
+        const uint64_t ea = effectiveAddr(p, regs);
+        const uint64_t v = stackRead8(stack, st.memory, ea);
+        if (p.memWb) regs.set(p.memBase, ea + static_cast<uint64_t>(p.imm));
+        dest(v);
+        break;
+    }
+
+    case Opcode::Ldrh: {
+        const uint64_t ea = effectiveAddr(p, regs);
+        const uint64_t v = stackRead16(stack, st.memory, ea);
+        if (p.memWb) regs.set(p.memBase, ea + static_cast<uint64_t>(p.imm));
+        dest(v);
+        break;
+    }
+
+    // Sign-extended to 64 bits; dest() then keeps the low half for a Wt
+    case Opcode::Ldrsb: case Opcode::Ldrsh: case Opcode::Ldrsw: {
+        const uint64_t ea = effectiveAddr(p, regs);
+        int64_t v;
+        if (ai.inst.op == Opcode::Ldrsb)      v = static_cast<int8_t>(stackRead8(stack, st.memory, ea));
+        else if (ai.inst.op == Opcode::Ldrsh) v = static_cast<int16_t>(stackRead16(stack, st.memory, ea));
+        else                                  v = static_cast<int32_t>(stackRead32(stack, st.memory, ea));
+        if (p.memWb) regs.set(p.memBase, ea + static_cast<uint64_t>(p.imm));
+        dest(static_cast<uint64_t>(v));
+        break;
+    }
+
+    case Opcode::Str: {
+        const uint64_t ea = effectiveAddr(p, regs);
+        if (p.rdW) stackWrite32(stack, st.memory, ea, static_cast<uint32_t>(regs.get(p.rd)));
+        else       stackWrite64(stack, st.memory, ea, regs.get(p.rd));
+        if (p.memWb) regs.set(p.memBase, ea + static_cast<uint64_t>(p.imm));
+        break;
+    }
+
+    case Opcode::Strb: {
+        const uint64_t ea = effectiveAddr(p, regs);
+        stackWrite8(stack, st.memory, ea, static_cast<uint8_t>(regs.get(p.rd) & 0xFF));
+        if (p.memWb) regs.set(p.memBase, ea + static_cast<uint64_t>(p.imm));
+        break;
+    }
+
+    case Opcode::Strh: {
+        const uint64_t ea = effectiveAddr(p, regs);
+        stackWrite16(stack, st.memory, ea, static_cast<uint16_t>(regs.get(p.rd) & 0xFFFF));
+        if (p.memWb) regs.set(p.memBase, ea + static_cast<uint64_t>(p.imm));
+        break;
+    }
+
+    case Opcode::Ldp: {
+        const uint64_t ea = effectiveAddr(p, regs);
+        uint64_t a = 0, b = 0;
+        stackReadPair(stack, st.memory, ea, p.rdW ? 4u : 8u, a, b);
+        if (p.memWb) regs.set(p.memBase, ea + static_cast<uint64_t>(p.imm));
+        regs.set(p.rd, a);
+        regs.set(p.rn, b);
+        break;
+    }
+
+    case Opcode::Stp: {
+        const uint64_t ea = effectiveAddr(p, regs);
+        stackWritePair(stack, st.memory, ea, p.rdW ? 4u : 8u, regs.get(p.rd), regs.get(p.rn));
+        if (p.memWb) regs.set(p.memBase, ea + static_cast<uint64_t>(p.imm));
+        break;
+    }
+
+    // AdvSIMD. Writes to a 64-bit arrangement zero the top half of Vd.
+    case Opcode::VAdd: case Opcode::VSub: case Opcode::VMul:
+    case Opcode::VAnd: case Opcode::VOrr: case Opcode::VEor: case Opcode::Cmeq: {
+        static constexpr simd::BinOp kOps[] = {
+            simd::BinOp::Add, simd::BinOp::Sub, simd::BinOp::Mul,
+            simd::BinOp::And, simd::BinOp::Orr, simd::BinOp::Eor, simd::BinOp::Cmeq,
+        };
+        static const VReg kZero{};
+        const unsigned k = ai.inst.op == Opcode::Cmeq ? 6u
+                         : static_cast<unsigned>(ai.inst.op) - static_cast<unsigned>(Opcode::VAdd);
+        VReg& d = regs.v(p.rd);
+        simd::binary(kOps[k], p.vesz, d, regs.v(p.rn), p.imm ? kZero : regs.v(p.rm));
+        if (!p.vq) d.clearHi();
+        break;
+    }
+
+    case Opcode::VMov:
+        regs.v(p.rd) = regs.v(p.rn);
+        if (!p.vq) regs.v(p.rd).clearHi();
+        break;
+
+    case Opcode::Ins:
+        regs.v(p.rd).setLane(p.vesz, p.vlane, p.vgpr ? regs.get(p.rn) : regs.v(p.rn).lane(p.vesz, p.vlane2));
+        break;
+
+    case Opcode::Umov:
+        dest(regs.v(p.rn).lane(p.vesz, p.vlane));
+        break;
+
+    case Opcode::Dup: {
+        VReg& d = regs.v(p.rd);
+        simd::dup(p.vesz, d, p.vgpr ? regs.get(p.rn) : regs.v(p.rn).lane(p.vesz, p.vlane));
+        if (!p.vq) d.clearHi();
+        break;
+    }
+
+    case Opcode::Addv: {
+        VReg r{};
+        r.setLane(p.vesz, 0, simd::addAcross(p.vesz, regs.v(p.rn), p.vq));
+        regs.v(p.rd) = r;
+        break;
+    }
+
+    case Opcode::Ld1: case Opcode::St1: {
+        const uint64_t ea = effectiveAddr(p, regs);
+        const std::size_t bytes = p.vq ? 16 : 8;
+        uint8_t buf[64];
+        if (ai.inst.op == Opcode::Ld1) {
+            stackReadBlock(stack, st.memory, ea, buf, bytes * p.vcount, "LD1");
+            for (unsigned k = 0; k < p.vcount; ++k) {
+                VReg& v = regs.v((p.rd + k) & 31u);
+                std::memcpy(v.b, buf + k * bytes, bytes);
+                if (!p.vq) v.clearHi();
             }
+        } else {
+            for (unsigned k = 0; k < p.vcount; ++k)
+                std::memcpy(buf + k * bytes, regs.v((p.rd + k) & 31u).b, bytes);
+            stackWriteBlock(stack, st.memory, ea, buf, bytes * p.vcount, "ST1");
         }
+        if (p.memWb) regs.set(p.memBase, ea + static_cast<uint64_t>(p.imm));
+        break;
     }
-    else if (up == "STR" || up == "STRB") {
-        if (ops.size() != 2 || !isReg(0) || !isMem(1))
-            throw std::runtime_error(up + " expects Rt, [base{,#off}]");
 
-        uint64_t ea = effectiveAddr(ops[1], regs);
-        std::string rtU = regU(0);
+    case Opcode::VLdr: case Opcode::VStr: {
+        const uint64_t ea = effectiveAddr(p, regs);
+        const std::size_t bytes = std::size_t{1} << p.vesz;
+        if (ai.inst.op == Opcode::VLdr) {
+            VReg r{};
+            stackReadBlock(stack, st.memory, ea, r.b, bytes, "LDR");
+            if (p.memWb) regs.set(p.memBase, ea + static_cast<uint64_t>(p.imm));
+            regs.v(p.rd) = r;
+        } else {
+            stackWriteBlock(stack, st.memory, ea, regs.v(p.rd).b, bytes, "STR");
+            if (p.memWb) regs.set(p.memBase, ea + static_cast<uint64_t>(p.imm));
+        }
+        break;
+    }
 
-        if (up == "STRB") {
-            uint64_t v = readSrc64(0);
-            stackWrite8(stack, ea, static_cast<uint8_t>(v & 0xFF));
-        } else { // STR
-            if (isWReg(rtU)) {
-                uint32_t w = static_cast<uint32_t>(readSrc64(0));
-                stackWrite32(stack, ea, w);
-            } else {
-                uint64_t x = readSrc64(0);
-                stackWrite64(stack, ea, x);
-            }
+    // Scalar FP
+    case Opcode::Fmov:
+        switch (p.form) {
+        case 0:  setFpBits(regs, p.rd, p.vesz, fpBits(regs, p.rn, p.vesz)); break;
+        case 1:  setFpBits(regs, p.rd, p.vesz, src(p.rn, p.rnW)); break;
+        case 2:  dest(fpBits(regs, p.rn, p.vesz)); break;
+        default: setFpBits(regs, p.rd, p.vesz, static_cast<uint64_t>(p.imm)); break;
         }
+        break;
+
+    case Opcode::Fadd: case Opcode::Fsub: case Opcode::Fmul: case Opcode::Fdiv:
+    case Opcode::Fmadd: case Opcode::Fmsub: case Opcode::Fsqrt:
+        if (p.vesz == 3) fpArith<double>(regs, p, ai.inst.op);
+        else             fpArith<float>(regs, p, ai.inst.op);
+        break;
+
+    // Sign-bit operations, exact in every rounding mode
+    case Opcode::Fneg: case Opcode::Fabs: {
+        const uint64_t sign = 1ull << ((8u << p.vesz) - 1);
+        const uint64_t v = fpBits(regs, p.rn, p.vesz);
+        setFpBits(regs, p.rd, p.vesz, ai.inst.op == Opcode::Fneg ? v ^ sign : v & ~sign);
+        break;
     }
-    else if (up == "B") {
-        if (ops.size() != 1 || ops[0].type != OperandType::Label)
-            throw std::runtime_error("B expects a single label/address operand");
-        nextPC = resolveBranchTarget(prog, ops[0].raw);
+
+    case Opcode::Fcmp: case Opcode::Fcmpe:
+        if (p.vesz == 3) regs.state().setNzcvBits(fp::compare(fpVal<double>(regs, p.rn),
+                                                              p.form ? 0.0 : fpVal<double>(regs, p.rm)));
+        else             regs.state().setNzcvBits(fp::compare(fpVal<float>(regs, p.rn),
+                                                              p.form ? 0.0f : fpVal<float>(regs, p.rm)));
+        break;
+
+    case Opcode::Fcvt:
+        if (p.vesz == 3) setFpBits(regs, p.rd, 3, fp::bitsOf(static_cast<double>(fpVal<float>(regs, p.rn))));
+        else setFpBits(regs, p.rd, 2, fp::bitsOf(fp::narrow(fpVal<double>(regs, p.rn), fp::rounding(regs.fpcr()))));
+        break;
+
+    case Opcode::Fcvtzs: case Opcode::Fcvtzu: {
+        const bool sgn = ai.inst.op == Opcode::Fcvtzs;
+        const unsigned bits = p.rdW ? 32u : 64u;
+        dest(p.vesz == 3 ? fp::toIntTrunc(fpVal<double>(regs, p.rn), sgn, bits)
+                         : fp::toIntTrunc(fpVal<float>(regs, p.rn), sgn, bits));
+        break;
     }
-    else if (up == "B.GT" || up == "B.LE") {
-        if (ops.size() != 1 || ops[0].type != OperandType::Label)
-            throw std::runtime_error(up + " expects a single label/address operand");
-        const auto& ps = regs.state();
-        bool take = (up == "B.GT") ? (!ps.Z && (ps.N == ps.V))
-                                   : ( ps.Z || (ps.N != ps.V));
-        if (take) nextPC = resolveBranchTarget(prog, ops[0].raw);
+
+    case Opcode::Scvtf: case Opcode::Ucvtf: {
+        const bool sgn = ai.inst.op == Opcode::Scvtf;
+        uint64_t v = src(p.rn, p.rnW);
+        if (sgn && p.rnW) v = static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(v)));
+        const fp::Rounding rm = fp::rounding(regs.fpcr());
+        setFpBits(regs, p.rd, p.vesz, p.vesz == 3 ? fp::bitsOf(fp::fromInt<double>(v, sgn, rm))
+                                                  : fp::bitsOf(fp::fromInt<float>(v, sgn, rm)));
+        break;
     }
-    else if (up == "RET") {
-        return false; // halt emulation
+
+    case Opcode::Mrs:
+        if (p.form == 0) {
+            const ProcessorState::Nzcv f = regs.state().nzcv();
+            dest(static_cast<uint64_t>((f.N << 3) | (f.Z << 2) | (f.C << 1) | f.V) << 28);
+        } else if (p.form == 3) {
+            dest(regs.tpidr());
+        } else {
+            dest(p.form == 1 ? regs.fpcr() : regs.fpsr());
+        }
+        break;
+
+    case Opcode::Msr: {
+        const uint64_t v = regs.get(p.rn);
+        if (p.form == 0)      regs.state().setNzcvBits(static_cast<unsigned>(v >> 28));
+        else if (p.form == 1) regs.setFpcr(static_cast<uint32_t>(v));
+        else if (p.form == 2) regs.setFpsr(static_cast<uint32_t>(v));
+        else                  regs.setTpidr(v);
+        break;
     }
-    else {
+
+    // The immediate is ignored, as by the Linux kernel
+    case Opcode::Svc:
+        if (!emulateSyscall(regs, stack, st)) {
+            pc = nextPC;
+            regs.writePC(pc);
+            return false;
+        }
+        break;
+
+    // ".inst" is what the A64 decoder emits for words it does not implement
+    case Opcode::Udf:
+        throw std::runtime_error((ai.inst.mnem == ".INST" ? "unsupported instruction word "
+                                                          : "undefined instruction: UDF ") + std::string(ai.inst.operands[0].raw()));
+
+    case Opcode::B:
+        nextPC = branchTarget(ai);
+        break;
+
+    case Opcode::BCond:
+        if (regs.state().condition(static_cast<unsigned>(ai.inst.cond)))
+            nextPC = branchTarget(ai);
+        break;
+
+    case Opcode::Bl: {
+        nextPC = branchTarget(ai);
+        regs.set(30, pc + 4);
+        st.returnStack.push_back(pc + 4);
+        break;
+    }
+
+    case Opcode::Blr:
+        nextPC = regs.get(p.rn); // read before linking: BLR X30 is valid
+        regs.set(30, pc + 4);
+        st.returnStack.push_back(pc + 4);
+        break;
+
+    case Opcode::Br:
+        nextPC = regs.get(p.rn);
+        break;
+
+    case Opcode::Cbz:  if (src(p.rn, p.rnW) == 0) nextPC = branchTarget(ai); break;
+    case Opcode::Cbnz: if (src(p.rn, p.rnW) != 0) nextPC = branchTarget(ai); break;
+    case Opcode::Tbz:  if (((regs.get(p.rn) >> p.imm) & 1) == 0) nextPC = branchTarget(ai); break;
+    case Opcode::Tbnz: if (((regs.get(p.rn) >> p.imm) & 1) != 0) nextPC = branchTarget(ai); break;
+
+    case Opcode::Ret:
+        nextPC = regs.get(p.rn);
+        if (!returnTo(nextPC, st)) return false; // halt emulation
+        break;
+
+    default:
         // Unimplemented mnemonic — treat as NOP or throw:
         // throw std::runtime_error("unimplemented instruction: " + up);
+        break;
     }
 
+    regs.clearZeroSlot();
     pc = nextPC;
     regs.writePC(pc);
     return (pc != endAddr);
 }
 
-} // namespace arm64
\ No newline at end of file
+bool executeFused(const AsmInst* ai, uint64_t endAddr, Registers& regs, Stack& stack, uint64_t& pc,
+                  ExecState& st, std::size_t& retired) {
+    const Predecoded& p = ai[0].pre;
+    switch (p.fuse) {
+    case Fusion::CmpBranch:
+        doCmp(regs, p);
+        pc = regs.state().condition(static_cast<unsigned>(ai[1].inst.cond)) ? ai[1].pre.target : pc + 8;
+        retired += 2;
+        break;
+
+    case Fusion::LoadAddStore: {
+        // Rt is not XZR/SP and does not feed the address, so one EA serves both
+        // accesses and the store cannot fail once the load succeeded.
+        const uint64_t ea = effectiveAddr(p, regs);
+        setDest(regs, p, p.rdW ? stackRead32(stack, st.memory, ea) : stackRead64(stack, st.memory, ea));
+        const Predecoded& a = ai[1].pre;
+        setDest(regs, a, srcVal(regs, a.rn, a.rnW) + op2Val(regs, a));
+        if (p.rdW) stackWrite32(stack, st.memory, ea, static_cast<uint32_t>(regs.get(p.rd)));
+        else       stackWrite64(stack, st.memory, ea, regs.get(p.rd));
+        pc += 12;
+        retired += 3;
+        break;
+    }
+
+    case Fusion::MovAdd: {
+        setDest(regs, p, op2Val(regs, p));
+        regs.clearZeroSlot();
+        const Predecoded& a = ai[1].pre;
+        setDest(regs, a, srcVal(regs, a.rn, a.rnW) + op2Val(regs, a));
+        pc += 8;
+        retired += 2;
+        break;
+    }
+
+    case Fusion::MovConst:
+        regs.set(p.rd, p.fuseImm);
+        pc += 4ull * p.fuseLen;
+        retired += p.fuseLen;
+        break;
+
+    // Rewritten members stand in for instructions that cannot branch or
+    // fault; anything that leaves the window ends it.
+    case Fusion::Block:
+        for (std::size_t k = 0; k < p.fuseLen; ++k) {
+            const AsmInst& m = ai[k];
+            switch (m.pre.opt) {
+            case OptAction::Skip:  break;
+            case OptAction::Const: regs.set(m.pre.rd, m.pre.optImm); break;
+            case OptAction::Move:  regs.set(m.pre.rd, regs.get(m.pre.optSrc) & m.pre.optImm); break;
+            case OptAction::Keep:
+                if (!executeInst(m, endAddr, regs, stack, pc, st)) { retired += k + 1; return false; }
+                if (pc != m.addr + 4) { retired += k + 1; return true; }
+                continue;
+            }
+            regs.clearZeroSlot();
+            pc = m.addr + 4;
+        }
+        retired += p.fuseLen;
+        break;
+
+    default:
+        ++retired;
+        return executeInst(*ai, endAddr, regs, stack, pc, st);
+    }
+
+    regs.clearZeroSlot();
+    regs.writePC(pc);
+    return (pc != endAddr);
+}
+
+} // namespace arm64
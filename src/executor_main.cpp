@@ -1,13 +1,21 @@
 // src/executor_main.cpp
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "parser.hpp"
-#include "executor.hpp"   // buildFileProgram(...) and step(...)
-#include "registers.hpp"
-#include "stack.hpp"
+#include "cfg.hpp"        // --cfg / --profile
+#include "elf_loader.hpp" // isElfFile(...)
+#include "lazy_program.hpp"
+#include "machine.hpp"    // program, registers, stack, memory and the run loop
+#include "watchdog.hpp"   // --max-steps / --timeout-ms
 
 using namespace arm64;
 
@@ -18,75 +26,215 @@ static std::string hex64(uint64_t v) {
     return ss.str();
 }
 
+// A --max-steps / --timeout-ms value: decimal digits only.
+static bool parseLimit(const std::string& v, uint64_t& n) {
+    std::size_t used = 0;
+    try { n = std::stoull(v, &used); } catch (...) { used = 0; }
+    return !v.empty() && used == v.size() && v[0] != '-';
+}
+
+// --status-file: one line naming why the run stopped ("exit 7", "step-limit",
+// ...), so callers need not guess from an exit status the guest can also use.
+static void writeStatusFile(const std::string& path, const std::string& line) {
+    if (path.empty()) return;
+    std::ofstream out(path);
+    out << line << "\n";
+    if (!out) std::cerr << "cannot write " << path << "\n";
+}
+
+// --profile: the most executed loops, by how often their header ran.
+static void printHotLoops(const ControlFlowGraph& cfg, const AsmProgram& prog,
+                          const std::vector<uint64_t>& counts) {
+    std::vector<std::size_t> order(cfg.loops().size());
+    for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return counts[cfg.loops()[a].header] > counts[cfg.loops()[b].header];
+    });
+    if (order.size() > 10) order.resize(10);
+
+    std::cout << std::dec << "Hot loops (" << cfg.loops().size() << " found):\n";
+    for (std::size_t li : order) {
+        const Loop& l = cfg.loops()[li];
+        std::cout << "  header " << hex64(prog.code[cfg.blocks()[l.header].first].addr)
+                  << "  depth " << l.depth << "  blocks " << l.blocks.size()
+                  << "  header runs " << counts[l.header] << "\n";
+    }
+    std::cout << "\n";
+}
+
 int main(int argc, char** argv) {
     if (argc < 2) {
         std::cerr
-            << "usage: " << argv[0] << " <input.asm> [--dump-regs] [--dump-stack] [--random-stack]\n";
+            << "usage: " << argv[0] << " <input.asm|static-elf> [--dump-regs] [--dump-stack] [--random-stack] [--cache[=FILE]]"
+               " [--dump-vregs] [--lazy[=N]] [--quiet] [--optimize] [--fast-loops[=verify]]"
+               " [--ret=always|entry|never] [--no-hle] [--cfg=FILE.dot|FILE.json] [--profile]"
+               " [--max-steps=N] [--timeout-ms=N] [--status-file=FILE] [--env=NAME=VALUE] [-- guest args...]\n";
         return 1;
     }
 
     const std::string path = argv[1];
-    bool dumpRegs = false, dumpStack = false, randomStack = false;
+    bool dumpRegs = false, dumpStack = false, randomStack = false, useCache = false, quiet = false;
+    bool dumpVRegs = false, profile = false, optimize = false;
+    bool fastLoops = false, verifyLoops = false;
+    std::string cfgPath; // --cfg: DOT if it ends in ".dot", JSON otherwise
+    std::size_t lazyCache = 0; // 0 = decode everything up front
+    RetPolicy retPolicy = RetPolicy::HaltFromEntry; // RET halts when returning from the entry function by default
+    bool hostFunctions = true;
+    RunLimits limits;          // --max-steps / --timeout-ms
+    std::string statusPath;    // --status-file
+    std::string imagePath;     // --cache=FILE
+    std::vector<std::string> guestArgs{path}, guestEnv; // ELF process argv/envp
     for (int i = 2; i < argc; ++i) {
         std::string f = argv[i];
+        if (f == "--") {
+            guestArgs.insert(guestArgs.end(), argv + i + 1, argv + argc);
+            break;
+        }
         if (f == "--dump-regs")      dumpRegs = true;
         else if (f == "--dump-stack") dumpStack = true;
+        else if (f == "--dump-vregs") dumpVRegs = true;
         else if (f == "--random-stack") randomStack = true;
+        else if (f == "--cache")      useCache = true;
+        else if (f.rfind("--cache=", 0) == 0) { useCache = true; imagePath = f.substr(8); }
+        else if (f == "--quiet")      quiet = true;
+        else if (f == "--ret=always") retPolicy = RetPolicy::HaltAlways;
+        else if (f == "--ret=entry")  retPolicy = RetPolicy::HaltFromEntry;
+        else if (f == "--ret=never")  retPolicy = RetPolicy::Never;
+        else if (f == "--no-hle")     hostFunctions = false;
+        else if (f == "--profile")    profile = true;
+        else if (f == "--optimize")   optimize = true;
+        else if (f == "--fast-loops") fastLoops = true;
+        else if (f == "--fast-loops=verify") fastLoops = verifyLoops = true;
+        else if (f.rfind("--cfg=", 0) == 0) cfgPath = f.substr(6);
+        else if (f.rfind("--env=", 0) == 0) guestEnv.push_back(f.substr(6));
+        else if (f.rfind("--status-file=", 0) == 0) statusPath = f.substr(14);
+        else if (f.rfind("--max-steps=", 0) == 0) {
+            uint64_t n = 0;
+            if (!parseLimit(f.substr(12), n)) { std::cerr << "invalid limit: " << f << "\n"; return 1; }
+            limits.maxSteps = static_cast<std::size_t>(n);
+        }
+        else if (f.rfind("--timeout-ms=", 0) == 0) {
+            if (!parseLimit(f.substr(13), limits.timeoutMs)) { std::cerr << "invalid limit: " << f << "\n"; return 1; }
+        }
+        else if (f == "--lazy")       lazyCache = LazyProgram::kDefaultCacheSize;
+        else if (f.rfind("--lazy=", 0) == 0) {
+            try { lazyCache = std::stoul(f.substr(7)); } catch (...) { lazyCache = 0; }
+            if (lazyCache == 0) { std::cerr << "invalid cache size: " << f << "\n"; return 1; }
+        }
         else { std::cerr << "unknown flag: " << f << "\n"; return 1; }
     }
 
     try {
-        Parser parser;
+        if (isElfFile(path)) {
+            if (lazyCache || useCache) {
+                std::cerr << "--lazy and --cache apply to assembly listings only\n";
+                return 1;
+            }
+        } else if (lazyCache && (profile || optimize || fastLoops || !cfgPath.empty())) {
+            std::cerr << "--cfg, --profile, --optimize and --fast-loops need the whole program; drop --lazy\n";
+            return 1;
+        }
+        if (fastLoops && profile) {
+            std::cerr << "--profile counts every block run; drop --fast-loops\n";
+            return 1;
+        }
+
+        // Untraced runs execute whole superinstructions (and --optimize's
+        // rewrites, and --fast-loops' skips); traced runs go one at a time
+        MachineOptions opts;
+        opts.lazyCache = lazyCache;
+        opts.useCache = useCache;
+        opts.imagePath = imagePath;
+        opts.optimize = optimize;
+        opts.fastLoops = fastLoops;
+        opts.verifyLoops = verifyLoops;
+        opts.randomStack = randomStack;
+        opts.singleStep = !quiet;
+        Machine machine(opts);
+        machine.exec().retPolicy = retPolicy;
+        machine.exec().hostFunctions = hostFunctions;
         // Task 4: parse file into linear program with addresses/labels
-        AsmProgram prog = buildFileProgram(path, parser);
-        if (prog.code.empty()) {
+        // (--cache: reuse/refresh a compiled image next to the listing;
+        //  --lazy: index the listing and decode instructions as they run;
+        //  a static AArch64 ELF file is decoded from its executable segments)
+        machine.load(path, guestArgs, guestEnv);
+
+        if (machine.instructionCount() == 0) {
             std::cerr << "No instructions parsed from: " << path << "\n";
             return 0;
         }
+        const AsmProgram* prog = machine.program();
 
-        // Task 2/3: set up registers and 256-byte stack, SP = stack base
-        Registers regs;
-        Stack stack(/*base=*/0x0);
-        if (randomStack) stack.fillRandom();
-        regs.writeSP(stack.base() + stack.size());
-
-        // Start PC at 0x0 (advances by 4; branches handled in step)
-        uint64_t pc = 0;
-        regs.writePC(pc);
-
-        // Safety guard for accidental infinite loops
-        const std::size_t kMaxSteps = 100000;
-        std::size_t steps = 0;
-
-        while (true) {
-            if (++steps > kMaxSteps) {
-                std::cerr << "Aborting: exceeded max step count (" << kMaxSteps << ")\n";
-                break;
-            }
-            if (pc == prog.code.size() * 4ull) break; // fell off end
+        // --profile counts how often each basic block is entered
+        std::unique_ptr<ControlFlowGraph> cfg;
+        std::vector<uint64_t> blockCounts;
+        if (prog && (profile || !cfgPath.empty())) cfg = std::make_unique<ControlFlowGraph>(*prog, machine.pc());
+        if (profile) blockCounts.assign(cfg->blocks().size(), 0);
 
-            auto it = prog.addr2idx.find(pc);
-            if (it == prog.addr2idx.end()) {
-                std::cerr << "PC points to unknown address: " << hex64(pc) << "\n";
-                break;
+        // Superinstructions never span blocks, so every block start is fetched
+        if (profile || !quiet) machine.onFetch([&](const AsmInst& ai) {
+            if (profile) {
+                const std::size_t idx = static_cast<std::size_t>(&ai - prog->code.data());
+                if (cfg->isLeader(idx)) ++blockCounts[cfg->blockAt(idx)];
             }
-            const AsmInst& ai = prog.code[it->second];
-
             // Show PC and the formatted instruction
-            std::cout << "PC: " << hex64(pc) << "\n";
-            printDecoded(ai.instrIndex, ai.inst);
+            if (!quiet) {
+                std::cout << "PC: " << hex64(machine.pc()) << "\n";
+                printDecoded(ai.instrIndex, ai.inst);
+            }
+        });
 
-            // Execute one instruction, continue if more; returns false on RET or natural end
-            if (!step(prog, regs, stack, pc)) break;
+        const StopReason reason = machine.run(limits);
+        const uint64_t pc = machine.pc();
+        switch (reason) {
+        case StopReason::StepLimit:
+            std::cerr << "Aborting: exceeded max step count (" << limits.maxSteps << ")\n";
+            break;
+        case StopReason::Timeout:
+            std::cerr << "Aborting: exceeded time limit (" << limits.timeoutMs << " ms)\n";
+            break;
+        case StopReason::BadPc:
+            std::cerr << "PC points to unknown address: " << hex64(pc) << "\n";
+            break;
+        default:
+            break;
         }
+        const Registers& regs = machine.registers();
+        const Stack& stack = machine.stack();
+        const ExecState& exec = machine.exec();
+        const LoopAccelerator* loops = machine.loops();
+        const OptimizeStats& optStats = machine.optimizeStats();
 
         std::cout << "Program finished. Final PC = " << hex64(pc) << "\n\n";
         if (dumpRegs)  regs.print(std::cout);
+        if (dumpVRegs) regs.printVector(std::cout);
         if (dumpStack) stack.printDump(std::cout);
-        return 0;
+        if (profile)   printHotLoops(*cfg, *prog, blockCounts);
+        if (loops && verifyLoops) {
+            std::cout << std::dec << "Fast-forwarded loop iterations verified: " << loops->iterationsSkipped()
+                      << " (" << loops->summaries().size() << " counted loops)\n\n";
+        }
+        if (profile && optimize) {
+            std::cout << std::dec << "Optimized windows: " << optStats.windows << "  folded " << optStats.folded
+                      << "  forwarded " << optStats.forwarded << "  dead " << optStats.dead << "\n\n";
+        }
+        if (!cfgPath.empty()) {
+            const std::vector<uint64_t>* counts = profile ? &blockCounts : nullptr;
+            const bool dot = cfgPath.size() >= 4 && cfgPath.compare(cfgPath.size() - 4, 4, ".dot") == 0;
+            std::ofstream out(cfgPath);
+            out << (dot ? cfg->toDot(counts) : cfg->toJson(counts));
+            if (!out) throw std::runtime_error("cannot write " + cfgPath);
+        }
+        if (exec.exited) {
+            writeStatusFile(statusPath, std::string(stopReasonName(reason)) + " " + std::to_string(exec.exitCode));
+            return exec.exitCode;
+        }
+        writeStatusFile(statusPath, stopReasonName(reason));
+        return stopReasonStatus(reason);
 
     } catch (const std::exception& ex) {
         std::cerr << "error: " << ex.what() << "\n";
+        writeStatusFile(statusPath, stopReasonName(StopReason::Error));
         return 2;
     }
 }
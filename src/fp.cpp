@@ -0,0 +1,59 @@
+#include "fp.hpp"
+
+#include <cfenv>
+
+// The directed modes change the host FPU's rounding mode around an operation,
+// so the compiler must not fold or move FP arithmetic across fesetround().
+// GCC needs -frounding-math for this translation unit (set in CMakeLists.txt).
+#if defined(_MSC_VER) && !defined(__clang__)
+  #pragma fenv_access (on)
+#elif defined(__clang__)
+  #pragma STDC FENV_ACCESS ON
+#endif
+
+namespace arm64 {
+namespace fp {
+
+static int hostMode(Rounding r) {
+    switch (r) {
+    case Rounding::PlusInf:  return FE_UPWARD;
+    case Rounding::MinusInf: return FE_DOWNWARD;
+    case Rounding::Zero:     return FE_TOWARDZERO;
+    default:                 return FE_TONEAREST;
+    }
+}
+
+// Run f() with the host FPU rounding as r, then restore the caller's mode.
+template <class T, class F>
+static T withRounding(Rounding r, F f) {
+    const int saved = std::fegetround();
+    std::fesetround(hostMode(r));
+    volatile T v = f();
+    std::fesetround(saved);
+    return v;
+}
+
+float computeRounded(Op op, float a, float b, float c, Rounding r) {
+    return withRounding<float>(r, [&] { return compute(op, a, b, c); });
+}
+
+double computeRounded(Op op, double a, double b, double c, Rounding r) {
+    return withRounding<double>(r, [&] { return compute(op, a, b, c); });
+}
+
+float narrowRounded(double v, Rounding r) {
+    return withRounding<float>(r, [&] { return static_cast<float>(v); });
+}
+
+template <class T>
+T fromIntRounded(uint64_t v, bool isSigned, Rounding r) {
+    return withRounding<T>(r, [&] {
+        return isSigned ? static_cast<T>(static_cast<int64_t>(v)) : static_cast<T>(v);
+    });
+}
+
+template float  fromIntRounded<float>(uint64_t, bool, Rounding);
+template double fromIntRounded<double>(uint64_t, bool, Rounding);
+
+} // namespace fp
+} // namespace arm64
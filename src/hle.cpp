@@ -0,0 +1,139 @@
+#include "hle.hpp"
+#include "memory.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace arm64 {
+
+struct HostSymbol {
+    const char* name; // uppercase, as LabelMap keys are
+    HostFn fn;
+};
+
+static constexpr HostSymbol kHostSymbols[] = {
+    {"MEMCPY", HostFn::Memcpy}, {"MEMMOVE", HostFn::Memmove}, {"MEMSET", HostFn::Memset},
+    {"MEMCMP", HostFn::Memcmp}, {"STRLEN", HostFn::Strlen},
+};
+
+std::vector<std::pair<uint64_t, HostFn>> findHostFunctions(const LabelMap& labels) {
+    std::vector<std::pair<uint64_t, HostFn>> out;
+    for (const HostSymbol& s : kHostSymbols) {
+        auto it = labels.find(s.name);
+        if (it != labels.end()) out.emplace_back(it->second, s.fn);
+    }
+    return out;
+}
+
+void bindHostFunctions(AsmProgram& prog) {
+    for (const auto& [addr, fn] : findHostFunctions(prog.labels)) {
+        auto it = prog.addr2idx.find(addr);
+        if (it != prog.addr2idx.end()) prog.code[it->second].pre.host = static_cast<uint8_t>(fn);
+    }
+}
+
+// Host pointer to guest addr and how many of the next max bytes (len > 0)
+// are contiguous behind it: the rest of the stack, a whole heap range, or
+// else up to the next page boundary. nullptr if addr is not mapped.
+static uint8_t* guestRun(Stack& stack, Memory* mem, uint64_t addr, uint64_t max, uint64_t& len) {
+    if (addr >= stack.base() && addr - stack.base() < stack.size()) {
+        const uint64_t off = addr - stack.base();
+        len = std::min<uint64_t>(max, stack.size() - off);
+        return stack.data() + off;
+    }
+    if (!mem) return nullptr;
+    if (uint8_t* p = mem->translate(addr, max)) { len = max; return p; }
+    len = std::min<uint64_t>(max, Memory::kPageSize - (addr & (Memory::kPageSize - 1)));
+    return mem->translate(addr, len);
+}
+
+// Copies that fail part way have only written what the guest routine will
+// write again, so declining then is safe; overlapping ranges are copied in
+// one piece or not at all.
+static bool copy(Stack& stack, Memory* mem, uint64_t dst, uint64_t src, uint64_t n) {
+    if (n == 0) return true;
+    uint64_t dl = 0, sl = 0;
+    uint8_t* d = guestRun(stack, mem, dst, n, dl);
+    uint8_t* s = guestRun(stack, mem, src, n, sl);
+    if (!d || !s) return false;
+    if (dl == n && sl == n) { std::memmove(d, s, static_cast<std::size_t>(n)); return true; }
+    if (dst - src < n || src - dst < n) return false;
+
+    while (n) {
+        if (!(d = guestRun(stack, mem, dst, n, dl)) || !(s = guestRun(stack, mem, src, dl, sl))) return false;
+        std::memcpy(d, s, static_cast<std::size_t>(sl));
+        dst += sl; src += sl; n -= sl;
+    }
+    return true;
+}
+
+static bool fill(Stack& stack, Memory* mem, uint64_t dst, uint8_t c, uint64_t n) {
+    while (n) {
+        uint64_t len = 0;
+        uint8_t* d = guestRun(stack, mem, dst, n, len);
+        if (!d) return false;
+        std::memset(d, c, static_cast<std::size_t>(len));
+        dst += len; n -= len;
+    }
+    return true;
+}
+
+static bool compare(Stack& stack, Memory* mem, uint64_t a, uint64_t b, uint64_t n, int& out) {
+    out = 0;
+    while (n) {
+        uint64_t al = 0, bl = 0;
+        const uint8_t* p = guestRun(stack, mem, a, n, al);
+        const uint8_t* q = p ? guestRun(stack, mem, b, al, bl) : nullptr;
+        if (!q) return false;
+        for (uint64_t i = 0; i < bl; ++i)
+            if (p[i] != q[i]) { out = p[i] < q[i] ? -1 : 1; return true; }
+        a += bl; b += bl; n -= bl;
+    }
+    return true;
+}
+
+static bool length(Stack& stack, Memory* mem, uint64_t s, uint64_t& out) {
+    out = 0;
+    while (true) {
+        uint64_t len = 0;
+        const uint8_t* p = guestRun(stack, mem, s + out, ~0ull - (s + out), len);
+        if (!p || len == 0) return false;
+        if (const void* nul = std::memchr(p, 0, static_cast<std::size_t>(len))) {
+            out += static_cast<uint64_t>(static_cast<const uint8_t*>(nul) - p);
+            return true;
+        }
+        out += len;
+    }
+}
+
+bool callHostFunction(HostFn fn, Registers& regs, Stack& stack, ExecState& st) {
+    const uint64_t a0 = regs.get(0), a1 = regs.get(1), a2 = regs.get(2);
+    switch (fn) {
+    // memcpy may assume the ranges do not overlap; copying as memmove is one valid outcome
+    case HostFn::Memcpy:
+    case HostFn::Memmove:
+        return copy(stack, st.memory, a0, a1, a2); // returns dst, already in X0
+
+    case HostFn::Memset:
+        return fill(stack, st.memory, a0, static_cast<uint8_t>(a1), a2);
+
+    case HostFn::Memcmp: {
+        int r = 0;
+        if (!compare(stack, st.memory, a0, a1, a2, r)) return false;
+        regs.set(0, static_cast<uint32_t>(r)); // int result, as a Wn write
+        return true;
+    }
+
+    case HostFn::Strlen: {
+        uint64_t n = 0;
+        if (!length(stack, st.memory, a0, n)) return false;
+        regs.set(0, n);
+        return true;
+    }
+
+    default:
+        return false;
+    }
+}
+
+} // namespace arm64
@@ -0,0 +1,321 @@
+#include "image.hpp"
+#include "mapped_file.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_WIN32)
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace arm64 {
+
+static_assert(std::is_trivially_copyable<Predecoded>::value,
+              "Predecoded is stored verbatim in program images");
+
+/* On-disk records. All sizes are multiples of 8 so every record stays aligned. */
+
+namespace {
+
+constexpr char kMagic[8] = {'A', '6', '4', 'I', 'M', 'G', '\0', '\0'};
+
+struct ImageHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t predecodedSize;
+    uint64_t sourceHash;
+    uint64_t instCount;
+    uint64_t operandCount;
+    uint64_t labelCount;
+    uint64_t stringBytes;
+};
+
+struct ImageOperand {
+    int64_t  imm;
+    uint64_t rawOff;
+    uint32_t rawLen;
+    uint8_t  type;
+    uint8_t  pad[3];
+};
+
+// Operands live in their own array; each instruction owns nops records
+// starting at firstOperand.
+struct ImageInst {
+    uint64_t   addr;
+    uint64_t   instrIndex;
+    uint64_t   srcLine;
+    uint64_t   mnemOff;
+    uint64_t   firstOperand;
+    uint32_t   mnemLen;
+    uint8_t    op;
+    uint8_t    cond;
+    uint8_t    nops;
+    uint8_t    pad;
+    Predecoded pre;
+};
+
+struct ImageLabel {
+    uint64_t nameOff;
+    uint64_t nameLen;
+    uint64_t addr;
+};
+
+// Deduplicating pool for mnemonics, operand text and label names.
+class StringPool {
+public:
+    uint64_t add(const std::string& s) {
+        auto it = offsets_.find(s);
+        if (it != offsets_.end()) return it->second;
+        const uint64_t off = bytes_.size();
+        bytes_.append(s);
+        offsets_.emplace(s, off);
+        return off;
+    }
+    const std::string& bytes() const { return bytes_; }
+
+private:
+    std::string bytes_;
+    std::unordered_map<std::string, uint64_t> offsets_;
+};
+
+template <class T>
+void writeRecord(std::string& out, const T& rec) {
+    out.append(reinterpret_cast<const char*>(&rec), sizeof(T));
+}
+
+template <class T>
+T readRecord(const char* p) {
+    T rec;
+    std::memcpy(&rec, p, sizeof(T));
+    return rec;
+}
+
+uint32_t checkedLen(std::size_t n) {
+    if (n > 0xFFFF'FFFFu) throw std::runtime_error("program image: string too long");
+    return static_cast<uint32_t>(n);
+}
+
+} // namespace
+
+uint64_t hashContents(std::string_view bytes) {
+    // 8 bytes per step with a multiply-rotate mix, then a final avalanche.
+    const uint64_t k1 = 0x9e3779b97f4a7c15ull;
+    const uint64_t k2 = 0xc2b2ae3d27d4eb4full;
+    uint64_t h = k1 ^ (static_cast<uint64_t>(bytes.size()) * k2);
+
+    std::size_t i = 0;
+    for (; i + 8 <= bytes.size(); i += 8) {
+        uint64_t w;
+        std::memcpy(&w, bytes.data() + i, 8);
+        w *= k2;
+        w = (w << 31) | (w >> 33);
+        h ^= w * k1;
+        h = ((h << 27) | (h >> 37)) * 5 + 0x52dce729;
+    }
+    uint64_t tail = 0;
+    for (std::size_t j = 0; i + j < bytes.size(); ++j)
+        tail |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[i + j])) << (8 * j);
+    h ^= tail * k2;
+
+    h ^= h >> 33; h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33; h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+std::string defaultImagePath(const std::string& sourcePath) {
+    return sourcePath + ".a64img";
+}
+
+// Write bytes to a temporary file of its own next to path, flush it to disk
+// and rename it over path. Concurrent writers never share a temporary file,
+// and readers see either the old image or a complete new one.
+static void installFile(const std::string& path, const std::string& bytes) {
+#if defined(_WIN32)
+    static std::atomic<unsigned> serial{0};
+    const std::string tmp = path + "." + std::to_string(GetCurrentProcessId()) + "." +
+                            std::to_string(serial.fetch_add(1)) + ".tmp";
+    HANDLE f = CreateFileA(tmp.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE) throw std::runtime_error("could not write program image: " + tmp);
+    DWORD written = 0;
+    const bool ok = bytes.size() <= MAXDWORD &&
+                    WriteFile(f, bytes.data(), static_cast<DWORD>(bytes.size()), &written, nullptr) &&
+                    written == bytes.size() && FlushFileBuffers(f);
+    CloseHandle(f);
+    if (!ok || !MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        DeleteFileA(tmp.c_str());
+        throw std::runtime_error("could not install program image: " + path);
+    }
+#else
+    std::string tmp = path + ".XXXXXX";
+    const int fd = mkstemp(tmp.data());
+    if (fd < 0) throw std::runtime_error("could not write program image: " + tmp);
+    bool ok = true;
+    for (std::size_t off = 0; ok && off < bytes.size();) {
+        const ssize_t n = ::write(fd, bytes.data() + off, bytes.size() - off);
+        if (n < 0 && errno == EINTR) continue;
+        ok = n > 0;
+        if (ok) off += static_cast<std::size_t>(n);
+    }
+    ok = ok && fchmod(fd, 0644) == 0 && fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    if (!ok) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("could not write program image: " + tmp);
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("could not install program image: " + path);
+    }
+#endif
+}
+
+void writeProgramImage(const AsmProgram& prog, const std::string& imagePath, uint64_t sourceHash) {
+    StringPool pool;
+    std::vector<ImageInst> insts;
+    std::vector<ImageOperand> operands;
+    insts.reserve(prog.code.size());
+
+    for (const AsmInst& ai : prog.code) {
+        ImageInst r{};
+        r.addr       = ai.addr;
+        r.instrIndex = ai.instrIndex;
+        r.srcLine    = ai.srcLine;
+        r.mnemOff    = pool.add(ai.inst.mnem);
+        r.mnemLen    = checkedLen(ai.inst.mnem.size());
+        r.op         = static_cast<uint8_t>(ai.inst.op);
+        r.cond       = static_cast<uint8_t>(ai.inst.cond);
+        r.nops       = static_cast<uint8_t>(ai.inst.operands.size());
+        r.pre        = ai.pre;
+        r.firstOperand = operands.size();
+        for (const Operand& o : ai.inst.operands) {
+            ImageOperand ro{};
+            ro.imm    = o.imm;
+            ro.rawOff = pool.add(std::string(o.raw()));
+            ro.rawLen = checkedLen(o.raw().size());
+            ro.type   = static_cast<uint8_t>(o.type);
+            operands.push_back(ro);
+        }
+        insts.push_back(r);
+    }
+
+    std::vector<ImageLabel> labels;
+    labels.reserve(prog.labels.size());
+    for (const auto& [name, addr] : prog.labels) {
+        labels.push_back(ImageLabel{pool.add(name), name.size(), addr});
+    }
+
+    ImageHeader h{};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version        = kImageVersion;
+    h.predecodedSize = static_cast<uint32_t>(sizeof(Predecoded));
+    h.sourceHash     = sourceHash;
+    h.instCount      = insts.size();
+    h.operandCount   = operands.size();
+    h.labelCount     = labels.size();
+    h.stringBytes    = pool.bytes().size();
+
+    std::string bytes;
+    writeRecord(bytes, h);
+    for (const ImageInst& r : insts)      writeRecord(bytes, r);
+    for (const ImageOperand& o : operands) writeRecord(bytes, o);
+    for (const ImageLabel& l : labels)    writeRecord(bytes, l);
+    bytes += pool.bytes();
+    installFile(imagePath, bytes);
+}
+
+std::optional<AsmProgram> loadProgramImage(const std::string& imagePath, uint64_t sourceHash) {
+    if (!MappedFile::exists(imagePath)) return std::nullopt;
+    const MappedFile file(imagePath);
+    const char* base = file.data();
+    const std::size_t size = file.size();
+
+    if (size < sizeof(ImageHeader)) return std::nullopt;
+    const ImageHeader h = readRecord<ImageHeader>(base);
+    if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0) return std::nullopt;
+    if (h.version != kImageVersion || h.predecodedSize != sizeof(Predecoded)) return std::nullopt;
+    if (h.sourceHash != sourceHash) return std::nullopt;
+
+    if (h.instCount > size / sizeof(ImageInst) || h.operandCount > size / sizeof(ImageOperand) ||
+        h.labelCount > size / sizeof(ImageLabel) || h.stringBytes > size) return std::nullopt;
+    const uint64_t need = sizeof(ImageHeader) + h.instCount * sizeof(ImageInst)
+                        + h.operandCount * sizeof(ImageOperand)
+                        + h.labelCount * sizeof(ImageLabel) + h.stringBytes;
+    if (need != size) return std::nullopt;
+
+    const char* instBase  = base + sizeof(ImageHeader);
+    const char* opBase    = instBase + h.instCount * sizeof(ImageInst);
+    const char* labelBase = opBase + h.operandCount * sizeof(ImageOperand);
+    const std::string_view strings(labelBase + h.labelCount * sizeof(ImageLabel),
+                                   static_cast<std::size_t>(h.stringBytes));
+
+    auto str = [&](uint64_t off, uint64_t len) -> std::string {
+        if (off > strings.size() || len > strings.size() - off)
+            throw std::runtime_error("corrupt program image: " + imagePath);
+        return std::string(strings.substr(static_cast<std::size_t>(off), static_cast<std::size_t>(len)));
+    };
+
+    AsmProgram prog;
+    prog.code.reserve(static_cast<std::size_t>(h.instCount));
+    for (uint64_t i = 0; i < h.instCount; ++i) {
+        const ImageInst r = readRecord<ImageInst>(instBase + i * sizeof(ImageInst));
+        if (r.firstOperand > h.operandCount ||
+            r.nops > h.operandCount - r.firstOperand) return std::nullopt;
+
+        AsmInst ai;
+        ai.addr       = r.addr;
+        ai.instrIndex = static_cast<std::size_t>(r.instrIndex);
+        ai.srcLine    = static_cast<std::size_t>(r.srcLine);
+        ai.inst.mnem  = str(r.mnemOff, r.mnemLen);
+        ai.inst.op    = static_cast<Opcode>(r.op);
+        ai.inst.cond  = static_cast<Cond>(r.cond);
+        ai.pre        = r.pre;
+        for (uint64_t k = 0; k < r.nops; ++k) {
+            const ImageOperand o = readRecord<ImageOperand>(opBase + (r.firstOperand + k) * sizeof(ImageOperand));
+            ai.inst.operands.push_back(Operand{static_cast<OperandType>(o.type),
+                                               str(o.rawOff, o.rawLen), o.imm});
+        }
+
+        prog.addr2idx[ai.addr] = prog.code.size();
+        prog.code.push_back(std::move(ai));
+    }
+    for (uint64_t i = 0; i < h.labelCount; ++i) {
+        const ImageLabel l = readRecord<ImageLabel>(labelBase + i * sizeof(ImageLabel));
+        prog.labels[str(l.nameOff, l.nameLen)] = l.addr;
+    }
+    return prog;
+}
+
+AsmProgram buildCachedProgram(const std::string& path, const Parser& parser,
+                              const std::string& imagePath) {
+    const std::string img = imagePath.empty() ? defaultImagePath(path) : imagePath;
+
+    const MappedFile source(path);
+    const uint64_t hash = hashContents(source.view());
+
+    if (auto cached = loadProgramImage(img, hash)) return std::move(*cached);
+
+    AsmProgram prog = buildProgramFromText(source.view(), parser);
+    try {
+        writeProgramImage(prog, img, hash);
+    } catch (const std::exception& ex) {
+        // A read-only directory only costs us the cache, not the run.
+        std::cerr << "warning: " << ex.what() << "\n";
+    }
+    return prog;
+}
+
+} // namespace arm64
@@ -0,0 +1,105 @@
+#include "lazy_program.hpp"
+#include "scan.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace arm64 {
+
+LazyProgram::LazyProgram(const std::string& path, const Parser& parser, std::size_t cacheSize)
+    : file_(path), parser_(parser) {
+    if (cacheSize == 0) cacheSize = 1;
+
+    const std::string_view text = file_.view();
+    uint32_t srcLine = 0;
+
+    // Index pass: same line rules as buildProgramFromText, but only locate the
+    // instruction text instead of decoding it.
+    scan::forEachLine(text, [&](std::string_view line) {
+        ++srcLine;
+        const uint64_t next_addr = static_cast<uint64_t>(lines_.size()) * 4ull;
+
+        std::string_view s = collectLeadingLabels(line, next_addr, labels_);
+        if (s.empty()) return;
+        if (s.substr(0, 2) == "//" || s[0] == ';') return;
+        if (parser_.instructionText(s).empty()) return;
+
+        if (s.size() > 0xFFFF'FFFFu) throw std::runtime_error("line too long: " + std::to_string(srcLine));
+        lines_.push_back(LineRef{static_cast<uint64_t>(s.data() - text.data()),
+                                 static_cast<uint32_t>(s.size()), srcLine});
+    });
+
+    hostFns_ = findHostFunctions(labels_);
+
+    slots_.resize(std::min(cacheSize, std::max<std::size_t>(lines_.size(), 1)));
+    resident_.reserve(slots_.size());
+}
+
+// CLOCK sweep: give referenced slots a second chance, evict the first cold one.
+std::size_t LazyProgram::takeSlot() {
+    while (true) {
+        Slot& s = slots_[hand_];
+        const std::size_t i = hand_;
+        hand_ = (hand_ + 1) % slots_.size();
+
+        if (!s.used) return i;
+        if (s.referenced) { s.referenced = false; continue; }
+
+        resident_.erase(s.idx);
+        s.used = false;
+        ++stats_.evictions;
+        return i;
+    }
+}
+
+const AsmInst& LazyProgram::fetch(uint64_t pc) {
+    if (pc % 4 != 0 || pc / 4 >= lines_.size()) {
+        throw std::runtime_error("PC points to unknown address: " + std::to_string(pc));
+    }
+    const uint32_t idx = static_cast<uint32_t>(pc / 4);
+
+    auto it = resident_.find(idx);
+    if (it != resident_.end()) {
+        ++stats_.hits;
+        Slot& s = slots_[it->second];
+        s.referenced = true;
+        return s.inst;
+    }
+    ++stats_.misses;
+
+    const LineRef& ref = lines_[idx];
+    auto decoded = parser_.parseLine(file_.view().substr(static_cast<std::size_t>(ref.offset), ref.length));
+    if (!decoded) throw std::runtime_error("listing changed while mapped, line " + std::to_string(ref.srcLine));
+
+    const std::size_t si = takeSlot();
+    Slot& s = slots_[si];
+    s.inst = AsmInst{};
+    s.inst.addr = pc;
+    s.inst.instrIndex = static_cast<std::size_t>(idx) + 1;
+    s.inst.srcLine = ref.srcLine;
+    s.inst.inst = std::move(*decoded);
+    predecode(s.inst, labels_, lines_.size());
+    for (const auto& [addr, fn] : hostFns_)
+        if (addr == pc) s.inst.pre.host = static_cast<uint8_t>(fn);
+    s.idx = idx;
+    s.used = true;
+    s.referenced = true;
+
+    resident_[idx] = static_cast<uint32_t>(si);
+    return s.inst;
+}
+
+bool step(LazyProgram& prog, Registers& regs, Stack& stack, uint64_t& pc, ExecState& st) {
+    if (prog.size() == 0) return false;
+    const uint64_t endAddr = prog.endAddr();
+    if (pc == endAddr) return false;
+    return executeInst(prog.fetch(pc), endAddr, regs, stack, pc, st);
+}
+
+bool step(LazyProgram& prog, Registers& regs, Stack& stack, uint64_t& pc) {
+    ExecState st;
+    st.retPolicy = RetPolicy::HaltAlways;
+    return step(prog, regs, stack, pc, st);
+}
+
+} // namespace arm64
@@ -0,0 +1,546 @@
+#include "loops.hpp"
+#include "cfg.hpp"
+#include "memory.hpp"
+
+#include <algorithm>
+#include <array>
+#include <sstream>
+#include <stdexcept>
+
+namespace arm64 {
+
+static constexpr uint32_t kNone = BasicBlock::kNone;
+static constexpr std::size_t kMaxPath = 256; // longest iteration considered
+
+static inline uint64_t widthMask(unsigned width) { return width == 32 ? 0xFFFF'FFFFull : ~0ull; }
+
+// Linear forms
+static LoopForm constant(uint64_t c) {
+    LoopForm f;
+    f.c = c;
+    return f;
+}
+
+static LoopForm identity(uint32_t loc) {
+    LoopForm f;
+    f.terms.emplace_back(loc, 1);
+    return f;
+}
+
+static bool isConstant(const LoopForm& f) { return f.terms.empty(); }
+
+static bool sameForm(const LoopForm& a, const LoopForm& b) {
+    return a.c == b.c && a.terms == b.terms && a.w32 == b.w32;
+}
+
+// a + k * b
+static LoopForm combine(const LoopForm& a, const LoopForm& b, uint64_t k) {
+    LoopForm r;
+    r.c = a.c + k * b.c;
+    r.w32 = a.w32 || b.w32;
+    std::size_t i = 0, j = 0;
+    while (i < a.terms.size() || j < b.terms.size()) {
+        uint32_t loc;
+        uint64_t coef;
+        if (j == b.terms.size() || (i < a.terms.size() && a.terms[i].first < b.terms[j].first)) {
+            loc = a.terms[i].first; coef = a.terms[i++].second;
+        } else if (i == a.terms.size() || b.terms[j].first < a.terms[i].first) {
+            loc = b.terms[j].first; coef = k * b.terms[j++].second;
+        } else {
+            loc = a.terms[i].first; coef = a.terms[i++].second + k * b.terms[j++].second;
+        }
+        if (coef) r.terms.emplace_back(loc, coef);
+    }
+    if (r.terms.empty()) r.w32 = false;
+    return r;
+}
+
+static LoopForm scaled(const LoopForm& f, uint64_t k) { return combine(constant(0), f, k); }
+
+// The value seen through a Wn view or written by a W instruction.
+static LoopForm narrowed(LoopForm f) {
+    if (isConstant(f)) f.c &= widthMask(32);
+    else               f.w32 = true;
+    return f;
+}
+
+static uint64_t evaluate(const LoopForm& f, const std::vector<uint64_t>& x) {
+    uint64_t v = f.c;
+    for (const auto& [loc, coef] : f.terms) v += coef * x[loc];
+    return f.w32 ? v & widthMask(32) : v;
+}
+
+// Symbolic execution of one iteration, in terms of the values every
+// location holds when it starts.
+class Tracer {
+public:
+    explicit Tracer(LoopSummary& s) : s_(s) { regLoc_.fill(kNone); }
+
+    bool run(const AsmProgram& prog, const std::vector<uint32_t>& path);
+
+private:
+    uint32_t reg(uint8_t slot) {
+        if (regLoc_[slot] == kNone) {
+            LoopLocation l;
+            l.reg = slot;
+            regLoc_[slot] = add(l);
+        }
+        return regLoc_[slot];
+    }
+
+    // Stack slot at base + offset; one base per loop, and slots either
+    // coincide or do not overlap.
+    uint32_t slot(const Predecoded& p, unsigned size) {
+        for (uint32_t i = 0; i < s_.locations.size(); ++i) {
+            const LoopLocation& l = s_.locations[i];
+            if (!l.memory) continue;
+            if (l.reg != p.memBase) return kNone;
+            if (l.offset == p.memOffset && l.size == size) return i;
+            if (l.offset < p.memOffset + static_cast<int64_t>(size) && p.memOffset < l.offset + l.size)
+                return kNone;
+        }
+        LoopLocation l;
+        l.memory = true;
+        l.reg = p.memBase;
+        l.size = static_cast<uint8_t>(size);
+        l.offset = p.memOffset;
+        return add(l);
+    }
+
+    uint32_t add(const LoopLocation& l) {
+        s_.locations.push_back(l);
+        cur_.push_back(identity(static_cast<uint32_t>(cur_.size())));
+        touched_.push_back(false);
+        readX_.push_back(false);
+        return static_cast<uint32_t>(s_.locations.size() - 1);
+    }
+
+    LoopForm get(uint32_t loc, bool w) {
+        if (!w && !touched_[loc]) readX_[loc] = true;
+        return w ? narrowed(cur_[loc]) : cur_[loc];
+    }
+    LoopForm read(uint8_t slot, uint8_t w) {
+        return slot == Registers::XZR_INDEX ? constant(0) : get(reg(slot), w);
+    }
+    void write(uint32_t loc, LoopForm f) {
+        cur_[loc] = std::move(f);
+        touched_[loc] = true;
+    }
+    void setDest(const Predecoded& p, LoopForm f) {
+        if (p.rd != Registers::XZR_INDEX) write(reg(p.rd), p.rdW ? narrowed(std::move(f)) : std::move(f));
+    }
+
+    // Second source: Rm, LSL #n only, plus the immediate.
+    bool op2(const Predecoded& p, LoopForm& out) {
+        out = read(p.rm, p.rmW);
+        if (p.shift == ShiftOp::Lsl)       out = scaled(out, 1ull << p.shiftAmt);
+        else if (p.shift != ShiftOp::None) return false;
+        out.c += static_cast<uint64_t>(p.imm);
+        return true;
+    }
+
+    // X-width arithmetic on a value that is only known modulo 2^32 is not linear.
+    static bool linear(const Predecoded& p, const LoopForm& a, const LoopForm& b) {
+        return p.rdW || (!a.w32 && !b.w32);
+    }
+
+    bool product(const Predecoded& p, const LoopForm& a, const LoopForm& b, LoopForm& out) {
+        if (!linear(p, a, b)) return false;
+        if (isConstant(a))      out = scaled(b, a.c);
+        else if (isConstant(b)) out = scaled(a, b.c);
+        else                    return false;
+        return true;
+    }
+
+    LoopSummary& s_;
+    std::array<uint32_t, Registers::kSlots> regLoc_;
+    std::vector<LoopForm> cur_;
+    std::vector<bool> touched_; // written earlier in this iteration
+    std::vector<bool> readX_;   // start value read as a whole 64-bit register or slot
+};
+
+bool Tracer::run(const AsmProgram& prog, const std::vector<uint32_t>& path) {
+    int flagWrites = 0;
+    bool tested = false;
+    for (uint32_t idx : path) {
+        const AsmInst& ai = prog.code[idx];
+        const Predecoded& p = ai.pre;
+        LoopForm a, b, r;
+        switch (ai.inst.op) {
+        case Opcode::Nop: case Opcode::B:
+            break;
+
+        case Opcode::Mov:
+            if (!op2(p, r)) return false;
+            setDest(p, r); // a plain copy keeps a 32-bit value 32-bit
+            break;
+
+        case Opcode::Add: case Opcode::Sub:
+            a = read(p.rn, p.rnW);
+            if (!op2(p, b) || !linear(p, a, b)) return false;
+            setDest(p, combine(a, b, ai.inst.op == Opcode::Add ? 1 : ~0ull));
+            break;
+
+        case Opcode::Movz: case Opcode::Movn:
+            setDest(p, constant(static_cast<uint64_t>(p.imm)));
+            break;
+
+        case Opcode::Movk:
+            a = read(p.rd, p.rdW);
+            if (!isConstant(a)) return false;
+            setDest(p, constant((a.c & ~p.bfWmask) | static_cast<uint64_t>(p.imm)));
+            break;
+
+        case Opcode::Lsl:
+            b = read(p.rm, p.rmW);
+            if (!isConstant(b)) return false;
+            a = read(p.rn, p.rnW);
+            if (!linear(p, a, a)) return false;
+            setDest(p, scaled(a, 1ull << ((b.c + static_cast<uint64_t>(p.imm)) & ((64u >> p.rdW) - 1))));
+            break;
+
+        case Opcode::Mul: case Opcode::Madd: case Opcode::Msub: case Opcode::Mneg: {
+            if (!product(p, read(p.rn, p.rnW), read(p.rm, p.rmW), r)) return false;
+            if (ai.inst.op == Opcode::Mul) { setDest(p, r); break; }
+            a = read(p.ra, p.rdW);
+            if (!linear(p, a, r)) return false;
+            setDest(p, combine(a, r, ai.inst.op == Opcode::Madd ? 1 : ~0ull));
+            break;
+        }
+
+        case Opcode::Ldr: case Opcode::Str: {
+            if (p.memWb || p.memIndex != Registers::XZR_INDEX) return false;
+            const unsigned size = p.rdW ? 4u : 8u;
+            const uint32_t loc = slot(p, size);
+            if (loc == kNone) return false;
+            if (ai.inst.op == Opcode::Ldr) setDest(p, get(loc, p.rdW));
+            else                           write(loc, read(p.rd, p.rdW));
+            break;
+        }
+
+        case Opcode::Cmp: case Opcode::Subs:
+            a = read(p.rn, p.rnW);
+            if (!op2(p, b)) return false;
+            if (ai.inst.op == Opcode::Subs) {
+                if (!linear(p, a, b)) return false;
+                setDest(p, combine(a, b, ~0ull));
+            }
+            s_.lhs = a;
+            s_.rhs = b;
+            s_.width = (ai.inst.op == Opcode::Cmp ? p.rnW : p.rdW) ? 32u : 64u;
+            if (s_.width == 64 && (a.w32 || b.w32)) return false;
+            ++flagWrites;
+            break;
+
+        case Opcode::BCond: {
+            const unsigned c = static_cast<unsigned>(ai.inst.cond) >> 1;
+            // EQ/NE, CS/CC, HI/LS, GE/LT, GT/LE: the ones a compare orders
+            if (tested || flagWrites != 1 || !(c == 0 || c == 1 || c == 4 || c == 5 || c == 6)) return false;
+            s_.cond = static_cast<uint8_t>(ai.inst.cond);
+            s_.setsFlags = true;
+            tested = true;
+            break;
+        }
+
+        case Opcode::Cbz: case Opcode::Cbnz:
+            if (tested) return false;
+            s_.lhs = read(p.rn, p.rnW);
+            s_.rhs = constant(0);
+            s_.width = p.rnW ? 32u : 64u;
+            s_.cond = static_cast<uint8_t>(ai.inst.op == Opcode::Cbz ? Cond::EQ : Cond::NE);
+            tested = true;
+            break;
+
+        default:
+            return false;
+        }
+    }
+    // The only flag write is the exit test's, so NZCV at any iteration
+    // boundary is that compare's.
+    if (!tested || flagWrites != (s_.setsFlags ? 1 : 0)) return false;
+
+    const std::size_t n = s_.locations.size();
+    s_.next = cur_;
+    s_.written.assign(n, false);
+    for (std::size_t i = 0; i < n; ++i) {
+        s_.written[i] = !sameForm(cur_[i], identity(static_cast<uint32_t>(i)));
+        // Iteration 0 starts from a full 64-bit value, later ones from a 32-bit one
+        if (s_.written[i] && readX_[i] && cur_[i].w32) return false;
+    }
+    for (const LoopLocation& l : s_.locations)
+        if (l.memory && regLoc_[l.reg] != kNone && s_.written[regLoc_[l.reg]]) return false;
+
+    // The test moves by a fixed step per iteration on at most one side.
+    auto steps = [&](const LoopForm& f) {
+        bool moves = false;
+        for (const auto& [loc, coef] : f.terms) {
+            if (!s_.written[loc]) continue;
+            const LoopForm& nx = s_.next[loc];
+            if (nx.terms.size() != 1 || nx.terms[0].first != loc || nx.terms[0].second != 1) return -1;
+            moves = true;
+        }
+        return moves ? 1 : 0;
+    };
+    const int ls = steps(s_.lhs), rs = steps(s_.rhs);
+    return ls >= 0 && rs >= 0 && ls + rs < 2;
+}
+
+// Per-iteration change of a test operand (see Tracer::run()).
+static uint64_t slope(const LoopSummary& s, const LoopForm& f) {
+    uint64_t d = 0;
+    for (const auto& [loc, coef] : f.terms)
+        if (s.written[loc]) d += coef * s.next[loc].c;
+    return d;
+}
+
+LoopAccelerator::LoopAccelerator(const AsmProgram& prog, uint64_t entry, bool verify)
+    : prog_(prog), verify_(verify), summaryAt_(prog.code.size(), kNone) {
+    const ControlFlowGraph cfg(prog, entry);
+    const std::size_t n = prog.code.size();
+
+    for (const Loop& loop : cfg.loops()) {
+        auto inLoop = [&](std::size_t i) {
+            return i < n && std::binary_search(loop.blocks.begin(), loop.blocks.end(), cfg.blockAt(i));
+        };
+
+        // The one path from the header around to itself
+        LoopSummary s;
+        s.header = cfg.blocks()[loop.header].first;
+        std::vector<uint32_t> path;
+        bool exits = false, ok = true;
+        uint32_t i = s.header;
+        do {
+            const AsmInst& ai = prog.code[i];
+            if (path.size() == kMaxPath || !ai.pre.ok || ai.pre.host) { ok = false; break; }
+            path.push_back(i);
+            uint32_t next = i + 1;
+            switch (ai.inst.op) {
+            case Opcode::B:
+                next = ai.pre.targetIdx;
+                break;
+            case Opcode::BCond: case Opcode::Cbz: case Opcode::Cbnz: {
+                const bool takenIn = ai.pre.targetIdx != Predecoded::kNoTarget && inLoop(ai.pre.targetIdx);
+                if (exits || takenIn == inLoop(i + 1)) { ok = false; break; }
+                exits = true;
+                s.exitTaken = !takenIn;
+                next = takenIn ? ai.pre.targetIdx : i + 1;
+                break;
+            }
+            default:
+                break;
+            }
+            if (!ok || !inLoop(next)) { ok = false; break; }
+            i = next;
+        } while (i != s.header);
+        if (!ok || !exits) continue;
+
+        s.length = static_cast<uint32_t>(path.size());
+        s.fallsIn = path.back() + 1 == s.header;
+        if (!Tracer(s).run(prog, path)) continue;
+        summaryAt_[s.header] = static_cast<uint32_t>(summaries_.size());
+        summaries_.push_back(std::move(s));
+    }
+}
+
+// Host bytes of a whole stack slot, or nullptr.
+static uint8_t* slotBytes(Stack& stack, Memory* mem, uint64_t addr, unsigned size) {
+    if (addr >= stack.base() && addr - stack.base() <= stack.size() - size)
+        return stack.data() + (addr - stack.base());
+    return mem ? mem->translate(addr, size) : nullptr;
+}
+
+// Inverse of an odd number modulo 2^64 (Newton's iteration).
+static uint64_t inverse(uint64_t a) {
+    uint64_t x = a; // correct to 3 bits
+    for (int i = 0; i < 5; ++i) x *= 2 - a * x;
+    return x;
+}
+
+using Matrix = std::vector<std::vector<uint64_t>>;
+
+static Matrix multiply(const Matrix& a, const Matrix& b) {
+    const std::size_t d = a.size();
+    Matrix r(d, std::vector<uint64_t>(d, 0));
+    for (std::size_t i = 0; i < d; ++i)
+        for (std::size_t k = 0; k < d; ++k)
+            if (a[i][k])
+                for (std::size_t j = 0; j < d; ++j) r[i][j] += a[i][k] * b[k][j];
+    return r;
+}
+
+// How many iterations run before the one whose test leaves the loop, at
+// most limit. test(k) evaluates the exit at iteration k.
+template <typename Test>
+static uint64_t tripCount(const LoopSummary& s, uint64_t lb, uint64_t ls, uint64_t rb, uint64_t rs,
+                          uint64_t limit, Test test) {
+    const uint64_t m = widthMask(s.width);
+    if (test(0)) return 0;
+    // One side moves by step from v; the other stays at fixed
+    const bool left = (ls & m) != 0;
+    const uint64_t v = (left ? lb : rb) & m, step = (left ? ls : rs) & m, fixed = (left ? rb : lb) & m;
+    if (step == 0) return limit; // never exits
+    const uint64_t sign = m ^ (m >> 1);
+    const unsigned kind = s.cond >> 1;
+
+    if (kind == 0) {
+        // EQ/NE: at k = 0 the test stayed in, so the exit is at the first
+        // change (NE leaves) or when v + k * step == fixed (EQ leaves)
+        if (v == fixed) return std::min<uint64_t>(1, limit);
+        const uint64_t d = (fixed - v) & m;
+        unsigned t = 0;
+        while (!((step >> t) & 1)) ++t;
+        if (d & ((1ull << t) - 1)) return limit; // never equal
+        const uint64_t k = ((d >> t) * inverse(step >> t)) & (m >> t);
+        if (k > limit) return limit;
+        return test(k) ? k : 0;
+    }
+
+    // Ordered conditions are monotone while v + k * step does not wrap in
+    // the order they compare in.
+    const bool neg = step & sign;
+    const uint64_t mag = neg ? (0 - step) & m : step;
+    uint64_t room;
+    if (kind == 5 || kind == 6) {
+        const uint64_t biased = v ^ sign; // signed order as unsigned
+        room = neg ? biased : m - biased;
+    } else {
+        room = neg ? v : m - v;
+    }
+    uint64_t hi = std::min(room / mag, limit);
+    if (!test(hi)) return hi == limit ? limit : hi + 1;
+    uint64_t lo = 0; // test(lo) false, test(hi) true
+    while (hi - lo > 1) {
+        const uint64_t mid = lo + (hi - lo) / 2;
+        (test(mid) ? hi : lo) = mid;
+    }
+    return hi;
+}
+
+static uint64_t packed(const ProcessorState& ps) {
+    const ProcessorState::Nzcv f = ps.nzcv();
+    return (uint64_t{f.N} << 3) | (uint64_t{f.Z} << 2) | (uint64_t{f.C} << 1) | uint64_t{f.V};
+}
+
+static std::string hex(uint64_t v) {
+    std::ostringstream ss;
+    ss << "0x" << std::hex << v;
+    return ss.str();
+}
+
+const LoopSummary* LoopAccelerator::summaryAt(std::size_t idx) const {
+    if (idx >= summaryAt_.size() || summaryAt_[idx] == kNone) return nullptr;
+    return &summaries_[summaryAt_[idx]];
+}
+
+std::size_t LoopAccelerator::fastForward(std::size_t idx, Registers& regs, Stack& stack, uint64_t& pc,
+                                         ExecState& st, std::size_t budget) {
+    const LoopSummary* found = summaryAt(idx);
+    if (!found) return 0;
+    const LoopSummary& s = *found;
+    if (budget < s.length) return 0;
+
+    const std::size_t n = s.locations.size();
+    std::vector<uint64_t> x(n);
+    std::vector<uint8_t*> bytes(n, nullptr);
+    for (std::size_t i = 0; i < n; ++i) {
+        const LoopLocation& l = s.locations[i];
+        if (!l.memory) { x[i] = regs.get(l.reg); continue; }
+        bytes[i] = slotBytes(stack, st.memory, regs.get(l.reg) + static_cast<uint64_t>(l.offset), l.size);
+        if (!bytes[i]) return 0; // the interpreter raises the fault
+        x[i] = 0;
+        for (unsigned b = 0; b < l.size; ++b) x[i] |= static_cast<uint64_t>(bytes[i][b]) << (8 * b);
+    }
+
+    const uint64_t m = widthMask(s.width);
+    const uint64_t lb = evaluate(s.lhs, x), ls = slope(s, s.lhs);
+    const uint64_t rb = evaluate(s.rhs, x), rs = slope(s, s.rhs);
+    auto flagsAt = [&](uint64_t k) {
+        ProcessorState ps;
+        ps.setSub((lb + k * ls) & m, (rb + k * rs) & m, s.width);
+        return ps;
+    };
+    auto exitsAt = [&](uint64_t k) { return flagsAt(k).condition(s.cond) == s.exitTaken; };
+
+    const uint64_t iters = tripCount(s, lb, ls, rb, rs, budget / s.length, exitsAt);
+    if (iters == 0) return 0;
+
+    // x_k = A^k x_0 over the written locations, with the invariants folded
+    // into the constant column
+    std::vector<std::size_t> w;
+    for (std::size_t i = 0; i < n; ++i)
+        if (s.written[i]) w.push_back(i);
+    const std::size_t d = w.size() + 1;
+    std::vector<std::size_t> row(n, d);
+    for (std::size_t r = 0; r < w.size(); ++r) row[w[r]] = r;
+
+    Matrix a(d, std::vector<uint64_t>(d, 0)), p(d, std::vector<uint64_t>(d, 0));
+    for (std::size_t r = 0; r < w.size(); ++r) {
+        const LoopForm& f = s.next[w[r]];
+        a[r][d - 1] = f.c;
+        for (const auto& [loc, coef] : f.terms) {
+            if (row[loc] < d) a[r][row[loc]] += coef;
+            else              a[r][d - 1] += coef * x[loc];
+        }
+    }
+    a[d - 1][d - 1] = 1;
+    for (std::size_t r = 0; r < d; ++r) p[r][r] = 1;
+    for (uint64_t k = iters; k; k >>= 1) {
+        if (k & 1) p = multiply(p, a);
+        if (k > 1) a = multiply(a, a);
+    }
+
+    std::vector<uint64_t> y = x;
+    for (std::size_t r = 0; r < w.size(); ++r) {
+        uint64_t v = p[r][d - 1];
+        for (std::size_t c = 0; c + 1 < d; ++c) v += p[r][c] * x[w[c]];
+        y[w[r]] = s.next[w[r]].w32 ? v & widthMask(32) : v;
+    }
+    const ProcessorState flags = flagsAt(iters - 1);
+    const std::size_t skipped = static_cast<std::size_t>(iters) * s.length;
+    iterations_ += static_cast<std::size_t>(iters);
+
+    if (verify_) {
+        // Interpret the same iterations and hold the closed form to them
+        const uint64_t endAddr = prog_.base + prog_.code.size() * 4ull;
+        for (std::size_t i = 0; i < skipped; ++i) {
+            auto it = prog_.addr2idx.find(pc);
+            if (it == prog_.addr2idx.end() || !executeInst(prog_.code[it->second], endAddr, regs, stack, pc, st))
+                throw std::runtime_error("loop at " + hex(prog_.code[s.header].addr) + " left early while verifying");
+        }
+        auto mismatch = [&](const std::string& what, uint64_t want, uint64_t got) {
+            throw std::runtime_error("loop at " + hex(prog_.code[s.header].addr) + ": " + std::to_string(iters) +
+                                     " iterations predicted " + what + " = " + hex(want) + ", interpretation gave " +
+                                     hex(got));
+        };
+        if (pc != prog_.code[s.header].addr) mismatch("PC", prog_.code[s.header].addr, pc);
+        for (std::size_t i = 0; i < n; ++i) {
+            const LoopLocation& l = s.locations[i];
+            uint64_t got = 0;
+            if (!l.memory) got = regs.get(l.reg);
+            else
+                for (unsigned b = 0; b < l.size; ++b) got |= static_cast<uint64_t>(bytes[i][b]) << (8 * b);
+            const uint64_t want = l.memory ? y[i] & (~0ull >> (64 - 8 * l.size)) : y[i];
+            if (got != want) {
+                std::ostringstream name;
+                if (l.memory) name << "[slot " << static_cast<int>(l.reg) << ", #" << l.offset << "]";
+                else          name << "register slot " << static_cast<int>(l.reg);
+                mismatch(name.str(), want, got);
+            }
+        }
+        if (s.setsFlags && packed(flags) != packed(regs.state()))
+            mismatch("NZCV", packed(flags), packed(regs.state()));
+        return skipped;
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        if (!s.written[i]) continue;
+        const LoopLocation& l = s.locations[i];
+        if (!l.memory) { regs.set(l.reg, y[i]); continue; }
+        for (unsigned b = 0; b < l.size; ++b) bytes[i][b] = static_cast<uint8_t>(y[i] >> (8 * b));
+    }
+    if (s.setsFlags) regs.state() = flags;
+    regs.writePC(pc);
+    return skipped;
+}
+
+} // namespace arm64
@@ -0,0 +1,215 @@
+#include "machine.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "image.hpp"
+
+namespace arm64 {
+
+Machine::Machine(MachineOptions opts)
+    : opts_(opts), memory_(std::make_unique<Memory>()) {
+    exec_.memory = memory_.get();
+}
+
+void Machine::load(const std::string& path, std::vector<std::string> args,
+                   const std::vector<std::string>& env) {
+    prog_.reset();
+    lazy_.reset();
+    elf_.reset();
+    if (isElfFile(path)) {
+        if (opts_.lazyCache || opts_.useCache)
+            throw std::runtime_error("lazy decoding and image caching apply to assembly listings only");
+        elf_ = std::make_unique<ElfExecutable>(path);
+        prog_ = std::make_unique<AsmProgram>(elf_->decode(parser_));
+    } else if (opts_.lazyCache) {
+        if (opts_.optimize || opts_.fastLoops)
+            throw std::runtime_error("optimizing and loop fast-forwarding need the whole program");
+        lazy_ = std::make_unique<LazyProgram>(path, parser_, opts_.lazyCache);
+    } else {
+        prog_ = std::make_unique<AsmProgram>(opts_.useCache ? buildCachedProgram(path, parser_, opts_.imagePath)
+                                                            : buildFileProgram(path, parser_));
+    }
+    if (args.empty()) args.push_back(path);
+    reset(std::move(args), env);
+}
+
+void Machine::loadText(std::string_view listing) {
+    prog_ = std::make_unique<AsmProgram>(buildProgramFromText(listing, parser_));
+    lazy_.reset();
+    elf_.reset();
+    reset({}, {});
+}
+
+// Fresh registers, stack and guest memory for the program just loaded.
+void Machine::reset(std::vector<std::string> args, const std::vector<std::string>& env) {
+    // The rewrites only take effect in runs that execute whole blocks
+    optStats_ = OptimizeStats{};
+    if (opts_.optimize && prog_) optStats_ = optimizeProgram(*prog_);
+
+    endAddr_ = (prog_ ? prog_->base : 0) + instructionCount() * 4ull;
+
+    // 256-byte stack, SP = top of the stack
+    regs_ = Registers{};
+    stack_ = Stack(/*base=*/0x0);
+    if (opts_.randomStack) stack_.fillRandom();
+    regs_.writeSP(stack_.base() + stack_.size());
+
+    // Guest heap for brk/mmap, and loads/stores outside the stack
+    memory_ = std::make_unique<Memory>(elf_ ? elf_->brkBase() : Memory::kDefaultBrkBase);
+    exec_.memory = memory_.get();
+    exec_.returnStack.clear();
+    exec_.rasHits = exec_.rasMisses = 0;
+    exec_.exited = false;
+    exec_.exitCode = 0;
+    exec_.hostCalls = 0;
+
+    // Listings start at 0x0; an ELF process starts at e_entry on its own stack
+    pc_ = 0;
+    if (elf_) {
+        elf_->load(*memory_);
+        regs_.writeSP(elf_->setupStack(*memory_, args, env));
+        pc_ = elf_->entry();
+    }
+    regs_.writePC(pc_);
+
+    loops_.reset();
+    if (prog_ && opts_.fastLoops) loops_ = std::make_unique<LoopAccelerator>(*prog_, pc_, opts_.verifyLoops);
+
+    steps_ = 0;
+    reason_ = StopReason::End;
+    finished_ = false;
+}
+
+std::size_t Machine::instructionCount() const {
+    if (lazy_) return lazy_->size();
+    return prog_ ? prog_->code.size() : 0;
+}
+
+void Machine::setPc(uint64_t pc) {
+    pc_ = pc;
+    regs_.writePC(pc);
+    finished_ = false;
+}
+
+const AsmInst* Machine::fetch() {
+    if (lazy_) {
+        if (pc_ % 4 == 0 && pc_ / 4 < lazy_->size()) return &lazy_->fetch(pc_);
+        return nullptr;
+    }
+    if (!prog_) return nullptr;
+    auto it = prog_->addr2idx.find(pc_);
+    return it != prog_->addr2idx.end() ? &prog_->code[it->second] : nullptr;
+}
+
+StopReason Machine::run(const RunLimits& limits) {
+    return runLoop(limits, false, 0);
+}
+
+StopReason Machine::runUntil(uint64_t addr, const RunLimits& limits) {
+    return runLoop(limits, true, addr);
+}
+
+bool Machine::step() {
+    runLoop(RunLimits{}, true, ~pc_, /*once=*/true);
+    return !finished_;
+}
+
+// The executor loop. The step limit is exact: it is tested before every
+// dispatch, and a superinstruction that would cross it runs as its first
+// instruction alone. The watchdog is polled at block boundaries: wherever
+// control did not just fall through (seqPc), which every loop passes
+// through. stopAt (runUntil, step) runs one instruction at a time; once
+// stops after the first.
+StopReason Machine::runLoop(const RunLimits& limits, bool stopAt, uint64_t until, bool once) {
+    if (finished_) return reason_;
+
+    std::unique_ptr<Watchdog> watchdog;
+    if (limits.timeoutMs) watchdog = std::make_unique<Watchdog>(std::chrono::milliseconds(limits.timeoutMs));
+    const std::size_t maxSteps = limits.maxSteps ? limits.maxSteps : SIZE_MAX;
+    const bool whole = !stopAt && !opts_.singleStep && prog_;
+    std::size_t steps = 0;
+    uint64_t seqPc = ~pc_; // the first instruction is a boundary
+
+    auto stop = [&](StopReason r, bool done) {
+        steps_ += steps;
+        reason_ = r;
+        finished_ = done;
+        return r;
+    };
+
+    try {
+        while (true) {
+            if (pc_ == endAddr_) return stop(StopReason::End, true); // fell off end
+            if (stopAt && pc_ == until && steps) return stop(StopReason::Breakpoint, false);
+            if (once && steps) return stop(StopReason::StepLimit, false);
+
+            if (steps >= maxSteps) return stop(StopReason::StepLimit, false);
+            if (pc_ != seqPc && watchdog && watchdog->expired()) return stop(StopReason::Timeout, false);
+
+            const AsmInst* ai = fetch();
+            if (!ai) return stop(StopReason::BadPc, true);
+            if (fetchHook_) fetchHook_(*ai);
+
+            // Whole-program runs execute whole superinstructions; a group
+            // never spans a block, so it ends at the same boundaries a
+            // single-stepped run does.
+            if (whole) {
+                if (loops_) {
+                    const std::size_t idx = static_cast<std::size_t>(ai - prog_->code.data());
+                    const std::size_t budget = maxSteps - steps; // > 0, tested above
+                    if (const std::size_t skipped = loops_->fastForward(idx, regs_, stack_, pc_, exec_, budget)) {
+                        steps += skipped;
+                        // Back at the header, entered the way the last iteration entered it
+                        seqPc = loops_->summaryAt(idx)->fallsIn ? pc_ : ~pc_;
+                        continue;
+                    }
+                }
+                const uint64_t from = pc_;
+                std::size_t retired = 0;
+                bool more;
+                if (ai->pre.fuseLen <= maxSteps - steps) {
+                    more = executeFused(ai, endAddr_, regs_, stack_, pc_, exec_, retired);
+                } else {
+                    retired = 1;
+                    more = executeInst(*ai, endAddr_, regs_, stack_, pc_, exec_);
+                }
+                steps += retired;
+                seqPc = from + 4ull * retired;
+                if (!more) break;
+                continue;
+            }
+
+            // Execute one instruction; false on a halting RET, exit or natural end
+            seqPc = pc_ + 4;
+            ++steps;
+            if (!executeInst(*ai, endAddr_, regs_, stack_, pc_, exec_)) break;
+        }
+    } catch (...) {
+        stop(StopReason::Error, true);
+        throw;
+    }
+    if (pc_ == endAddr_) return stop(StopReason::End, true);
+    return stop(exec_.exited ? StopReason::Exit : StopReason::Halt, true);
+}
+
+// The stack is checked first; other addresses go to the guest heap.
+uint8_t* Machine::guestBytes(uint64_t addr, std::size_t n) {
+    if (addr >= stack_.base() && addr - stack_.base() <= stack_.size() && n <= stack_.size() - (addr - stack_.base()))
+        return stack_.data() + (addr - stack_.base());
+    if (uint8_t* p = memory_->translate(addr, n)) return p;
+    throw std::runtime_error("guest address not mapped");
+}
+
+void Machine::readMemory(uint64_t addr, void* dst, std::size_t n) {
+    if (n) std::memcpy(dst, guestBytes(addr, n), n);
+}
+
+void Machine::writeMemory(uint64_t addr, const void* src, std::size_t n) {
+    if (n) std::memcpy(guestBytes(addr, n), src, n);
+}
+
+} // namespace arm64
@@ -0,0 +1,101 @@
+#include "mapped_file.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace arm64 {
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::string& path) {
+    HANDLE f = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE) throw std::runtime_error("could not open input file: " + path);
+    file_ = f;
+
+    LARGE_INTEGER sz;
+    if (!GetFileSizeEx(f, &sz)) { release(); throw std::runtime_error("could not stat file: " + path); }
+    size_ = static_cast<std::size_t>(sz.QuadPart);
+    if (size_ == 0) return;
+
+    HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m) { release(); throw std::runtime_error("could not map file: " + path); }
+    mapping_ = m;
+
+    void* p = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+    if (!p) { release(); throw std::runtime_error("could not map file: " + path); }
+    data_ = static_cast<const char*>(p);
+}
+
+void MappedFile::release() {
+    if (data_)    UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(static_cast<HANDLE>(mapping_));
+    if (file_)    CloseHandle(static_cast<HANDLE>(file_));
+    data_ = nullptr; mapping_ = nullptr; file_ = nullptr; size_ = 0;
+}
+
+bool MappedFile::exists(const std::string& path) {
+    return GetFileAttributesA(path.c_str()) != INVALID_FILE_ATTRIBUTES;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("could not open input file: " + path);
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) { ::close(fd); throw std::runtime_error("could not stat file: " + path); }
+    size_ = static_cast<std::size_t>(st.st_size);
+
+    if (size_ != 0) {
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) { ::close(fd); size_ = 0; throw std::runtime_error("could not map file: " + path); }
+        data_ = static_cast<const char*>(p);
+    }
+    ::close(fd); // the mapping keeps the file alive
+}
+
+void MappedFile::release() {
+    if (data_) ::munmap(const_cast<char*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+}
+
+bool MappedFile::exists(const std::string& path) {
+    struct stat st{};
+    return ::stat(path.c_str(), &st) == 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() { release(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+#if defined(_WIN32)
+        std::swap(file_, other.file_);
+        std::swap(mapping_, other.mapping_);
+#endif
+    }
+    return *this;
+}
+
+} // namespace arm64
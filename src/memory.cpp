@@ -0,0 +1,169 @@
+#include "memory.hpp"
+
+#include <stdexcept>
+
+#if defined(_WIN32)
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+#endif
+
+namespace arm64 {
+
+static uint64_t pageUp(uint64_t v) {
+    return (v + Memory::kPageSize - 1) & ~(Memory::kPageSize - 1);
+}
+
+/* Host reservations: address space first, pages committed on demand */
+
+struct Memory::Reservation {
+    uint8_t* base{nullptr};
+    std::size_t size{0};
+
+    explicit Reservation(std::size_t n) : size(n) {
+#if defined(_WIN32)
+        void* p = VirtualAlloc(nullptr, n, MEM_RESERVE, PAGE_NOACCESS);
+        if (!p) throw std::runtime_error("could not reserve guest memory");
+#else
+        void* p = ::mmap(nullptr, n, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED) throw std::runtime_error("could not reserve guest memory");
+#endif
+        base = static_cast<uint8_t*>(p);
+    }
+
+    ~Reservation() {
+#if defined(_WIN32)
+        VirtualFree(base, 0, MEM_RELEASE);
+#else
+        ::munmap(base, size);
+#endif
+    }
+
+    Reservation(const Reservation&) = delete;
+    Reservation& operator=(const Reservation&) = delete;
+
+    // Make pages usable; the host supplies zeroed memory on first touch.
+    bool commit(uint64_t off, uint64_t n) {
+        if (n == 0) return true;
+#if defined(_WIN32)
+        return VirtualAlloc(base + off, static_cast<SIZE_T>(n), MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+        return ::mprotect(base + off, static_cast<std::size_t>(n), PROT_READ | PROT_WRITE) == 0;
+#endif
+    }
+
+    // Return the pages to the host; the address range stays reserved.
+    void decommit(uint64_t off, uint64_t n) {
+        if (n == 0) return;
+#if defined(_WIN32)
+        VirtualFree(base + off, static_cast<SIZE_T>(n), MEM_DECOMMIT);
+#else
+        ::madvise(base + off, static_cast<std::size_t>(n), MADV_DONTNEED);
+        ::mprotect(base + off, static_cast<std::size_t>(n), PROT_NONE);
+#endif
+    }
+};
+
+Memory::Memory(uint64_t brkBase)
+    : brkBase_(pageUp(brkBase)), brkCur_(brkBase_),
+      brkHost_(std::make_unique<Reservation>(static_cast<std::size_t>(kBrkReserve))) {}
+
+Memory::~Memory() = default;
+
+uint64_t Memory::brk(uint64_t request) {
+    if (request < brkBase_ || request > brkBase_ + kBrkReserve) return brkCur_;
+
+    const uint64_t oldTop = pageUp(brkCur_ - brkBase_);
+    const uint64_t newTop = pageUp(request - brkBase_);
+    if (newTop > oldTop) {
+        if (!brkHost_->commit(oldTop, newTop - oldTop)) return brkCur_;
+    } else {
+        brkHost_->decommit(newTop, oldTop - newTop);
+    }
+    brkCur_ = request;
+    return brkCur_;
+}
+
+// Whether any of [start, end) is mapped or inside the brk reservation.
+bool Memory::inUse(uint64_t start, uint64_t end) const {
+    if (start < brkBase_ + kBrkReserve && end > brkBase_) return true;
+    auto it = regions_.lower_bound(end);
+    return it != regions_.begin() && (--it)->second.end > start;
+}
+
+bool Memory::addRegion(uint64_t start, uint64_t end) {
+    auto host = std::make_shared<Reservation>(static_cast<std::size_t>(end - start));
+    if (!host->commit(0, end - start)) return false;
+    regions_.emplace(start, Region{end, std::move(host), 0});
+    return true;
+}
+
+uint64_t Memory::mmap(uint64_t len) {
+    if (len == 0 || len > kMaxMapping) return 0;
+    len = pageUp(len);
+
+    // Step over the brk heap and fixed mappings placed in the mmap area
+    uint64_t addr = mmapNext_;
+    while (inUse(addr, addr + len)) {
+        if (addr < brkBase_ + kBrkReserve && addr + len > brkBase_) {
+            addr = brkBase_ + kBrkReserve;
+            continue;
+        }
+        auto it = regions_.lower_bound(addr + len);
+        addr = pageUp((--it)->second.end);
+    }
+    if (!addRegion(addr, addr + len)) return 0;
+    mmapNext_ = addr + len;
+    return addr;
+}
+
+bool Memory::map(uint64_t addr, uint64_t len) {
+    const uint64_t start = addr & ~(kPageSize - 1);
+    const uint64_t end = pageUp(addr + len);
+    if (len == 0 || end <= start || inUse(start, end)) return false;
+    return addRegion(start, end);
+}
+
+bool Memory::munmap(uint64_t addr, uint64_t len) {
+    if (len == 0 || (addr & (kPageSize - 1)) != 0) return false;
+    const uint64_t end = addr + pageUp(len);
+
+    // First region that could overlap [addr, end)
+    auto it = regions_.upper_bound(addr);
+    if (it != regions_.begin()) --it;
+
+    while (it != regions_.end() && it->first < end) {
+        const uint64_t start = it->first;
+        Region r = it->second;
+        if (r.end <= addr) { ++it; continue; }
+
+        const uint64_t cutLo = start > addr ? start : addr;
+        const uint64_t cutHi = r.end < end ? r.end : end;
+        r.host->decommit(r.hostOff + (cutLo - start), cutHi - cutLo);
+
+        it = regions_.erase(it);
+        if (start < cutLo) regions_.emplace(start, Region{cutLo, r.host, r.hostOff});
+        if (cutHi < r.end) {
+            it = regions_.emplace(cutHi, Region{r.end, r.host, r.hostOff + (cutHi - start)}).first;
+            ++it;
+        }
+    }
+    return true;
+}
+
+uint8_t* Memory::translate(uint64_t addr, uint64_t len) {
+    if (addr >= brkBase_ && addr <= brkCur_ && len <= brkCur_ - addr)
+        return brkHost_->base + (addr - brkBase_);
+
+    auto it = regions_.upper_bound(addr);
+    if (it == regions_.begin()) return nullptr;
+    --it;
+    const Region& r = it->second;
+    if (addr >= r.end || len > r.end - addr) return nullptr;
+    return r.host->base + r.hostOff + (addr - it->first);
+}
+
+} // namespace arm64
@@ -0,0 +1,303 @@
+#include "optimize.hpp"
+#include "cfg.hpp"
+
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+namespace arm64 {
+
+using Slots = std::array<bool, Registers::kSlots>;
+
+// Results that depend only on the source registers: no flags, no memory, no
+// faults (division by zero yields 0).
+static bool isPure(Opcode op) {
+    return (op >= Opcode::Mov && op <= Opcode::Udiv) || (op >= Opcode::Lsl && op <= Opcode::Sxtw);
+}
+
+// Conditional selects also read the flags, so they are never folded.
+static bool isSelect(Opcode op) {
+    return op >= Opcode::Csel && op <= Opcode::Cneg;
+}
+
+// MOVK and BFM-style inserts keep the rest of Rd.
+static bool readsRd(const AsmInst& ai) {
+    return ai.inst.op == Opcode::Movk || ai.pre.bf == 3;
+}
+
+// Bytes moved by a general-register load/store.
+static unsigned accessSize(const AsmInst& ai) {
+    const Opcode op = ai.inst.op;
+    if (op == Opcode::Ldrb || op == Opcode::Strb) return 1;
+    if (op == Opcode::Ldrh || op == Opcode::Strh) return 2;
+    const unsigned size = ai.pre.rdW ? 4u : 8u;
+    return (op == Opcode::Ldp || op == Opcode::Stp) ? 2 * size : size;
+}
+
+// A value known to be in memory at an address, and the register holding it.
+struct MemFact {
+    const Predecoded* mem; // address operand
+    unsigned size;
+    uint8_t reg;
+};
+
+static bool sameAddress(const Predecoded& a, const Predecoded& b) {
+    return a.memBase == b.memBase && a.memIndex == b.memIndex && a.memIndexW == b.memIndexW &&
+           a.memLsl == b.memLsl && a.memIndexSxt == b.memIndexSxt && a.memOffset == b.memOffset;
+}
+
+// Disjoint offsets from one base register cannot alias; anything else might.
+static bool mayAlias(const Predecoded& a, unsigned asz, const Predecoded& b, unsigned bsz) {
+    if (a.memIndex != Registers::XZR_INDEX || b.memIndex != Registers::XZR_INDEX || a.memBase != b.memBase)
+        return true;
+    return a.memOffset < b.memOffset + static_cast<int64_t>(bsz) &&
+           b.memOffset < a.memOffset + static_cast<int64_t>(asz);
+}
+
+// Runs a pure instruction on its known source values.
+static bool evaluate(const AsmInst& ai, const Slots& known, const std::array<uint64_t, Registers::kSlots>& val,
+                     uint64_t& out) {
+    Registers regs;
+    Stack stack;
+    ExecState st;
+    st.hostFunctions = false;
+    for (unsigned s = 0; s < Registers::kSlots; ++s)
+        if (known[s]) regs.set(s, val[s]);
+    uint64_t pc = ai.addr;
+    try {
+        executeInst(ai, ai.addr + 8, regs, stack, pc, st);
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+    out = regs.get(ai.pre.rd);
+    return true;
+}
+
+// Forward pass: constants and reloads. Marks the loads it rewrites.
+static void propagate(AsmInst* w, std::size_t len, std::vector<bool>& reload) {
+    Slots known{};
+    std::array<uint64_t, Registers::kSlots> val{};
+    known[Registers::XZR_INDEX] = true;
+    std::vector<MemFact> facts;
+
+    auto clobber = [&](uint8_t r) {
+        if (r == Registers::XZR_INDEX) return;
+        known[r] = false;
+        std::size_t keep = 0;
+        for (const MemFact& f : facts)
+            if (f.reg != r && f.mem->memBase != r && f.mem->memIndex != r) facts[keep++] = f;
+        facts.resize(keep);
+    };
+    auto forget = [&]() {
+        known.fill(false);
+        known[Registers::XZR_INDEX] = true;
+        facts.clear();
+    };
+    // A store leaves only the facts it cannot have overwritten.
+    auto store = [&](const Predecoded& p, unsigned size) {
+        std::size_t keep = 0;
+        for (const MemFact& f : facts)
+            if (!mayAlias(*f.mem, f.size, p, size)) facts[keep++] = f;
+        facts.resize(keep);
+    };
+
+    for (std::size_t k = 0; k < len; ++k) {
+        AsmInst& ai = w[k];
+        Predecoded& p = ai.pre;
+        const Opcode op = ai.inst.op;
+        if (!p.ok || p.host) { forget(); continue; }
+
+        if (isPure(op)) {
+            const bool srcs = known[p.rn] && known[p.rm] && known[p.ra] && (!readsRd(ai) || known[p.rd]);
+            uint64_t v = 0;
+            const bool folded = srcs && evaluate(ai, known, val, v);
+            clobber(p.rd);
+            if (folded && p.rd != Registers::XZR_INDEX) {
+                p.opt = OptAction::Const;
+                p.optImm = v;
+                known[p.rd] = true;
+                val[p.rd] = v;
+            }
+            continue;
+        }
+
+        switch (op) {
+        case Opcode::Nop: case Opcode::Cmp: case Opcode::Cmn: case Opcode::Tst:
+        case Opcode::Ccmp: case Opcode::Ccmn:
+        case Opcode::B: case Opcode::BCond: case Opcode::Cbz: case Opcode::Cbnz:
+        case Opcode::Tbz: case Opcode::Tbnz:
+            break;
+
+        case Opcode::Adds: case Opcode::Subs: case Opcode::Ands:
+        case Opcode::Adc: case Opcode::Adcs: case Opcode::Sbc: case Opcode::Sbcs:
+        case Opcode::Csel: case Opcode::Csinc: case Opcode::Csinv: case Opcode::Csneg:
+        case Opcode::Cset: case Opcode::Csetm: case Opcode::Cinc: case Opcode::Cinv: case Opcode::Cneg:
+            clobber(p.rd);
+            break;
+
+        case Opcode::Ldr: case Opcode::Ldrb: case Opcode::Ldrh: {
+            const unsigned size = accessSize(ai);
+            const uint64_t mask = size == 8 ? ~0ull : (1ull << (8 * size)) - 1;
+            if (!p.memWb) {
+                for (const MemFact& f : facts) {
+                    if (f.size != size || !sameAddress(*f.mem, p)) continue;
+                    // The same access succeeded before, so skipping this one cannot hide a fault.
+                    if (known[f.reg])                      { p.opt = OptAction::Const; p.optImm = val[f.reg] & mask; }
+                    else if (f.reg == p.rd && mask == ~0ull) p.opt = OptAction::Skip;
+                    else                                   { p.opt = OptAction::Move; p.optSrc = f.reg; p.optImm = mask; }
+                    reload[k] = true;
+                    break;
+                }
+            }
+            if (p.opt == OptAction::Skip) break;
+            clobber(p.rd);
+            if (p.memWb) { clobber(p.memBase); break; }
+            if (p.opt == OptAction::Const) { known[p.rd] = true; val[p.rd] = p.optImm; }
+            if (p.rd != Registers::XZR_INDEX && p.rd != p.memBase && p.rd != p.memIndex)
+                facts.push_back({&p, size, p.rd});
+            break;
+        }
+
+        // Not forwarded: a stored value would need sign-extending
+        case Opcode::Ldrsb: case Opcode::Ldrsh: case Opcode::Ldrsw:
+            clobber(p.rd);
+            if (p.memWb) clobber(p.memBase);
+            break;
+
+        case Opcode::Str: case Opcode::Strb: case Opcode::Strh: {
+            store(p, accessSize(ai));
+            if (p.memWb) clobber(p.memBase);
+            else         facts.push_back({&p, accessSize(ai), p.rd});
+            break;
+        }
+
+        case Opcode::Ldp:
+            clobber(p.rd);
+            clobber(p.rn);
+            if (p.memWb) clobber(p.memBase);
+            break;
+
+        case Opcode::Stp:
+            store(p, accessSize(ai));
+            if (p.memWb) clobber(p.memBase);
+            break;
+
+        default:
+            forget();
+            break;
+        }
+    }
+}
+
+// Backward pass: skips writes nothing in the window reads before the next
+// write, with every register live at the end. Marks what it skipped.
+static void eliminate(AsmInst* w, std::size_t len, std::vector<bool>& dead) {
+    Slots live;
+    live.fill(true);
+    auto kill = [&](uint8_t r) { if (r != Registers::XZR_INDEX) live[r] = false; };
+    auto gen  = [&](uint8_t r) { live[r] = true; };
+
+    for (std::size_t k = len; k-- > 0;) {
+        AsmInst& ai = w[k];
+        Predecoded& p = ai.pre;
+        const Opcode op = ai.inst.op;
+        if (!p.ok || p.host) { live.fill(true); continue; }
+
+        const bool pure = p.opt == OptAction::Const || p.opt == OptAction::Move ||
+                          (p.opt == OptAction::Keep && (isPure(op) || isSelect(op)));
+        if (pure && (p.rd == Registers::XZR_INDEX || !live[p.rd])) {
+            p.opt = OptAction::Skip;
+            dead[k] = true;
+            continue;
+        }
+
+        switch (p.opt) {
+        case OptAction::Skip:  continue;
+        case OptAction::Const: kill(p.rd); continue;
+        case OptAction::Move:  kill(p.rd); gen(p.optSrc); continue;
+        case OptAction::Keep:  break;
+        }
+
+        if (pure) {
+            kill(p.rd);
+            gen(p.rn); gen(p.rm); gen(p.ra);
+            if (readsRd(ai)) gen(p.rd);
+            continue;
+        }
+
+        switch (op) {
+        case Opcode::Nop:
+            break;
+
+        case Opcode::Cmp: case Opcode::Cmn: case Opcode::Tst: case Opcode::Ccmp: case Opcode::Ccmn:
+            gen(p.rn); gen(p.rm);
+            break;
+
+        case Opcode::Adds: case Opcode::Subs: case Opcode::Ands:
+        case Opcode::Adc: case Opcode::Adcs: case Opcode::Sbc: case Opcode::Sbcs:
+            kill(p.rd);
+            gen(p.rn); gen(p.rm);
+            break;
+
+        case Opcode::Ldr: case Opcode::Ldrb: case Opcode::Ldrh:
+        case Opcode::Ldrsb: case Opcode::Ldrsh: case Opcode::Ldrsw:
+            kill(p.rd);
+            gen(p.memBase); gen(p.memIndex);
+            break;
+
+        case Opcode::Ldp:
+            kill(p.rd); kill(p.rn);
+            gen(p.memBase);
+            break;
+
+        case Opcode::Str: case Opcode::Strb: case Opcode::Strh: case Opcode::Stp:
+            gen(p.rd); gen(p.rn); gen(p.memBase); gen(p.memIndex);
+            break;
+
+        default:
+            live.fill(true);
+            break;
+        }
+    }
+}
+
+OptimizeStats optimizeProgram(AsmProgram& prog) {
+    OptimizeStats stats;
+    const std::size_t n = prog.code.size();
+    const std::vector<bool> leader = blockLeaders(prog);
+    std::vector<bool> reload, dead;
+
+    std::size_t i = 0;
+    while (i < n) {
+        std::size_t len = 1;
+        while (i + len < n && len < kMaxFusedLength && !leader[i + len]) ++len;
+
+        AsmInst* w = &prog.code[i];
+        for (std::size_t k = 0; k < len; ++k) w[k].pre.opt = OptAction::Keep;
+        // executeInst() has to see host-function entries
+        if (!w->pre.host) {
+            reload.assign(len, false);
+            dead.assign(len, false);
+            propagate(w, len, reload);
+            eliminate(w, len, dead);
+
+            bool rewritten = false;
+            for (std::size_t k = 0; k < len; ++k) {
+                if (w[k].pre.opt == OptAction::Keep) continue;
+                rewritten = true;
+                if (dead[k])        ++stats.dead;
+                else if (reload[k]) ++stats.forwarded;
+                else                ++stats.folded;
+            }
+            if (rewritten) {
+                w->pre.fuse = Fusion::Block;
+                w->pre.fuseLen = static_cast<uint8_t>(len);
+                ++stats.windows;
+            }
+        }
+        i += len;
+    }
+    return stats;
+}
+
+} // namespace arm64
@@ -1,65 +1,141 @@
 #include "parser.hpp"
+#include "scan.hpp"
 
 #include <algorithm>
 #include <cctype>
-#include <sstream>
+#include <charconv>
+#include <functional>
+#include <memory>
+#include <utility>
 #include <stdexcept>
 
 namespace arm64 {
 
-/* Helper functions for formatting strings and parsing tokens */
+/* Helper functions for formatting strings and parsing tokens.
+ * Everything here works on std::string_view slices of the caller's line, so
+ * tokenizing a line does not build temporary strings. */
+
+// ASCII-only classification; the <cctype> versions go through the C locale
+// on every call, which dominated the cost of tokenizing a line.
+static bool isSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static char upperChar(char c) {
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - ('a' - 'A')) : c;
+}
 
 // trim whitespace from both ends
-static std::string trim(std::string s) {
-    auto not_space = [](int ch){ return !std::isspace(ch); };
-    s.erase(s.begin(), std::find_if(s.begin(), s.end(), not_space));
-    s.erase(std::find_if(s.rbegin(), s.rend(), not_space).base(), s.end());
-    return s;
+static std::string_view trim(std::string_view s) {
+    std::size_t b = 0, e = s.size();
+    while (b < e && isSpace(s[b])) ++b;
+    while (e > b && isSpace(s[e - 1])) --e;
+    return s.substr(b, e - b);
 }
 
-// uppercase
-static std::string upper(std::string s) {
-    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c){ return std::toupper(c); });
-    return s;
+// uppercase copy (mnemonics fit in the small-string buffer, so no allocation)
+static std::string upper(std::string_view s) {
+    std::string out(s);
+    for (char& c : out) c = upperChar(c);
+    return out;
+}
+
+// case-insensitive compare against an uppercase literal
+static bool equalsUpper(std::string_view s, std::string_view upperLit) {
+    if (s.size() != upperLit.size()) return false;
+    for (std::size_t i = 0; i < s.size(); ++i)
+        if (upperChar(s[i]) != upperLit[i]) return false;
+    return true;
 }
 
 /* Simple checks for token types */
 
 // Is this token a register?
-static bool isReg(const std::string& t) {
+static bool isReg(std::string_view t) {
     if (t.empty()) return false;
-    std::string u = upper(t);
     // crude: X0..X30, W0..W30, SP, XZR/WZR
-    if (u == "SP" || u == "XZR" || u == "WZR") return true;
-    if ((u[0] == 'X' || u[0] == 'W') && u.size() >= 2) {
-        for (size_t i = 1; i < u.size(); ++i) if (!std::isdigit(static_cast<unsigned char>(u[i]))) return false;
+    if (equalsUpper(t, "SP") || equalsUpper(t, "XZR") || equalsUpper(t, "WZR")) return true;
+    const char c0 = upperChar(t[0]);
+    if ((c0 == 'X' || c0 == 'W') && t.size() >= 2) {
+        for (size_t i = 1; i < t.size(); ++i) if (!isDigit(t[i])) return false;
         return true;
     }
     return false;
 }
 
+// Is this token an AdvSIMD/FP register? Vn with an optional arrangement
+// and lane ("v0", "v0.4s", "v0.s[1]", "v0.4s[1]"), or a scalar view Bn/Hn/Sn/Dn/Qn.
+static bool isVector(std::string_view t) {
+    if (t.size() < 2) return false;
+    const char c0 = upperChar(t[0]);
+    std::size_t i = 1;
+    while (i < t.size() && i < 3 && isDigit(t[i])) ++i;
+    if (i == 1) return false;
+    if (i == t.size()) return c0 == 'V' || c0 == 'B' || c0 == 'H' || c0 == 'S' || c0 == 'D' || c0 == 'Q';
+    if (c0 != 'V' || t[i] != '.') return false;
+    ++i;
+    while (i < t.size() && isDigit(t[i])) ++i;
+    if (i == t.size()) return false;
+    const char e = upperChar(t[i++]);
+    if (e != 'B' && e != 'H' && e != 'S' && e != 'D') return false;
+    if (i == t.size()) return true;
+    return t[i] == '[' && t.back() == ']';
+}
+
+// Is this token a braced register list?
+static bool isVList(std::string_view t) {
+    return t.size() >= 2 && t.front() == '{' && t.back() == '}';
+}
+
 // Is this token an immediate value?
-static bool isImmediate(const std::string& t) {
+static bool isImmediate(std::string_view t) {
     return !t.empty() && t[0] == '#';
 }
 
 // Is this token a memory reference?
-static bool isMem(const std::string& t) {
-    // [X0], [X1,#8], [SP], etc.
+static bool isMem(std::string_view t) {
+    // [X0], [X1,#8], [SP], [SP,#-16]! (pre-index), etc.
+    if (!t.empty() && t.back() == '!') t.remove_suffix(1);
     return !t.empty() && t.front() == '[' && t.back() == ']';
 }
 
-// Parse immediate value from token if applicable
-static int64_t parseImmediate(const std::string& t) {
-    std::string v = t.substr(1);
-    if (v.rfind("0x", 0) == 0 || v.rfind("0X", 0) == 0) {
-        return static_cast<int64_t>(std::stoll(v, nullptr, 16));
+// Is this token a shift or extend specifier? ("LSL #2", "ASR #63", "SXTW", "UXTB #1")
+static bool isShift(std::string_view t) {
+    static constexpr std::string_view kNames[] = {
+        "LSL", "LSR", "ASR", "ROR",
+        "UXTB", "UXTH", "UXTW", "UXTX", "SXTB", "SXTH", "SXTW", "SXTX",
+    };
+    std::size_t n = 0;
+    while (n < t.size() && !isSpace(t[n]) && t[n] != '#') ++n;
+    const std::string_view rest = trim(t.substr(n));
+    if (!rest.empty() && rest[0] != '#') return false;
+    for (std::string_view name : kNames)
+        if (equalsUpper(t.substr(0, n), name)) return true;
+    return false;
+}
+
+// Parse immediate value from token if applicable ("#10", "#0x10", "#-16")
+static int64_t parseImmediate(std::string_view t) {
+    std::string_view v = t.substr(1);
+    bool neg = false;
+    if (!v.empty() && (v[0] == '-' || v[0] == '+')) { neg = (v[0] == '-'); v.remove_prefix(1); }
+    int base = 10;
+    if (v.size() > 2 && v[0] == '0' && (v[1] == 'x' || v[1] == 'X')) { base = 16; v.remove_prefix(2); }
+
+    uint64_t mag = 0;
+    auto [ptr, ec] = std::from_chars(v.data(), v.data() + v.size(), mag, base);
+    if (ec != std::errc{} || ptr == v.data()) {
+        throw std::runtime_error("invalid immediate: " + std::string(t));
     }
-    return static_cast<int64_t>(std::stoll(v, nullptr, 10));
+    return static_cast<int64_t>(neg ? (0 - mag) : mag);
 }
 
 // Parse a single operand
-static Operand parseOp(std::string tok) {
+static Operand parseOp(std::string_view tok) {
     tok = trim(tok);
     if (tok.empty()) return {};
 
@@ -71,41 +147,137 @@ static Operand parseOp(std::string tok) {
         return Operand{OperandType::Register, tok};
     }
 
+    if (isVector(tok)) {
+        return Operand{OperandType::Vector, tok};
+    }
+
+    if (isVList(tok)) {
+        return Operand{OperandType::VList, tok};
+    }
+
     if (isImmediate(tok)) {
         return Operand{OperandType::Immediate, tok, parseImmediate(tok)};
     }
 
+    if (isShift(tok)) {
+        const std::size_t hash = tok.find('#');
+        return Operand{OperandType::Shift, tok,
+                       hash == std::string_view::npos ? 0 : parseImmediate(trim(tok.substr(hash)))};
+    }
+
     // Treat as label or symbol if necessary
     return Operand{OperandType::Label, tok, 0};
 }
 
-// Split operands on commas with respect to brackets
-static std::vector<Operand> parseOps(const std::string& s) {
-    std::vector<Operand> out;
-    std::string cur;
+OperandList& OperandList::operator=(const OperandList& other) {
+    if (this == &other) return *this;
+    text_ = other.text_;
+    n_    = other.n_;
+    if (other.heap_) {
+        cap_  = other.n_;
+        heap_ = std::make_unique<Operand[]>(cap_);
+        std::copy(other.begin(), other.end(), heap_.get());
+    } else {
+        heap_.reset();
+        cap_    = 0;
+        inline_ = other.inline_;
+    }
+    rebase(other.text_.data());
+    return *this;
+}
+
+OperandList& OperandList::operator=(OperandList&& other) noexcept {
+    if (this == &other) return *this;
+    const char* from = other.text_.data(); // still readable after the move
+    text_   = std::move(other.text_);
+    inline_ = other.inline_;
+    heap_   = std::move(other.heap_);
+    n_      = std::exchange(other.n_, 0);
+    cap_    = std::exchange(other.cap_, 0);
+    rebase(from);
+    other.text_.clear();
+    return *this;
+}
+
+void OperandList::rebase(const char* from) {
+    if (from == text_.data()) return;
+    for (Operand& o : *this) {
+        o.raw_ = o.len_ ? text_.data() + (o.raw_ - from) : nullptr;
+    }
+}
+
+void OperandList::push_back(Operand op) {
+    const std::less_equal<const char*> le;
+    const bool inText = op.len_ == 0 ||
+        (le(text_.data(), op.raw_) && le(op.raw_ + op.len_, text_.data() + text_.size()));
+    if (!inText) {
+        // Grow into a new buffer so the old one stays readable for rebase()
+        std::string grown;
+        grown.reserve(text_.size() + 2 + op.len_);
+        grown = text_;
+        if (!grown.empty()) grown += ", ";
+        const std::size_t off = grown.size();
+        grown += op.raw();
+        const char* from = text_.data();
+        text_.swap(grown);
+        rebase(from);
+        op.raw_ = text_.data() + off;
+    }
+    if (!heap_ && n_ < kInline) {
+        inline_[n_++] = op;
+        return;
+    }
+    if (!heap_ || n_ == cap_) {
+        // First spill copies the inline operands; later ones double
+        const uint32_t cap = n_ * 2;
+        auto grown = std::make_unique<Operand[]>(cap);
+        std::copy(begin(), end(), grown.get());
+        heap_ = std::move(grown);
+        cap_  = cap;
+    }
+    heap_[n_++] = op;
+}
+
+// Split operands on commas with respect to brackets and {register lists}.
+// The tokens are views into the list's own copy of s.
+static OperandList parseOps(std::string_view text) {
+    OperandList out(text);
+    const std::string_view s = out.text();
+    std::size_t start = 0;
+    std::size_t i = 0;
     int bracket = 0;
-    for (char c : s) {
+    while (true) {
+        const std::size_t hit = scan::findFirstOf(s.substr(i), ",[]{");
+        if (hit == std::string_view::npos) break;
+        i += hit;
+        const char c = s[i];
+        if (c == '{') {
+            const std::size_t close = scan::find(s.substr(i), '}');
+            if (close == std::string_view::npos) break;
+            i += close + 1;
+            continue;
+        }
         if (c == '[') bracket++;
-        if (c == ']') bracket = std::max(0, bracket - 1);
-        if (c == ',' && bracket == 0) {
-            out.push_back(parseOp(cur));
-            cur.clear();
-        } else {
-            cur.push_back(c);
+        else if (c == ']') bracket = std::max(0, bracket - 1);
+        else if (bracket == 0) {
+            out.push_back(parseOp(s.substr(start, i - start)));
+            start = i + 1;
         }
+        ++i;
     }
-    if (!trim(cur).empty()) out.push_back(parseOp(cur));
+    std::string_view tail = s.substr(start);
+    if (!trim(tail).empty()) out.push_back(parseOp(tail));
     return out;
 }
 
 // Handlers for specific instructions from include/parser.hpp now implemented
-DecodedInstruction GenericHandler::parse(const std::string& mnem, const std::vector<Operand>& ops) const {
-    return DecodedInstruction{upper(mnem), ops};
+DecodedInstruction GenericHandler::parse(std::string_view mnem, OperandList&& ops) const {
+    return DecodedInstruction{upper(mnem), std::move(ops)};
 }
 
-DecodedInstruction AddHandler::parse(const std::string& mnem, const std::vector<Operand>& ops) const {
-    if (ops.size() != 3) {
-        throw std::runtime_error("ADD expects 3 operands");
+DecodedInstruction AddHandler::parse(std::string_view mnem, OperandList&& ops) const {
+    if (ops.size() != 3 && !(ops.size() == 4 && ops[3].type == OperandType::Shift)) {
+        throw std::runtime_error("ADD expects 3 operands and an optional shift/extend");
     }
     if (ops[0].type != OperandType::Register || ops[1].type != OperandType::Register) {
         throw std::runtime_error("ADD first two operands must be registers");
@@ -113,12 +285,13 @@ DecodedInstruction AddHandler::parse(const std::string& mnem, const std::vector<
     if (ops[2].type != OperandType::Register && ops[2].type != OperandType::Immediate) {
         throw std::runtime_error("ADD third operand must be register or immediate");
     }
-    return DecodedInstruction{upper(mnem), ops};
+    return DecodedInstruction{upper(mnem), std::move(ops)};
 }
 
-DecodedInstruction LdrHandler::parse(const std::string& mnem, const std::vector<Operand>& ops) const {
-    if (ops.size() < 2 || ops.size() > 2) {
-        throw std::runtime_error("LDR expects 2 operands");
+DecodedInstruction LdrHandler::parse(std::string_view mnem, OperandList&& ops) const {
+    // LDR Rt, [addr] or the post-index form LDR Rt, [Xn], #imm
+    if (ops.size() != 2 && !(ops.size() == 3 && ops[2].type == OperandType::Immediate)) {
+        throw std::runtime_error("LDR expects 2 operands and an optional post-index immediate");
     }
     if (ops[0].type != OperandType::Register) {
         throw std::runtime_error("LDR destination must be a register");
@@ -126,98 +299,130 @@ DecodedInstruction LdrHandler::parse(const std::string& mnem, const std::vector<
     if (ops[1].type != OperandType::Memory) {
         throw std::runtime_error("LDR address must be a memory operand like [Xn{,#imm}]");
     }
-    return DecodedInstruction{upper(mnem), ops};
+    return DecodedInstruction{upper(mnem), std::move(ops)};
 }
 
-// Implemented Parser class methods
-std::optional<DecodedInstruction> Parser::parseLine(const std::string& line) const {
-    std::string s = trim(line);
-    if (s.empty()) return std::nullopt;
+DecodedInstruction CondHandler::parse(std::string_view mnem, OperandList&& ops) const {
+    const CondName* c = ops.empty() ? nullptr : lookupCond(trim(ops[ops.size() - 1].raw()));
+    if (!c) {
+        throw std::runtime_error(upper(mnem) + " expects a condition code as its last operand");
+    }
+    DecodedInstruction d{upper(mnem), std::move(ops)};
+    d.cond = c->cond;
+    return d;
+}
 
-    if (s.rfind("//", 0) == 0 || s[0] == ';') return std::nullopt;
-
-    auto stripInline = [](std::string& t) {
-        bool in_brackets = false;
-        for (size_t i = 0; i < t.size(); ++i) {
-            char c = t[i];
-            if (c == '[') in_brackets = true;
-            else if (c == ']') in_brackets = false;
-            else if (!in_brackets) {
-                if (c == ';') { t = trim(t.substr(0, i)); break; }
-                if (c == '/' && i + 1 < t.size() && t[i+1] == '/') { t = trim(t.substr(0, i)); break; }
+// Handlers are stateless, so one shared instance of each serves every line
+static const GenericHandler kGenericHandler;
+static const AddHandler     kAddHandler;
+static const LdrHandler     kLdrHandler;
+static const CondHandler    kCondHandler;
+
+// Implemented Parser class methods
+std::string_view Parser::instructionText(std::string_view line) const {
+    std::string_view s = trim(line);
+    if (s.empty()) return {};
+
+    if (s.substr(0, 2) == "//" || s[0] == ';') return {};
+
+    // Cut at the first ';' or "//" that is not inside a memory operand.
+    auto stripInline = [](std::string_view& t) {
+        std::size_t i = 0;
+        while (true) {
+            const std::size_t hit = scan::findFirstOf(t.substr(i), ";/[");
+            if (hit == std::string_view::npos) return;
+            i += hit;
+            if (t[i] == '[') {
+                const std::size_t close = scan::find(t.substr(i + 1), ']');
+                if (close == std::string_view::npos) return;
+                i += close + 2;
+            } else if (t[i] == ';' || (i + 1 < t.size() && t[i+1] == '/')) {
+                t = trim(t.substr(0, i));
+                return;
+            } else {
+                ++i;
             }
         }
     };
     stripInline(s);
-    if (s.empty()) return std::nullopt;
+    if (s.empty()) return {};
 
-    auto dropPrefAddr = [](std::string& t) {
-        size_t colon = t.find(':');
-        if (colon == std::string::npos) return;
-        bool all_hex = (colon > 0);
-        for (size_t i = 0; i < colon; ++i) {
-            unsigned char ch = static_cast<unsigned char>(t[i]);
-            if (!std::isxdigit(ch) && !std::isspace(ch)) { all_hex = false; break; }
-        }
-        if (all_hex) t = trim(t.substr(colon + 1));
+    auto dropPrefAddr = [](std::string_view& t) {
+        size_t colon = scan::find(t, ':');
+        if (colon == std::string_view::npos || colon == 0) return;
+        if (scan::spanHexOrSpace(t) >= colon) t = trim(t.substr(colon + 1));
     };
     dropPrefAddr(s);
 
-    auto dropLeadingOpcodeHex = [](std::string& t) {
-        size_t p = 0;
-        while (p < t.size() && !std::isspace(static_cast<unsigned char>(t[p]))) ++p;
-        std::string tok = t.substr(0, p);
-
-        auto is_opcode_hex = [](const std::string& w) -> bool {
-            if (w.size() != 8) return false;
-            for (unsigned char c : w) if (!std::isxdigit(c)) return false;
-            return true;
-        };
-
-        if (is_opcode_hex(tok)) t = trim(t.substr(p));
+    // Exactly 8 hex digits followed by whitespace (or the end) is the opcode word.
+    auto dropLeadingOpcodeHex = [](std::string_view& t) {
+        if (t.size() < 8 || scan::spanHex(t.substr(0, 9)) != 8) return;
+        if (t.size() > 8 && !isSpace(t[8])) return;
+        t = trim(t.substr(8));
     };
     dropLeadingOpcodeHex(s);
+    return s;
+}
 
+std::optional<DecodedInstruction> Parser::parseLine(std::string_view line) const {
+    const std::string_view s = instructionText(line);
     if (s.empty()) return std::nullopt;
 
     // mnemonic + rest
-    std::string mnemonic, rest;
-    {
-        std::istringstream iss(s);
-        iss >> mnemonic;
-        std::getline(iss, rest);
-        rest = trim(rest);
-    }
+    size_t p = 0;
+    while (p < s.size() && !isSpace(s[p])) ++p;
+    const std::string_view mnemonic = s.substr(0, p);
+    const std::string_view rest = trim(s.substr(p));
     if (mnemonic.empty()) return std::nullopt;
 
     // operands
-    auto ops = rest.empty() ? std::vector<Operand>{} : parseOps(rest);
+    OperandList ops = rest.empty() ? OperandList{} : parseOps(rest);
 
     // dispatch
-    std::unique_ptr<InstructionHandler> handler;
-    const std::string up = upper(mnemonic);
-    if (up == "ADD")      handler = std::make_unique<AddHandler>();
-    else if (up == "LDR") handler = std::make_unique<LdrHandler>();
-    else                  handler = std::make_unique<GenericHandler>();
+    const MnemonicInfo* info = lookupMnemonic(mnemonic);
+    Opcode op = info ? info->op : Opcode::Unknown;
+    for (const Operand& o : ops) {
+        if (o.type == OperandType::Vector || o.type == OperandType::VList) {
+            op = vectorForm(op);
+            break;
+        }
+    }
+    // MOV between vector elements and general registers is INS / UMOV
+    if (op == Opcode::VMov && ops.size() == 2) {
+        if (ops[0].type == OperandType::Register)        op = Opcode::Umov;
+        else if (ops[0].raw().find('[') != std::string_view::npos) op = Opcode::Ins;
+    }
+
+    const InstructionHandler* handler = &kGenericHandler;
+    switch (op) {
+        case Opcode::Add: handler = &kAddHandler; break;
+        case Opcode::Ldr: handler = &kLdrHandler; break;
+        default:
+            if (takesCondOperand(op)) handler = &kCondHandler;
+            break;
+    }
 
-    return handler->parse(mnemonic, ops);
+    DecodedInstruction d = handler->parse(mnemonic, std::move(ops));
+    d.op = op;
+    if (!takesCondOperand(op)) d.cond = info ? info->cond : Cond::AL;
+    return d;
 }
 
 
 // Printing, matches sample output in Task 1
-static std::string memArrow(const std::string& memRaw) {
+static std::string memArrow(std::string_view memRaw) {
     if (memRaw.size() < 2 || memRaw.front() != '[' || memRaw.back() != ']') {
-        return memRaw; // if not a bracketed memory form then exit
+        return std::string(memRaw); // if not a bracketed memory form then exit
     }
-    std::string inside = trim(std::string(memRaw.begin() + 1, memRaw.end() - 1));
+    std::string inside(trim(memRaw.substr(1, memRaw.size() - 2)));
 
     // split on first comma (if any exist)
     std::string base = inside;
     std::string off;
     auto comma = inside.find(',');
     if (comma != std::string::npos) {
-        base = trim(inside.substr(0, comma));
-        off  = trim(inside.substr(comma + 1));
+        base = std::string(trim(std::string_view(inside).substr(0, comma)));
+        off  = std::string(trim(std::string_view(inside).substr(comma + 1)));
         if (!off.empty() && off.front() == '#') off.erase(off.begin());
     }
 
@@ -240,9 +445,9 @@ void printDecoded(std::size_t lineNo, const DecodedInstruction& inst) {
 
     for (std::size_t i = 0; i < inst.operands.size(); ++i) {
         const auto& o = inst.operands[i];
-        std::string out = o.raw;
+        std::string out(o.raw());
         if (o.type == OperandType::Memory) {
-            out = memArrow(o.raw);
+            out = memArrow(o.raw());
         }
         std::cout << "Operand #" << (i + 1) << ": " << out << "\n\n";
     }
@@ -0,0 +1,188 @@
+#include "scan.hpp"
+
+#include <cstdint>
+
+// ARM64_NO_SIMD builds the scalar path only (tests/scanTest.cpp)
+#if !defined(ARM64_NO_SIMD)
+  #if defined(__AVX2__)
+    #define ARM64_SCAN_AVX2 1
+  #endif
+  #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define ARM64_SCAN_SSE2 1
+  #endif
+#endif
+
+#if defined(ARM64_SCAN_AVX2) || defined(ARM64_SCAN_SSE2)
+  #include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+  #include <intrin.h>
+#endif
+
+namespace arm64 {
+namespace scan {
+
+/* Scalar classification, also used for the tails of the vector loops */
+
+static bool inSet(char c, std::string_view set) {
+    for (char s : set) if (c == s) return true;
+    return false;
+}
+
+static bool isHexChar(char c) {
+    const char l = static_cast<char>(c | 0x20);
+    return (c >= '0' && c <= '9') || (l >= 'a' && l <= 'f');
+}
+
+static bool isSpaceChar(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+#if defined(ARM64_SCAN_AVX2) || defined(ARM64_SCAN_SSE2)
+static unsigned lowestBit(uint32_t m) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long idx;
+    _BitScanForward(&idx, m);
+    return static_cast<unsigned>(idx);
+#else
+    return static_cast<unsigned>(__builtin_ctz(m));
+#endif
+}
+#endif
+
+/* SSE2: 16 bytes per step */
+
+#if defined(ARM64_SCAN_SSE2)
+struct Set16 {
+    __m128i v[4];
+    int n;
+};
+
+static Set16 makeSet16(std::string_view set) {
+    Set16 s{};
+    s.n = static_cast<int>(set.size());
+    for (int k = 0; k < 4; ++k)
+        s.v[k] = _mm_set1_epi8(set[static_cast<std::size_t>(k < s.n ? k : 0)]);
+    return s;
+}
+
+static uint32_t matchSet16(__m128i c, const Set16& s) {
+    __m128i m = _mm_cmpeq_epi8(c, s.v[0]);
+    if (s.n > 1) m = _mm_or_si128(m, _mm_cmpeq_epi8(c, s.v[1]));
+    if (s.n > 2) m = _mm_or_si128(m, _mm_cmpeq_epi8(c, s.v[2]));
+    if (s.n > 3) m = _mm_or_si128(m, _mm_cmpeq_epi8(c, s.v[3]));
+    return static_cast<uint32_t>(_mm_movemask_epi8(m));
+}
+
+// Bytes in '0'-'9' / 'a'-'f' / 'A'-'F'. Bytes >= 0x80 compare as negative and
+// therefore never classify as hex.
+static uint32_t hexMask16(__m128i c) {
+    const __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+    const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+                                        _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+    const __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                        _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(digit, alpha)));
+}
+
+static uint32_t spaceMask16(__m128i c) {
+    const __m128i sp = _mm_cmpeq_epi8(c, _mm_set1_epi8(' '));
+    const __m128i ctl = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('\t' - 1)),
+                                      _mm_cmplt_epi8(c, _mm_set1_epi8('\r' + 1)));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(sp, ctl)));
+}
+#endif
+
+/* AVX2: 32 bytes per step, only for the bulk of long inputs (whole buffers) */
+
+#if defined(ARM64_SCAN_AVX2)
+static uint32_t matchSet32(__m256i c, std::string_view set) {
+    __m256i m = _mm256_cmpeq_epi8(c, _mm256_set1_epi8(set[0]));
+    for (std::size_t k = 1; k < set.size(); ++k)
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi8(c, _mm256_set1_epi8(set[k])));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(m));
+}
+#endif
+
+std::size_t findFirstOf(std::string_view s, std::string_view set) {
+    // The vector paths compare against at most four bytes; larger sets are
+    // rare enough to take the library scan
+    if (set.size() > 4) return s.find_first_of(set);
+    if (set.empty()) return std::string_view::npos;
+    const char* p = s.data();
+    const std::size_t n = s.size();
+    std::size_t i = 0;
+
+#if defined(ARM64_SCAN_AVX2)
+    for (; i + 32 <= n; i += 32) {
+        const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const uint32_t m = matchSet32(c, set);
+        if (m) return i + lowestBit(m);
+    }
+#endif
+
+#if defined(ARM64_SCAN_SSE2)
+    if (n >= 16) {
+        const Set16 vs = makeSet16(set);
+        for (; i + 16 <= n; i += 16) {
+            const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            const uint32_t m = matchSet16(c, vs);
+            if (m) return i + lowestBit(m);
+        }
+        if (i < n) {
+            // Overlapping final load; drop the bytes already scanned.
+            const std::size_t start = n - 16;
+            const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + start));
+            const uint32_t m = matchSet16(c, vs) >> (i - start);
+            return m ? i + lowestBit(m) : std::string_view::npos;
+        }
+        return std::string_view::npos;
+    }
+#endif
+
+    for (; i < n; ++i) if (inSet(p[i], set)) return i;
+    return std::string_view::npos;
+}
+
+std::size_t spanHex(std::string_view s) {
+    const char* p = s.data();
+    const std::size_t n = s.size();
+    std::size_t i = 0;
+#if defined(ARM64_SCAN_SSE2)
+    for (; i + 16 <= n; i += 16) {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const uint32_t miss = ~hexMask16(c) & 0xFFFFu;
+        if (miss) return i + lowestBit(miss);
+    }
+#endif
+    while (i < n && isHexChar(p[i])) ++i;
+    return i;
+}
+
+std::size_t spanHexOrSpace(std::string_view s) {
+    const char* p = s.data();
+    const std::size_t n = s.size();
+    std::size_t i = 0;
+#if defined(ARM64_SCAN_SSE2)
+    for (; i + 16 <= n; i += 16) {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const uint32_t miss = ~(hexMask16(c) | spaceMask16(c)) & 0xFFFFu;
+        if (miss) return i + lowestBit(miss);
+    }
+#endif
+    while (i < n && (isHexChar(p[i]) || isSpaceChar(p[i]))) ++i;
+    return i;
+}
+
+const char* backend() {
+#if defined(ARM64_SCAN_AVX2)
+    return "avx2";
+#elif defined(ARM64_SCAN_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace scan
+} // namespace arm64
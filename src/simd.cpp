@@ -0,0 +1,176 @@
+#include "simd.hpp"
+
+// ARM64_NO_SIMD builds the scalar path only (tests/simdLanesTest.cpp)
+#if !defined(ARM64_NO_SIMD)
+  #if defined(__SSE4_1__) || defined(__AVX__)
+    #define ARM64_SIMD_SSE41 1
+  #endif
+  #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define ARM64_SIMD_SSE2 1
+  #endif
+#endif
+
+#if defined(ARM64_SIMD_SSE2)
+  #include <immintrin.h>
+#endif
+
+namespace arm64 {
+namespace simd {
+
+/* Scalar lanes: the fallback, and the reference the vector paths match */
+
+static uint64_t laneMask(unsigned esz) {
+    return esz >= 3 ? ~0ull : (1ull << (8u << esz)) - 1;
+}
+
+[[maybe_unused]] static void binaryScalar(BinOp op, unsigned esz, VReg& d, const VReg& a, const VReg& b) {
+    const unsigned lanes = 16u >> esz;
+    const uint64_t m = laneMask(esz);
+    VReg r;
+    for (unsigned i = 0; i < lanes; ++i) {
+        const uint64_t x = a.lane(esz, i), y = b.lane(esz, i);
+        uint64_t v = 0;
+        switch (op) {
+        case BinOp::Add:  v = x + y; break;
+        case BinOp::Sub:  v = x - y; break;
+        case BinOp::Mul:  v = x * y; break;
+        case BinOp::And:  v = x & y; break;
+        case BinOp::Orr:  v = x | y; break;
+        case BinOp::Eor:  v = x ^ y; break;
+        case BinOp::Cmeq: v = (x == y) ? m : 0; break;
+        }
+        r.setLane(esz, i, v & m);
+    }
+    d = r;
+}
+
+/* SSE2 / SSE4.1: one 128-bit operation per instruction */
+
+#if defined(ARM64_SIMD_SSE2)
+static __m128i load(const VReg& v) { return _mm_load_si128(reinterpret_cast<const __m128i*>(v.b)); }
+static void store(VReg& v, __m128i x) { _mm_store_si128(reinterpret_cast<__m128i*>(v.b), x); }
+
+static __m128i mul(unsigned esz, __m128i a, __m128i b) {
+    switch (esz) {
+    case 0: {
+        // No 8-bit multiply: even and odd bytes through 16-bit lanes
+        const __m128i even = _mm_mullo_epi16(a, b);
+        const __m128i odd  = _mm_mullo_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+        return _mm_or_si128(_mm_and_si128(even, _mm_set1_epi16(0xFF)), _mm_slli_epi16(odd, 8));
+    }
+    case 1:
+        return _mm_mullo_epi16(a, b);
+    default: {
+#if defined(ARM64_SIMD_SSE41)
+        return _mm_mullo_epi32(a, b);
+#else
+        // Lanes 0/2 and 1/3 through the 32x32->64 multiply, low halves re-interleaved
+        const __m128i even = _mm_mul_epu32(a, b);
+        const __m128i odd  = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, 0x08), _mm_shuffle_epi32(odd, 0x08));
+#endif
+    }
+    }
+}
+
+static __m128i cmpeq(unsigned esz, __m128i a, __m128i b) {
+    switch (esz) {
+    case 0: return _mm_cmpeq_epi8(a, b);
+    case 1: return _mm_cmpeq_epi16(a, b);
+    case 2: return _mm_cmpeq_epi32(a, b);
+    default: {
+#if defined(ARM64_SIMD_SSE41)
+        return _mm_cmpeq_epi64(a, b);
+#else
+        // Both 32-bit halves equal
+        const __m128i t = _mm_cmpeq_epi32(a, b);
+        return _mm_and_si128(t, _mm_shuffle_epi32(t, 0xB1));
+#endif
+    }
+    }
+}
+#endif
+
+void binary(BinOp op, unsigned esz, VReg& d, const VReg& a, const VReg& b) {
+#if defined(ARM64_SIMD_SSE2)
+    const __m128i x = load(a), y = load(b);
+    __m128i r;
+    switch (op) {
+    case BinOp::Add:
+        r = esz == 0 ? _mm_add_epi8(x, y) : esz == 1 ? _mm_add_epi16(x, y)
+          : esz == 2 ? _mm_add_epi32(x, y) : _mm_add_epi64(x, y);
+        break;
+    case BinOp::Sub:
+        r = esz == 0 ? _mm_sub_epi8(x, y) : esz == 1 ? _mm_sub_epi16(x, y)
+          : esz == 2 ? _mm_sub_epi32(x, y) : _mm_sub_epi64(x, y);
+        break;
+    case BinOp::Mul:
+        if (esz >= 3) { binaryScalar(op, esz, d, a, b); return; }
+        r = mul(esz, x, y);
+        break;
+    case BinOp::And:  r = _mm_and_si128(x, y); break;
+    case BinOp::Orr:  r = _mm_or_si128(x, y);  break;
+    case BinOp::Eor:  r = _mm_xor_si128(x, y); break;
+    default:          r = cmpeq(esz, x, y);    break;
+    }
+    store(d, r);
+#else
+    binaryScalar(op, esz, d, a, b);
+#endif
+}
+
+uint64_t addAcross(unsigned esz, const VReg& a, bool q) {
+#if defined(ARM64_SIMD_SSE2)
+    __m128i x = load(a);
+    if (!q) x = _mm_move_epi64(x); // zero the top half
+    switch (esz) {
+    case 0: {
+        const __m128i s = _mm_sad_epu8(x, _mm_setzero_si128()); // one sum per 64-bit half
+        return static_cast<uint64_t>(_mm_cvtsi128_si32(_mm_add_epi64(s, _mm_srli_si128(s, 8)))) & 0xFF;
+    }
+    case 1:
+        x = _mm_add_epi16(x, _mm_srli_si128(x, 8));
+        x = _mm_add_epi16(x, _mm_srli_si128(x, 4));
+        x = _mm_add_epi16(x, _mm_srli_si128(x, 2));
+        return static_cast<uint64_t>(_mm_cvtsi128_si32(x)) & 0xFFFF;
+    case 2:
+        x = _mm_add_epi32(x, _mm_srli_si128(x, 8));
+        x = _mm_add_epi32(x, _mm_srli_si128(x, 4));
+        return static_cast<uint32_t>(_mm_cvtsi128_si32(x));
+    default:
+        break;
+    }
+#endif
+    const unsigned lanes = (q ? 16u : 8u) >> esz;
+    uint64_t sum = 0;
+    for (unsigned i = 0; i < lanes; ++i) sum += a.lane(esz, i);
+    return sum & laneMask(esz);
+}
+
+void dup(unsigned esz, VReg& d, uint64_t v) {
+#if defined(ARM64_SIMD_SSE2)
+    __m128i r;
+    switch (esz) {
+    case 0:  r = _mm_set1_epi8(static_cast<char>(v)); break;
+    case 1:  r = _mm_set1_epi16(static_cast<short>(v)); break;
+    case 2:  r = _mm_set1_epi32(static_cast<int>(v)); break;
+    default: r = _mm_set1_epi64x(static_cast<long long>(v)); break;
+    }
+    store(d, r);
+#else
+    for (unsigned i = 0; i < (16u >> esz); ++i) d.setLane(esz, i, v);
+#endif
+}
+
+const char* backend() {
+#if defined(ARM64_SIMD_SSE41)
+    return "sse4.1";
+#elif defined(ARM64_SIMD_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace simd
+} // namespace arm64
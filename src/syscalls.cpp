@@ -0,0 +1,132 @@
+#include "syscalls.hpp"
+#include "memory.hpp"
+
+#include <chrono>
+#include <iostream>
+
+#if defined(_WIN32)
+  #include <io.h>
+#else
+  #include <unistd.h>
+#endif
+
+namespace arm64 {
+
+// errno values of the Linux ABI (not the host's)
+static constexpr int64_t kEbadf  = 9;
+static constexpr int64_t kEnomem = 12;
+static constexpr int64_t kEfault = 14;
+static constexpr int64_t kEinval = 22;
+static constexpr int64_t kEnosys = 38;
+
+static constexpr uint64_t kMapFixed     = 0x10;
+static constexpr uint64_t kMapAnonymous = 0x20;
+
+static uint64_t fail(int64_t err) { return static_cast<uint64_t>(-err); }
+
+// Host pointer to guest [addr, addr + len), or nullptr when any of it lies
+// outside the stack and the guest heap.
+static uint8_t* guestSpan(Stack& stack, Memory* mem, uint64_t addr, uint64_t len) {
+    if (addr >= stack.base() && addr - stack.base() <= stack.size() && len <= stack.size() - (addr - stack.base()))
+        return stack.data() + (addr - stack.base());
+    return mem ? mem->translate(addr, len) : nullptr;
+}
+
+static uint64_t hostWrite(int fd, const uint8_t* buf, uint64_t len) {
+    // Keep guest output in order with the executor's own buffered output
+    if (fd == 1) std::cout.flush();
+    else         std::cerr.flush();
+#if defined(_WIN32)
+    const int n = _write(fd, buf, static_cast<unsigned>(len));
+#else
+    const ssize_t n = ::write(fd, buf, static_cast<std::size_t>(len));
+#endif
+    return n < 0 ? fail(kEbadf) : static_cast<uint64_t>(n);
+}
+
+static uint64_t hostRead(int fd, uint8_t* buf, uint64_t len) {
+#if defined(_WIN32)
+    const int n = _read(fd, buf, static_cast<unsigned>(len));
+#else
+    const ssize_t n = ::read(fd, buf, static_cast<std::size_t>(len));
+#endif
+    return n < 0 ? fail(kEbadf) : static_cast<uint64_t>(n);
+}
+
+static uint64_t clockGettime(Stack& stack, Memory* mem, uint64_t clockId, uint64_t tp) {
+    uint8_t* out = guestSpan(stack, mem, tp, 16);
+    if (!out) return fail(kEfault);
+
+    // CLOCK_REALTIME (0) is wall time; the monotonic and CPU-time clocks all
+    // map to the host's steady clock.
+    std::chrono::nanoseconds ns;
+    if (clockId == 0)
+        ns = std::chrono::system_clock::now().time_since_epoch();
+    else if (clockId <= 7)
+        ns = std::chrono::steady_clock::now().time_since_epoch();
+    else
+        return fail(kEinval);
+
+    const uint64_t count = static_cast<uint64_t>(ns.count());
+    const uint64_t ts[2] = {count / 1000000000u, count % 1000000000u}; // tv_sec, tv_nsec
+    for (int i = 0; i < 16; ++i)
+        out[i] = static_cast<uint8_t>(ts[i / 8] >> (8 * (i % 8)));
+    return 0;
+}
+
+bool emulateSyscall(Registers& regs, Stack& stack, ExecState& st) {
+    const uint64_t nr = regs.get(8);
+    const uint64_t a0 = regs.get(0), a1 = regs.get(1), a2 = regs.get(2);
+    uint64_t ret = 0;
+
+    switch (nr) {
+    case sys::kWrite: case sys::kRead: {
+        if (a0 > 2) { ret = fail(kEbadf); break; }
+        uint8_t* buf = guestSpan(stack, st.memory, a1, a2);
+        if (!buf) { ret = fail(kEfault); break; }
+        if (a2 == 0) break;
+        ret = nr == sys::kWrite ? hostWrite(static_cast<int>(a0), buf, a2)
+                                : hostRead(static_cast<int>(a0), buf, a2);
+        break;
+    }
+
+    case sys::kExit: case sys::kExitGroup:
+        st.exited = true;
+        st.exitCode = static_cast<int>(a0 & 0xFF);
+        return false;
+
+    case sys::kClockGettime:
+        ret = clockGettime(stack, st.memory, a0, a1);
+        break;
+
+    // Failure is reported by returning the current break
+    case sys::kBrk:
+        ret = st.memory ? st.memory->brk(a0) : stack.base() + stack.size();
+        break;
+
+    // mmap(addr, len, prot, flags, fd, off): anonymous private mappings only;
+    // addr is a hint and is ignored, every mapping is readable and writable.
+    case sys::kMmap: {
+        const uint64_t flags = regs.get(3);
+        if (!(flags & kMapAnonymous)) { ret = fail(kEbadf); break; }
+        if ((flags & kMapFixed) || a1 == 0) { ret = fail(kEinval); break; }
+        const uint64_t addr = st.memory ? st.memory->mmap(a1) : 0;
+        ret = addr ? addr : fail(kEnomem);
+        break;
+    }
+
+    case sys::kMunmap:
+        if (!st.memory) ret = fail(kEinval);
+        else            ret = st.memory->munmap(a0, a1) ? 0 : fail(kEinval);
+        break;
+
+    default:
+        ret = fail(kEnosys);
+        break;
+    }
+
+    regs.set(0, ret);
+    return true;
+}
+
+} // namespace arm64
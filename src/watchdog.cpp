@@ -0,0 +1,45 @@
+#include "watchdog.hpp"
+
+namespace arm64 {
+
+const char* stopReasonName(StopReason r) {
+    switch (r) {
+    case StopReason::End:       return "end";
+    case StopReason::Halt:      return "halt";
+    case StopReason::Exit:      return "exit";
+    case StopReason::StepLimit: return "step-limit";
+    case StopReason::Timeout:   return "timeout";
+    case StopReason::BadPc:     return "bad-pc";
+    case StopReason::Breakpoint: return "breakpoint";
+    case StopReason::Error:     return "error";
+    }
+    return "unknown";
+}
+
+int stopReasonStatus(StopReason r) {
+    switch (r) {
+    case StopReason::StepLimit: return 3;
+    case StopReason::Timeout:   return 4;
+    case StopReason::BadPc:     return 5;
+    case StopReason::Error:     return 2;
+    default:                    return 0;
+    }
+}
+
+Watchdog::Watchdog(std::chrono::milliseconds timeout)
+    : thread_([this, timeout] {
+          std::unique_lock<std::mutex> lock(mutex_);
+          if (!wake_.wait_for(lock, timeout, [this] { return cancelled_; }))
+              expired_.store(true, std::memory_order_relaxed);
+      }) {}
+
+Watchdog::~Watchdog() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+} // namespace arm64
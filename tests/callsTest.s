@@ -0,0 +1,99 @@
+// Calls test: BL/RET with a recursive function, BLR/BR through registers,
+// CBZ/CBNZ and TBZ/TBNZ on X and W registers
+//
+// Run:      ./build/executor tests/callsTest.s --quiet --dump-regs --dump-stack
+// Expected: "Testing Output/callsOutput.txt" (ctest: calls)
+//
+// Expected final state:
+//   X19 = 120                  ; factorial(5) through nested BL/RET
+//   X20 = 42                   ; BLR to triple(14)
+//   X21 = 0x1C                 ; X30 after BLR: the MOV X20 that follows it
+//   X22 = 0x600D               ; BR skipped the MOV X22, #0xBAD
+//   X23 = 2                    ; CBZ W1 taken although X1 = 1 << 32
+//   X24 = 0x7B                 ; every TBZ/TBNZ went the right way
+//   X25 = 0                    ; "wrong" never ran
+//   PC  = 0x84                 ; the RET from the entry function halts
+// Stack (base 0x0): the frames of factorial(5)..factorial(2) below 0xc0:
+//   [0x80] = 2    [0x90] = 3    [0xa0] = 4    each with return address 0xAC
+//   [0xb0] = 5    [0xb8] = 0xC, the return address after "BL factorial" in start
+
+start:
+  SUB SP, SP, #0x40
+
+  // Recursive factorial through BL/RET, saving X30 in a frame per call
+  MOV X0, #5
+  BL factorial                // X0 = 120
+  MOV X19, X0
+
+  // BLR through a register holding the address of "triple"
+  MOV X0, #14
+  MOV X9, #0xc8
+  BLR X9                      // X0 = 42, X30 = the instruction after BLR
+  MOV X20, X0
+  MOV X21, X30
+
+  // BR: a jump with no link; X30 is left as BLR set it
+  MOV X10, #0x30
+  BR X10
+  MOV X22, #0xBAD             // skipped
+landing:
+  MOV X22, #0x600D
+
+  // CBZ/CBNZ on W registers look at the low 32 bits only
+  MOV X1, #0x100000000        // W1 = 0
+  MOV X23, #0
+  CBZ W1, cbz_w_taken
+  MOV X23, #0xBAD
+cbz_w_taken:
+  CBNZ X1, cbnz_x_taken       // X1 != 0
+  MOV X23, #0xBAD
+cbnz_x_taken:
+  ADD X23, X23, #1            // X23 = 1
+  CBNZ W1, wrong
+  ADD X23, X23, #1            // X23 = 2
+
+  // TBZ/TBNZ on bit 63, bit 31 of a W register and bit 0
+  MOV X2, #0x8000000000000001
+  TBNZ X2, #63, tb_high
+  B wrong
+tb_high:
+  TBZ X2, #62, tb_clear
+  B wrong
+tb_clear:
+  TBNZ W2, #0, tb_low
+  B wrong
+tb_low:
+  TBZ W2, #31, tb_done        // bit 31 of W2 is clear
+  B wrong
+tb_done:
+  MOV X24, #0x7B
+
+  ADD SP, SP, #0x40
+  RET                         // no call outstanding: halts here (--ret=entry)
+
+wrong:
+  MOV X25, #0xBAD
+  RET
+
+// X0 = X0! ; frame: [SP] = saved X0, [SP, #8] = saved X30
+factorial:
+  CMP X0, #1
+  B.LS factorial_base
+  SUB SP, SP, #16
+  STR X0, [SP]
+  STR X30, [SP, #8]
+  SUB X0, X0, #1
+  BL factorial
+  LDR X1, [SP]
+  LDR X30, [SP, #8]
+  ADD SP, SP, #16
+  MUL X0, X0, X1
+  RET
+factorial_base:
+  MOV X0, #1
+  RET
+
+// X0 = 3 * X0, a leaf
+triple:
+  ADD X0, X0, X0, LSL #1
+  RET
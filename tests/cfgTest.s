@@ -0,0 +1,46 @@
+// Control-flow graph test: a call, a loop nest and an if/else inside the
+// inner loop, exported as DOT with block counts from a profiled run
+//
+// Run:      ./build/executor tests/cfgTest.s --quiet --dump-regs --profile --cfg=cfg.dot
+// Expected: "Testing Output/cfgOutput.txt" (ctest: cfg)
+// Run:      ./build/executor tests/cfgTest.s --quiet --cfg=cfg.json
+// Expected: "Testing Output/cfgJsonOutput.txt" (ctest: cfgJson, the same graph as JSON)
+//
+// The graph file is appended to the tool's output in the expected files.
+//
+// Expected graph: blocks at 0x0 (entry), 0x8 (outer header), 0xc (inner
+// header), 0x14 (odd), 0x1c (even), 0x20 (inner latch), 0x28 (outer latch),
+// 0x30 (call site), 0x3c (return site), 0x40 (double) and 0x48 (exit); back
+// edges 0x20 -> 0xc (depth 2) and 0x28 -> 0x8 (depth 1); a call edge
+// 0x30 -> 0x40 and its return edge to 0x3c. Counts: the inner blocks run 12
+// times, odd and even 6 each.
+//
+// Expected final state: X2 = 3 * (8 + 3 + 4 + 1) = 0x30 and X0 = 0x60 after
+// double.
+
+start:
+  MOV X2, #0
+  MOV X3, #3
+outer:
+  MOV X4, #4
+inner:
+  TST X4, #1
+  B.EQ even
+  ADD X2, X2, X4
+  B next
+even:
+  ADD X2, X2, X4, LSL #1
+next:
+  SUB X4, X4, #1
+  CBNZ X4, inner
+  SUB X3, X3, #1
+  CBNZ X3, outer
+  NOP
+  MOV X0, X2
+  BL double
+  B finish
+double:
+  ADD X0, X0, X0
+  RET
+finish:
+  NOP
@@ -0,0 +1,384 @@
+// Conditions test: all fourteen condition codes over SUBS/ADDS/ANDS/CCMP
+// flags, and the conditional select family
+//
+// Run:      ./build/executor tests/conditionsTest.s --quiet --dump-regs --dump-stack
+// Expected: "Testing Output/conditionsOutput.txt" (ctest: conditions)
+//
+// Each stack line 0x60..0xf0 holds one flag state: bytes 0-13 are CSET of
+// EQ NE CS CC MI PL VS VC HI LS GE LT GT LE, in that order.
+//   00000060 01 00 01 00 00 01 00 01 00 01 01 00 00 01 00 00   CMP X0, X1 with 5, 5
+//   00000070 00 01 00 01 01 00 00 01 00 01 00 01 00 01 00 00   CMP X0, X1 with 1, 2
+//   00000080 00 01 00 01 01 00 01 00 00 01 01 00 01 00 00 00   CMP W0, W1 with 0x7fffffff, -1: signed overflow
+//   00000090 01 00 01 00 00 01 00 01 00 01 01 00 00 01 00 00   CMN X0, #1 with -1: carry out, zero
+//   000000a0 00 01 00 01 01 00 00 01 00 01 00 01 00 01 00 00   TST W0, #0x80000000: N only
+//   000000b0 00 01 01 00 00 01 01 00 01 00 00 01 00 01 00 00   CMP X0, #1 with INT64_MIN: signed overflow
+//   000000c0 00 01 00 01 01 00 00 01 00 01 00 01 00 01 00 00   CCMP taken: EQ holds, so flags of 3 - 7
+//   000000d0 00 01 01 00 00 01 00 01 01 00 01 00 01 00 00 00   CCMP not taken: NE fails, so NZCV = #2 (C)
+//   000000e0 01 00 01 00 00 01 00 01 00 01 01 00 00 01 00 00   CCMN taken: -7 + 7
+//   000000f0 00 01 00 01 01 00 01 00 00 01 01 00 01 00 00 00   MSR NZCV: N and V
+//
+// Conditional selects, after CMP 5, 5 (EQ) with X2 = 3 and X3 = 7:
+//   X10 = 0x0000000000000003   (CSEL X10, X2, X3, EQ)
+//   X11 = 0x0000000000000007   (CSEL X11, X2, X3, NE)
+//   X12 = 0x0000000000000008   (CSINC X12, X2, X3, NE)
+//   X13 = 0xFFFFFFFFFFFFFFF8   (CSINV X13, X2, X3, NE)
+//   X14 = 0xFFFFFFFFFFFFFFF9   (CSNEG X14, X2, X3, NE)
+//   X15 = 0x0000000000000004   (CINC X15, X2, EQ)
+//   W16 = 0x00000000FFFFFFFC   (CINV W16, W2, EQ)
+//   X17 = 0xFFFFFFFFFFFFFFFD   (CNEG X17, X2, EQ)
+//   X18 = 0xFFFFFFFFFFFFFFFF   (CSETM X18, EQ)
+//   W19 = 0x00000000FFFFFFFF   (CSETM W19, EQ)
+//   W20 = 0x00000000FFFFFFF9   (CSNEG W20, W2, W3, NE)
+//   X21 = 0x0000000000000003   (CSEL X21, X2, X3, AL)
+//   X22 = 0x0000000000000003   (CSEL X22, X2, X3, NV)
+
+start:
+  SUB SP, SP, #0xa0
+
+  // CMP X0, X1 with 5, 5
+  MOV X0, #5
+  MOV X1, #5
+  CMP X0, X1
+  CSET W9, EQ
+  STRB W9, [SP, #0]
+  CSET W9, NE
+  STRB W9, [SP, #1]
+  CSET W9, CS
+  STRB W9, [SP, #2]
+  CSET W9, CC
+  STRB W9, [SP, #3]
+  CSET W9, MI
+  STRB W9, [SP, #4]
+  CSET W9, PL
+  STRB W9, [SP, #5]
+  CSET W9, VS
+  STRB W9, [SP, #6]
+  CSET W9, VC
+  STRB W9, [SP, #7]
+  CSET W9, HI
+  STRB W9, [SP, #8]
+  CSET W9, LS
+  STRB W9, [SP, #9]
+  CSET W9, GE
+  STRB W9, [SP, #10]
+  CSET W9, LT
+  STRB W9, [SP, #11]
+  CSET W9, GT
+  STRB W9, [SP, #12]
+  CSET W9, LE
+  STRB W9, [SP, #13]
+
+  // CMP X0, X1 with 1, 2
+  MOV X0, #1
+  MOV X1, #2
+  CMP X0, X1
+  CSET W9, EQ
+  STRB W9, [SP, #16]
+  CSET W9, NE
+  STRB W9, [SP, #17]
+  CSET W9, CS
+  STRB W9, [SP, #18]
+  CSET W9, CC
+  STRB W9, [SP, #19]
+  CSET W9, MI
+  STRB W9, [SP, #20]
+  CSET W9, PL
+  STRB W9, [SP, #21]
+  CSET W9, VS
+  STRB W9, [SP, #22]
+  CSET W9, VC
+  STRB W9, [SP, #23]
+  CSET W9, HI
+  STRB W9, [SP, #24]
+  CSET W9, LS
+  STRB W9, [SP, #25]
+  CSET W9, GE
+  STRB W9, [SP, #26]
+  CSET W9, LT
+  STRB W9, [SP, #27]
+  CSET W9, GT
+  STRB W9, [SP, #28]
+  CSET W9, LE
+  STRB W9, [SP, #29]
+
+  // CMP W0, W1 with 0x7fffffff, -1: signed overflow
+  MOV W0, #0X7FFFFFFF
+  MOV W1, #0XFFFFFFFF
+  CMP W0, W1
+  CSET W9, EQ
+  STRB W9, [SP, #32]
+  CSET W9, NE
+  STRB W9, [SP, #33]
+  CSET W9, CS
+  STRB W9, [SP, #34]
+  CSET W9, CC
+  STRB W9, [SP, #35]
+  CSET W9, MI
+  STRB W9, [SP, #36]
+  CSET W9, PL
+  STRB W9, [SP, #37]
+  CSET W9, VS
+  STRB W9, [SP, #38]
+  CSET W9, VC
+  STRB W9, [SP, #39]
+  CSET W9, HI
+  STRB W9, [SP, #40]
+  CSET W9, LS
+  STRB W9, [SP, #41]
+  CSET W9, GE
+  STRB W9, [SP, #42]
+  CSET W9, LT
+  STRB W9, [SP, #43]
+  CSET W9, GT
+  STRB W9, [SP, #44]
+  CSET W9, LE
+  STRB W9, [SP, #45]
+
+  // CMN X0, #1 with -1: carry out, zero
+  MOV X0, #-1
+  CMN X0, #1
+  CSET W9, EQ
+  STRB W9, [SP, #48]
+  CSET W9, NE
+  STRB W9, [SP, #49]
+  CSET W9, CS
+  STRB W9, [SP, #50]
+  CSET W9, CC
+  STRB W9, [SP, #51]
+  CSET W9, MI
+  STRB W9, [SP, #52]
+  CSET W9, PL
+  STRB W9, [SP, #53]
+  CSET W9, VS
+  STRB W9, [SP, #54]
+  CSET W9, VC
+  STRB W9, [SP, #55]
+  CSET W9, HI
+  STRB W9, [SP, #56]
+  CSET W9, LS
+  STRB W9, [SP, #57]
+  CSET W9, GE
+  STRB W9, [SP, #58]
+  CSET W9, LT
+  STRB W9, [SP, #59]
+  CSET W9, GT
+  STRB W9, [SP, #60]
+  CSET W9, LE
+  STRB W9, [SP, #61]
+
+  // TST W0, #0x80000000: N only
+  MOV W0, #0X80000000
+  TST W0, #0X80000000
+  CSET W9, EQ
+  STRB W9, [SP, #64]
+  CSET W9, NE
+  STRB W9, [SP, #65]
+  CSET W9, CS
+  STRB W9, [SP, #66]
+  CSET W9, CC
+  STRB W9, [SP, #67]
+  CSET W9, MI
+  STRB W9, [SP, #68]
+  CSET W9, PL
+  STRB W9, [SP, #69]
+  CSET W9, VS
+  STRB W9, [SP, #70]
+  CSET W9, VC
+  STRB W9, [SP, #71]
+  CSET W9, HI
+  STRB W9, [SP, #72]
+  CSET W9, LS
+  STRB W9, [SP, #73]
+  CSET W9, GE
+  STRB W9, [SP, #74]
+  CSET W9, LT
+  STRB W9, [SP, #75]
+  CSET W9, GT
+  STRB W9, [SP, #76]
+  CSET W9, LE
+  STRB W9, [SP, #77]
+
+  // CMP X0, #1 with INT64_MIN: signed overflow
+  MOV X0, #0X8000000000000000
+  CMP X0, #1
+  CSET W9, EQ
+  STRB W9, [SP, #80]
+  CSET W9, NE
+  STRB W9, [SP, #81]
+  CSET W9, CS
+  STRB W9, [SP, #82]
+  CSET W9, CC
+  STRB W9, [SP, #83]
+  CSET W9, MI
+  STRB W9, [SP, #84]
+  CSET W9, PL
+  STRB W9, [SP, #85]
+  CSET W9, VS
+  STRB W9, [SP, #86]
+  CSET W9, VC
+  STRB W9, [SP, #87]
+  CSET W9, HI
+  STRB W9, [SP, #88]
+  CSET W9, LS
+  STRB W9, [SP, #89]
+  CSET W9, GE
+  STRB W9, [SP, #90]
+  CSET W9, LT
+  STRB W9, [SP, #91]
+  CSET W9, GT
+  STRB W9, [SP, #92]
+  CSET W9, LE
+  STRB W9, [SP, #93]
+
+  // CCMP taken: EQ holds, so flags of 3 - 7
+  MOV X0, #5
+  MOV X1, #5
+  MOV X2, #3
+  MOV X3, #7
+  CMP X0, X1
+  CCMP X2, X3, #0, EQ
+  CSET W9, EQ
+  STRB W9, [SP, #96]
+  CSET W9, NE
+  STRB W9, [SP, #97]
+  CSET W9, CS
+  STRB W9, [SP, #98]
+  CSET W9, CC
+  STRB W9, [SP, #99]
+  CSET W9, MI
+  STRB W9, [SP, #100]
+  CSET W9, PL
+  STRB W9, [SP, #101]
+  CSET W9, VS
+  STRB W9, [SP, #102]
+  CSET W9, VC
+  STRB W9, [SP, #103]
+  CSET W9, HI
+  STRB W9, [SP, #104]
+  CSET W9, LS
+  STRB W9, [SP, #105]
+  CSET W9, GE
+  STRB W9, [SP, #106]
+  CSET W9, LT
+  STRB W9, [SP, #107]
+  CSET W9, GT
+  STRB W9, [SP, #108]
+  CSET W9, LE
+  STRB W9, [SP, #109]
+
+  // CCMP not taken: NE fails, so NZCV = #2 (C)
+  CMP X0, X1
+  CCMP X2, X3, #2, NE
+  CSET W9, EQ
+  STRB W9, [SP, #112]
+  CSET W9, NE
+  STRB W9, [SP, #113]
+  CSET W9, CS
+  STRB W9, [SP, #114]
+  CSET W9, CC
+  STRB W9, [SP, #115]
+  CSET W9, MI
+  STRB W9, [SP, #116]
+  CSET W9, PL
+  STRB W9, [SP, #117]
+  CSET W9, VS
+  STRB W9, [SP, #118]
+  CSET W9, VC
+  STRB W9, [SP, #119]
+  CSET W9, HI
+  STRB W9, [SP, #120]
+  CSET W9, LS
+  STRB W9, [SP, #121]
+  CSET W9, GE
+  STRB W9, [SP, #122]
+  CSET W9, LT
+  STRB W9, [SP, #123]
+  CSET W9, GT
+  STRB W9, [SP, #124]
+  CSET W9, LE
+  STRB W9, [SP, #125]
+
+  // CCMN taken: -7 + 7
+  MOV X4, #-7
+  CMP X2, X3
+  CCMN X4, #7, #8, NE
+  CSET W9, EQ
+  STRB W9, [SP, #128]
+  CSET W9, NE
+  STRB W9, [SP, #129]
+  CSET W9, CS
+  STRB W9, [SP, #130]
+  CSET W9, CC
+  STRB W9, [SP, #131]
+  CSET W9, MI
+  STRB W9, [SP, #132]
+  CSET W9, PL
+  STRB W9, [SP, #133]
+  CSET W9, VS
+  STRB W9, [SP, #134]
+  CSET W9, VC
+  STRB W9, [SP, #135]
+  CSET W9, HI
+  STRB W9, [SP, #136]
+  CSET W9, LS
+  STRB W9, [SP, #137]
+  CSET W9, GE
+  STRB W9, [SP, #138]
+  CSET W9, LT
+  STRB W9, [SP, #139]
+  CSET W9, GT
+  STRB W9, [SP, #140]
+  CSET W9, LE
+  STRB W9, [SP, #141]
+
+  // MSR NZCV: N and V
+  MOV X9, #0X90000000
+  MSR NZCV, X9
+  CSET W9, EQ
+  STRB W9, [SP, #144]
+  CSET W9, NE
+  STRB W9, [SP, #145]
+  CSET W9, CS
+  STRB W9, [SP, #146]
+  CSET W9, CC
+  STRB W9, [SP, #147]
+  CSET W9, MI
+  STRB W9, [SP, #148]
+  CSET W9, PL
+  STRB W9, [SP, #149]
+  CSET W9, VS
+  STRB W9, [SP, #150]
+  CSET W9, VC
+  STRB W9, [SP, #151]
+  CSET W9, HI
+  STRB W9, [SP, #152]
+  CSET W9, LS
+  STRB W9, [SP, #153]
+  CSET W9, GE
+  STRB W9, [SP, #154]
+  CSET W9, LT
+  STRB W9, [SP, #155]
+  CSET W9, GT
+  STRB W9, [SP, #156]
+  CSET W9, LE
+  STRB W9, [SP, #157]
+
+  // Conditional selects
+  MOV X0, #5
+  MOV X1, #5
+  CMP X0, X1
+  CSEL X10, X2, X3, EQ
+  CSEL X11, X2, X3, NE
+  CSINC X12, X2, X3, NE
+  CSINV X13, X2, X3, NE
+  CSNEG X14, X2, X3, NE
+  CINC X15, X2, EQ
+  CINV W16, W2, EQ
+  CNEG X17, X2, EQ
+  CSETM X18, EQ
+  CSETM W19, EQ
+  CSNEG W20, W2, W3, NE
+  CSEL X21, X2, X3, AL
+  CSEL X22, X2, X3, NV
+
+  ADD SP, SP, #0xa0
@@ -0,0 +1,47 @@
+// A64 decoder test: disassembles instruction words next to their unallocated
+// neighbours. Each valid word must come back as the text the parser reads,
+// and each word outside the allocated space as ".inst 0x<word>", so loading
+// it never produces an instruction the program did not contain.
+//
+// Run:      ./build/decode_test
+// Expected: "Testing Output/decodeOutput.txt" (ctest: decode)
+
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+
+#include "a64_decode.hpp"
+
+namespace {
+
+struct Case {
+    uint32_t word;
+    const char* what;
+};
+
+const Case kCases[] = {
+    // EXTR: op21 (bits 30:29) and o0 (bit 21) must be zero
+    { 0x93c23041, "ror x1, x2, #12" },
+    { 0x13841483, "ror w3, w4, #5" },
+    { 0x93c20c20, "extr x0, x1, x2, #3 (only ROR, Rn == Rm, is decoded)" },
+    { 0xb3c0e81d, "EXTR with op21 = 01" },
+    { 0xd3c3f478, "EXTR with op21 = 10" },
+    // Unprivileged and unscaled 9-bit offsets
+    { 0xf8408841, "ldtr x1, [x2, #8]" },
+    { 0xb81fc883, "sttr w3, [x4, #-4]" },
+    { 0xfc5fd0be, "ldur d30, [x5, #-3]" },
+    { 0xfc408c41, "ldr d1, [x2, #8]!" },
+    { 0x3cc10462, "ldr q2, [x3], #16" },
+    { 0xfc4dcafe, "LDTR with a SIMD&FP register" },
+};
+
+} // namespace
+
+int main() {
+    for (const Case& c : kCases) {
+        char word[16];
+        std::snprintf(word, sizeof word, "%08x", c.word);
+        std::cout << word << "  " << arm64::disassemble(c.word, 0x400000) << "  // " << c.what << "\n";
+    }
+    return 0;
+}
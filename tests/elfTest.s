@@ -0,0 +1,117 @@
+// Static ELF test: the startup work a C library does before main. Walks the
+// initial stack (argc, argv, envp, auxv) to AT_HWCAP, points TPIDR_EL0 at a
+// TLS block and stores through it, and uses the halfword and sign-extending
+// loads (LDRH/STRH, LDRSB/LDRSH/LDRSW) such code is full of
+//
+// This file is GNU assembler source for tests/elfTest.elf, not a listing:
+//   llvm-mc -triple=aarch64-linux-gnu -filetype=obj -o elfTest.o tests/elfTest.s
+//   ld.lld -static -e _start -o tests/elfTest.elf elfTest.o
+//
+// Run:      ./build/executor tests/elfTest.elf --quiet --dump-regs --env=LANG=C -- one
+// Expected: "Testing Output/elfOutput.txt" (ctest: elf, exit status 0)
+//
+// Expected output: "one" (argv[1]) on stdout, then
+//   X19 = 0x0000000000000002   ; argc
+//   X20 = 0x0000000000000003   ; AT_HWCAP: FP | ASIMD
+//   X21 = TLS block address    ; MRS X21, TPIDR_EL0 reads back what MSR wrote
+//   X22 = 0x000000000000BEEF   ; loaded back through the thread pointer
+//   X23 = 0x0000000000008001   ; LDRH zero-extends
+//   X24 = 0xFFFFFFFFFFFF8001   ; LDRSH Xt
+//   X25 = 0x00000000FFFF8001   ; LDRSH Wt sign-extends to 32 bits only
+//   X26 = 0xFFFFFFFFFFFFFF80   ; LDRSB Xt
+//   X27 = 0xFFFFFFFF80000000   ; LDRSW
+//   X28 = 0x0000000000000004   ; STRH/LDRH post-index walked two halfwords
+//   X0  = 0x0000000000000000   ; exit_group(0)
+
+    .text
+    .globl _start
+_start:
+    // argc, argv, envp and the auxiliary vector, from the initial SP
+    ldr     x19, [sp]
+    add     x1, sp, #8
+    add     x2, x1, x19, lsl #3
+    add     x2, x2, #8                  // envp
+skip_env:
+    ldr     x3, [x2], #8
+    cbnz    x3, skip_env
+find_hwcap:
+    ldp     x3, x4, [x2], #16           // key, value
+    cbz     x3, no_hwcap
+    cmp     x3, #16                     // AT_HWCAP
+    b.ne    find_hwcap
+    mov     x20, x4
+    b       have_hwcap
+no_hwcap:
+    mov     x20, #-1
+have_hwcap:
+
+    // write(1, argv[1], strlen(argv[1])) and a newline
+    ldr     x5, [x1, #8]
+    mov     x2, #0
+measure:
+    ldrb    w3, [x5, x2]
+    cbz     w3, measured
+    add     x2, x2, #1
+    b       measure
+measured:
+    mov     x0, #1
+    mov     x1, x5
+    mov     x8, #64
+    svc     #0
+    adrp    x1, newline
+    add     x1, x1, :lo12:newline
+    mov     x0, #1
+    mov     x2, #1
+    svc     #0
+
+    // Thread pointer: a TLS block in .bss, written through TPIDR_EL0
+    adrp    x0, tls_block
+    add     x0, x0, :lo12:tls_block
+    msr     tpidr_el0, x0
+    mrs     x21, tpidr_el0
+    mov     w1, #0xBEEF
+    strh    w1, [x21, #16]
+    mrs     x2, tpidr_el0
+    ldrh    w22, [x2, #16]
+
+    // Halfword and sign-extending loads from a constant table
+    adrp    x0, table
+    add     x0, x0, :lo12:table
+    ldrh    w23, [x0]
+    ldrsh   x24, [x0]
+    ldrsh   w25, [x0]
+    ldrsb   x26, [x0, #2]
+    ldrsw   x27, [x0, #4]
+
+    // STRH/LDRH with writeback
+    add     x3, x21, #32
+    mov     x4, x3
+    strh    w23, [x3], #2
+    strh    w22, [x3], #2
+    ldrh    w5, [x4, #2]!
+    sub     x28, x3, x21
+    sub     x28, x28, #32
+    cmp     w5, w22
+    b.ne    fail
+
+    mov     x0, #0
+    b       done
+fail:
+    mov     x0, #1
+done:
+    mov     x8, #94                     // exit_group
+    svc     #0
+
+    .section .rodata
+newline:
+    .byte   10
+    .balign 4
+table:
+    .hword  0x8001
+    .byte   0x80, 0
+    .word   0x80000000
+
+    .bss
+    .balign 16
+tls_block:
+    .zero   64
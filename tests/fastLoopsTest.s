@@ -0,0 +1,92 @@
+// Loop fast-forwarding test: counted loops the accelerator solves in closed
+// form (a register accumulator, the -O0 stack-slot counter, a multiply by a
+// constant, a 32-bit counter that wraps, a nested loop), and one it must run
+// normally because it stores to a different address every iteration
+//
+// Run:      ./build/executor tests/fastLoopsTest.s --quiet --dump-regs --dump-stack --fast-loops=verify
+// Expected: "Testing Output/fastLoopsOutput.txt" (ctest: fastLoops)
+// Run:      ./build/executor tests/fastLoopsTest.s --quiet --dump-regs --dump-stack --fast-loops
+// Expected: "Testing Output/fastLoopsSkipOutput.txt" (ctest: fastLoopsSkip, the
+//           same state without the verified count)
+//
+// =verify also interprets every skipped iteration and stops with an error if
+// the closed form disagrees, so this passing means both agree; the last line
+// counts the iterations that were skipped (3537 in 5 counted loops).
+//
+// Expected final state:
+//   X0  = 0x0000000000000BB8   ; 1000 * 3
+//   X1  = 0x00000000000003E8   ; loop counter, ends at 1000
+//   X2  = 0x9D0CEE3F1FDF58E7   ; 7 * 3^40 mod 2^64
+//   X3  = 0x0000000000000000   ; CBNZ counter
+//   X4  = 0x0000000000000005   ; W4 counted up from 0xFFFFFFF0 and wrapped
+//   X5  = 0x00000000000007D0   ; nested: 20 outer * 100 inner
+//   X6  = 0x0000000000000000
+//   X7  = 0x0000000000000000
+//   X8  = 0x0000000000000040   ; array walk: 8 stores of 8 bytes
+//   SP  = 0x0000000000000100
+// Stack: [0xb8] = 500 (the -O0 counter), 0xc0..0xff = 0, 1, .. 7 (the array)
+
+start:
+  SUB SP, SP, #72
+
+  // Register accumulator, CMP + B.cond exit
+  MOV X0, #0
+  MOV X1, #0
+acc_loop:
+  ADD X0, X0, #3
+  ADD X1, X1, #1
+  CMP X1, #1000
+  B.LT acc_loop
+
+  // -O0 style counter kept in a stack slot
+  STR XZR, [SP]
+slot_loop:
+  LDR X9, [SP]
+  ADD X9, X9, #1
+  STR X9, [SP]
+  CMP X9, #500
+  B.NE slot_loop
+
+  // Multiply by a constant, CBNZ exit
+  MOV X2, #7
+  MOV X3, #40
+mul_loop:
+  MOV X10, #3
+  MUL X2, X2, X10
+  SUB X3, X3, #1
+  CBNZ X3, mul_loop
+
+  // A 32-bit counter that wraps through zero
+  MOV W4, #0xFFFFFFF0
+wrap_loop:
+  ADD W4, W4, #1
+  CMP W4, #5
+  B.NE wrap_loop
+
+  // Nested: the inner loop is skipped on each outer iteration
+  MOV X5, #0
+  MOV X6, #20
+outer_loop:
+  MOV X7, #100
+inner_loop:
+  ADD X5, X5, #1
+  SUB X7, X7, #1
+  CBNZ X7, inner_loop
+  SUB X6, X6, #1
+  CBNZ X6, outer_loop
+
+  // Stores to a moving address: not a candidate, runs normally
+  ADD X11, SP, #8
+  MOV X8, #0
+array_loop:
+  LSR X12, X8, #3
+  STR X12, [X11, X8]
+  ADD X8, X8, #8
+  CMP X8, #64
+  B.NE array_loop
+
+  MOV X9, #0
+  MOV X10, #0
+  MOV X11, #0
+  MOV X12, #0
+  ADD SP, SP, #72
@@ -0,0 +1,156 @@
+// Flags test: ADDS/SUBS/ANDS and the ADC/ADCS/SBC/SBCS carry chains at
+// 32 and 64 bits, with the carry-in set explicitly through MSR NZCV
+//
+// Run:      ./build/executor tests/flagsTest.s --quiet --dump-regs --dump-stack
+// Expected: "Testing Output/flagsOutput.txt" (ctest: flags)
+//
+// Stack line 0x10 + 0x10*k holds case k: the result at +0, MRS NZCV at +8.
+//   case  instruction        carry-in  result              flags
+//    0    ADDS W0, W1, W2       -      0x0000000000000000  ZC    wraps to 0
+//    1    ADCS W0, W1, W2       1      0x0000000080000000  NV    carry-in 1 overflows into bit 31
+//    2    ADCS W0, W1, W2       1      0x00000000FFFFFFFF  NC    carry-in with both operands all ones
+//    3    SBCS W0, W1, W2       0      0x00000000FFFFFFFF  N     C clear: borrows one
+//    4    SBCS W0, W1, W2       1      0x0000000000000000  ZC    C set: no borrow
+//    5    SBCS W0, W1, W2       1      0x000000007FFFFFFF  CV    INT32_MIN - 1 overflows
+//    6    ADCS X0, X1, X2       1      0x0000000000000000  ZC    carry-in wraps 64 bits
+//    7    SBCS X0, X1, X2       0      0x7FFFFFFFFFFFFFFF  CV    INT64_MIN - 0 - 1 overflows
+//    8    ADDS X0, X1, X2       -      0x8000000000000000  NV    INT64_MAX + 1
+//    9    SUBS W0, W1, #5       -      0x00000000FFFFFFFE  N     3 - 5 at 32 bits
+//   10    ANDS X0, X1, X2       1      0x8000000000000000  N     clears C and V
+//   11    ADC W0, W1, W2        1      0x0000000000000000  C     no flags: C stays set
+//   12    SBC X0, X1, X2        0      0x0000000000000006  -     C clear: 10 - 3 - 1
+// 128-bit add (X4:X3) = (1:0xFFFFFFFFFFFFFFFF) + (2:1) with ADDS + ADC:
+//   X3 = 0x0000000000000000, X4 = 0x0000000000000004
+
+start:
+  SUB SP, SP, #0xF0
+
+  // case 0: wraps to 0
+  MOV W1, #0xFFFFFFFF
+  MOV W2, #1
+  ADDS W0, W1, W2
+  MRS X9, NZCV
+  STR X0, [SP, #0]
+  STR X9, [SP, #8]
+
+  // case 1: carry-in 1 overflows into bit 31
+  MOV W1, #0x7FFFFFFF
+  MOV W2, #0
+  MOV X9, #0x20000000
+  MSR NZCV, X9
+  ADCS W0, W1, W2
+  MRS X9, NZCV
+  STR X0, [SP, #16]
+  STR X9, [SP, #24]
+
+  // case 2: carry-in with both operands all ones
+  MOV W1, #0xFFFFFFFF
+  MOV W2, #0xFFFFFFFF
+  MOV X9, #0x20000000
+  MSR NZCV, X9
+  ADCS W0, W1, W2
+  MRS X9, NZCV
+  STR X0, [SP, #32]
+  STR X9, [SP, #40]
+
+  // case 3: C clear: borrows one
+  MOV W1, #0
+  MOV W2, #0
+  MSR NZCV, XZR
+  SBCS W0, W1, W2
+  MRS X9, NZCV
+  STR X0, [SP, #48]
+  STR X9, [SP, #56]
+
+  // case 4: C set: no borrow
+  MOV W1, #5
+  MOV W2, #5
+  MOV X9, #0x20000000
+  MSR NZCV, X9
+  SBCS W0, W1, W2
+  MRS X9, NZCV
+  STR X0, [SP, #64]
+  STR X9, [SP, #72]
+
+  // case 5: INT32_MIN - 1 overflows
+  MOV W1, #0x80000000
+  MOV W2, #1
+  MOV X9, #0x20000000
+  MSR NZCV, X9
+  SBCS W0, W1, W2
+  MRS X9, NZCV
+  STR X0, [SP, #80]
+  STR X9, [SP, #88]
+
+  // case 6: carry-in wraps 64 bits
+  MOV X1, #-1
+  MOV X2, #0
+  MOV X9, #0x20000000
+  MSR NZCV, X9
+  ADCS X0, X1, X2
+  MRS X9, NZCV
+  STR X0, [SP, #96]
+  STR X9, [SP, #104]
+
+  // case 7: INT64_MIN - 0 - 1 overflows
+  MOV X1, #0x8000000000000000
+  MOV X2, #0
+  MSR NZCV, XZR
+  SBCS X0, X1, X2
+  MRS X9, NZCV
+  STR X0, [SP, #112]
+  STR X9, [SP, #120]
+
+  // case 8: INT64_MAX + 1
+  MOV X1, #0x7FFFFFFFFFFFFFFF
+  MOV X2, #1
+  ADDS X0, X1, X2
+  MRS X9, NZCV
+  STR X0, [SP, #128]
+  STR X9, [SP, #136]
+
+  // case 9: 3 - 5 at 32 bits
+  MOV W1, #3
+  SUBS W0, W1, #5
+  MRS X9, NZCV
+  STR X0, [SP, #144]
+  STR X9, [SP, #152]
+
+  // case 10: clears C and V
+  MOV X1, #0x8000000000000000
+  MOV X2, #-1
+  MOV X9, #0x30000000
+  MSR NZCV, X9
+  ANDS X0, X1, X2
+  MRS X9, NZCV
+  STR X0, [SP, #160]
+  STR X9, [SP, #168]
+
+  // case 11: no flags: C stays set
+  MOV W1, #0xFFFFFFFF
+  MOV W2, #0
+  MOV X9, #0x20000000
+  MSR NZCV, X9
+  ADC W0, W1, W2
+  MRS X9, NZCV
+  STR X0, [SP, #176]
+  STR X9, [SP, #184]
+
+  // case 12: C clear: 10 - 3 - 1
+  MOV X1, #10
+  MOV X2, #3
+  MSR NZCV, XZR
+  SBC X0, X1, X2
+  MRS X9, NZCV
+  STR X0, [SP, #192]
+  STR X9, [SP, #200]
+
+  // 128-bit add through the carry
+  MOV X3, #-1
+  MOV X4, #1
+  MOV X5, #1
+  MOV X6, #2
+  ADDS X3, X3, X5
+  ADC X4, X4, X6
+
+  ADD SP, SP, #0xF0
@@ -0,0 +1,109 @@
+// Floating-point test: FDIV rounded under each FPCR.RMode (RN, RP, RM, RZ),
+// FCMP against NaN and infinities (the NZCV nibble captured with MRS), and
+// FCVTZS truncating, saturating on infinity and giving 0 for NaN
+//
+// Run:      ./build/executor tests/fpTest.s --quiet --dump-regs --dump-stack
+// Expected: "Testing Output/fpOutput.txt" (ctest: fp)
+//
+// RMode is FPCR bits 23:22: 0 RN (nearest), 1 RP (+inf), 2 RM (-inf), 3 RZ.
+//
+// Expected final state:
+//   X0  = 0x3FD5555555555555   ; RN  1.0 / 3.0
+//   X1  = 0x3FD5555555555556   ; RP  1.0 / 3.0 (rounded up)
+//   X2  = 0x3FD5555555555555   ; RM  1.0 / 3.0
+//   X3  = 0x3FD5555555555555   ; RZ  1.0 / 3.0
+//   X4  = 0xBFD5555555555555   ; RP -1.0 / 3.0 (towards +inf is towards zero)
+//   X5  = 0xBFD5555555555556   ; RM -1.0 / 3.0 (away from zero)
+//   X6  = 0x3EAAAAAB           ; RN  1.0f / 3.0f (single precision rounds up)
+//   X7  = 0x3EAAAAAA           ; RZ  1.0f / 3.0f
+//   X8  = 0x0000000000000000   ; FPCR read back after restoring RN
+//   X9  = 0x0000000030000000   ; FCMP NaN, 1.0: unordered (C, V)
+//   X10 = 0x0000000030000000   ; FCMP NaN, NaN: unordered
+//   X11 = 0x0000000020000000   ; FCMP +inf, 1.0: greater (C)
+//   X12 = 0x0000000080000000   ; FCMP -inf, 1.0: less (N)
+//   X13 = 0x0000000060000000   ; FCMP +inf, +inf: equal (Z, C)
+//   X14 = 0x0000000020000000   ; FCMP +inf, #0.0: greater
+//   X15 = 0x0000000000000001   ; B.VS taken after the unordered compare
+//   X16 = 0x7FFFFFFFFFFFFFFF   ; FCVTZS X, +inf saturates
+//   X17 = 0x8000000000000000   ; FCVTZS X, -inf saturates
+//   X18 = 0x0000000000000000   ; FCVTZS X, NaN
+//   X19 = 0xFFFFFFFFFFFFFFFE   ; FCVTZS X, -2.75 truncates to -2
+//   X20 = 0x000000007FFFFFFF   ; FCVTZS W, 3.0e9 saturates at 32 bits
+//   X21 = 0x7FF0000000000000   ; +inf from 1.0 / 0.0
+//   SP  = 0x0000000000000100
+
+start:
+  FMOV D20, #1.0
+  FMOV D21, #3.0
+  FNEG D22, D20               // -1.0
+  FMOV S23, #1.0
+  FMOV S24, #3.0
+
+  // Rounding modes
+  MOV X28, #0                 // RN
+  MSR FPCR, X28
+  FDIV D0, D20, D21
+  FMOV X0, D0
+  FDIV S6, S23, S24
+  FMOV W6, S6
+
+  MOV X28, #0x400000          // RP
+  MSR FPCR, X28
+  FDIV D1, D20, D21
+  FMOV X1, D1
+  FDIV D4, D22, D21
+  FMOV X4, D4
+
+  MOV X28, #0x800000          // RM
+  MSR FPCR, X28
+  FDIV D2, D20, D21
+  FMOV X2, D2
+  FDIV D5, D22, D21
+  FMOV X5, D5
+
+  MOV X28, #0xC00000          // RZ
+  MSR FPCR, X28
+  FDIV D3, D20, D21
+  FMOV X3, D3
+  FDIV S7, S23, S24
+  FMOV W7, S7
+
+  MSR FPCR, XZR
+  MRS X8, FPCR
+
+  // Special values: 0/0 is NaN, 1/0 is +inf
+  FMOV D25, XZR
+  FDIV D26, D25, D25          // NaN
+  FDIV D27, D20, D25          // +inf
+  FNEG D28, D27               // -inf
+  FMOV X21, D27
+
+  // Comparisons
+  FCMP D26, D20
+  MRS X9, NZCV
+  MOV X15, #0
+  B.VS unordered
+  MOV X15, #2
+unordered:
+  ADD X15, X15, #1
+  FCMP D26, D26
+  MRS X10, NZCV
+  FCMP D27, D20
+  MRS X11, NZCV
+  FCMP D28, D20
+  MRS X12, NZCV
+  FCMP D27, D27
+  MRS X13, NZCV
+  FCMP D27, #0.0
+  MRS X14, NZCV
+
+  // Conversions
+  FCVTZS X16, D27
+  FCVTZS X17, D28
+  FCVTZS X18, D26
+  FMOV D29, #-2.75
+  FCVTZS X19, D29
+  MOV X28, #0xB2D05E00        // 3000000000
+  UCVTF D30, X28
+  FCVTZS W20, D30
+  MOV X28, #0
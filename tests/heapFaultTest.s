@@ -0,0 +1,27 @@
+// Guest heap fault test: a load from a mapping after munmap released it is
+// an error naming the access, its size and the address
+//
+// Run:      ./build/executor tests/heapFaultTest.s --quiet
+// Expected: "Testing Output/heapFaultOutput.txt" (ctest: heapFault, exit status 2)
+//
+// Expected output:
+//   error: LDR of 8 bytes at 0x100000ff8 out of guest memory bounds
+
+start:
+  // mmap(NULL, 0x1000, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0)
+  MOV X0, #0
+  MOV X1, #0x1000
+  MOV X2, #3
+  MOV X3, #0x22
+  MOV X4, #-1
+  MOV X5, #0
+  MOV X8, #222
+  SVC #0
+  MOV X19, X0
+  STR X19, [X19, #0xFF8]
+
+  // munmap(X19, 0x1000), then touch it again
+  MOV X1, #0x1000
+  MOV X8, #215
+  SVC #0
+  LDR X20, [X19, #0xFF8]
@@ -0,0 +1,83 @@
+// Guest heap test: brk growing, shrinking and growing back (the released
+// page comes back zeroed), anonymous mmap/munmap, and the errors for an
+// mmap that is not anonymous
+//
+// Run:      ./build/executor tests/heapTest.s --quiet --dump-regs
+// Expected: "Testing Output/heapOutput.txt" (ctest: heap)
+//
+// Expected final state:
+//   X19 = 0x0000000010000000   ; brk(0): the initial break
+//   X20 = 0x0000000010001800   ; brk(base + 0x1800)
+//   X21 = 0x0000000012345678   ; stored and read back at base + 0x17F8
+//   X22 = 0x0000000010001000   ; brk(base + 0x1000) shrinks the heap
+//   X23 = 0x0000000000000000   ; grown back: base + 0x17F8 reads zero again
+//   X24 = 0x0000000100000000   ; mmap(0, 0x3000, RW, PRIVATE|ANONYMOUS)
+//   X25 = 0x00000000CAFEF00D   ; stored and read back in its last page
+//   X26 = 0x0000000000000000   ; munmap(X24, 0x3000)
+//   X27 = 0xFFFFFFFFFFFFFFF7   ; -EBADF: mmap without MAP_ANONYMOUS
+//   X28 = 0xFFFFFFFFFFFFFFEA   ; -EINVAL: mmap of length 0
+
+start:
+  // brk(0) reports the break
+  MOV X0, #0
+  MOV X8, #214
+  SVC #0
+  MOV X19, X0
+
+  // Grow by a page and a half and use the top of it
+  ADD X0, X19, #0x1800
+  SVC #0
+  MOV X20, X0
+  MOV X9, #0x5678
+  MOVK X9, #0x1234, LSL #16
+  ADD X10, X19, #0x17F8
+  STR X9, [X10]
+  LDR X21, [X10]
+
+  // Shrink below that page, then grow back over it
+  ADD X0, X19, #0x1000
+  SVC #0
+  MOV X22, X0
+  ADD X0, X19, #0x1800
+  SVC #0
+  LDR X23, [X10]
+
+  // mmap(NULL, 0x3000, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0)
+  MOV X0, #0
+  MOV X1, #0x3000
+  MOV X2, #3
+  MOV X3, #0x22
+  MOV X4, #-1
+  MOV X5, #0
+  MOV X8, #222
+  SVC #0
+  MOV X24, X0
+  MOV X9, #0xF00D
+  MOVK X9, #0xCAFE, LSL #16
+  ADD X10, X24, #0x2FF8
+  STR X9, [X10]
+  LDR X25, [X10]
+
+  // munmap(X24, 0x3000)
+  MOV X0, X24
+  MOV X1, #0x3000
+  MOV X8, #215
+  SVC #0
+  MOV X26, X0
+
+  // File mappings are not supported; neither is an empty one
+  MOV X0, #0
+  MOV X1, #0x1000
+  MOV X3, #0x2
+  MOV X4, #3
+  MOV X8, #222
+  SVC #0
+  MOV X27, X0
+  MOV X1, #0
+  MOV X3, #0x22
+  MOV X4, #-1
+  SVC #0
+  MOV X28, X0
+
+  MOV X9, #0
+  MOV X10, #0
@@ -0,0 +1,150 @@
+// Host function test: memset, strlen, memcpy, memcmp and memmove called by
+// name. Each has a guest implementation below that also counts its calls in
+// X15; with host functions on (the default) the host does the whole call,
+// so the guest bodies never run and only X0 changes.
+//
+// Run:      ./build/executor tests/hleTest.s --quiet --dump-regs --dump-stack
+// Expected: "Testing Output/hleOutput.txt" (ctest: hle)
+// Run:      ./build/executor tests/hleTest.s --quiet --dump-regs --dump-stack --no-hle
+// Expected: "Testing Output/hleGuestOutput.txt" (ctest: hleGuest)
+//
+// The two runs leave the same registers and memory except X15, which is 0
+// with host functions and 0x7 (one per call) with --no-hle.
+//
+// Expected final state:
+//   X19 = 0x000000000000000F   ; strlen of 15 'A's
+//   X20 = 0x00000000000000E0   ; memcpy returns its destination
+//   X21 = 0x0000000000000000   ; memcmp of equal buffers
+//   X22 = 0x00000000FFFFFFFF   ; memcmp 'A' < 'B': a negative int in W0
+//   X23 = 0x00000000000000C1   ; memmove returns its destination
+//   X24 = 0x0000000000000001   ; memcmp 'B' > 'A'
+//   SP  = 0x0000000000000100
+// Stack: 0xC0..0xCF all 'A' (memmove shifted the string up over its NUL),
+//        0xE0..0xEF the memcpy'd copy with 'B' at 0xE7.
+
+start:
+  SUB SP, SP, #64               // SP = 0xC0
+  MOV X15, #0
+
+  // memset(sp, 'A', 15); sp[15] = 0
+  MOV X0, SP
+  MOV X1, #0x41
+  MOV X2, #15
+  BL memset
+  STRB WZR, [SP, #15]
+
+  MOV X0, SP
+  BL strlen
+  MOV X19, X0
+
+  // memcpy(sp + 32, sp, 16)
+  ADD X0, SP, #32
+  MOV X1, SP
+  MOV X2, #16
+  BL memcpy
+  MOV X20, X0
+
+  ADD X0, SP, #32
+  MOV X1, SP
+  MOV X2, #16
+  BL memcmp
+  MOV X21, X0
+
+  // Make the copy differ at byte 7
+  MOV W9, #0x42
+  STRB W9, [SP, #39]
+  MOV X0, SP
+  ADD X1, SP, #32
+  MOV X2, #16
+  BL memcmp
+  MOV X22, X0
+  ADD X0, SP, #32
+  MOV X1, SP
+  MOV X2, #16
+  BL memcmp
+  MOV X24, X0
+
+  // memmove(sp + 1, sp, 15): overlapping, copies backwards
+  ADD X0, SP, #1
+  MOV X1, SP
+  MOV X2, #15
+  BL memmove
+  MOV X23, X0
+
+  MOV X9, #0
+  MOV X10, #0
+  MOV X11, #0
+  MOV X12, #0
+  ADD SP, SP, #64
+  B finish
+
+// Guest versions: byte loops, scratch in X9-X12
+memset:
+  ADD X15, X15, #1
+  MOV X9, #0
+set_loop:
+  CMP X9, X2
+  B.EQ set_out
+  STRB W1, [X0, X9]
+  ADD X9, X9, #1
+  B set_loop
+set_out:
+  RET
+
+strlen:
+  ADD X15, X15, #1
+  MOV X9, X0
+len_loop:
+  LDRB W10, [X9]
+  CBZ W10, len_out
+  ADD X9, X9, #1
+  B len_loop
+len_out:
+  SUB X0, X9, X0
+  RET
+
+memcpy:
+  ADD X15, X15, #1
+  MOV X9, #0
+cpy_loop:
+  CMP X9, X2
+  B.EQ cpy_out
+  LDRB W10, [X1, X9]
+  STRB W10, [X0, X9]
+  ADD X9, X9, #1
+  B cpy_loop
+cpy_out:
+  RET
+
+memcmp:
+  ADD X15, X15, #1
+  MOV X9, #0
+cmp_loop:
+  CMP X9, X2
+  B.EQ cmp_same
+  LDRB W10, [X0, X9]
+  LDRB W11, [X1, X9]
+  ADD X9, X9, #1
+  CMP W10, W11
+  B.EQ cmp_loop
+  MOV W12, #1
+  CSNEG W0, W12, W12, HI
+  RET
+cmp_same:
+  MOV X0, #0
+  RET
+
+memmove:
+  ADD X15, X15, #1
+  MOV X9, X2
+mov_loop:
+  CBZ X9, mov_out
+  SUB X9, X9, #1
+  LDRB W10, [X1, X9]
+  STRB W10, [X0, X9]
+  B mov_loop
+mov_out:
+  RET
+
+finish:
+  NOP
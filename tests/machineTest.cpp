@@ -0,0 +1,119 @@
+// Machine API test: drives the library the way an embedding harness would,
+// with no executor process. loadText(), runUntil() to a breakpoint, step(),
+// register and memory access between runs, a step limit resumed by the next
+// run(), onFetch() counting dispatches, an exit_group status, an instruction
+// error, and fast-forwarded loops retiring the same step count.
+//
+// Run:      ./build/machine_test
+// Expected: "Testing Output/machineOutput.txt" (ctest: machine)
+
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+
+#include "machine.hpp"
+
+namespace {
+
+// Sum 10 + 9 + .. + 1 into X0, push it, then two moves:
+//   0x00 MOV  0x08 loop: ADD  0x14 STR  0x18 MOV X2  0x1c MOV X3  end 0x20
+const char* const kSum =
+    "start:\n"
+    "  MOV X0, #0\n"
+    "  MOV X1, #10\n"
+    "loop:\n"
+    "  ADD X0, X0, X1\n"
+    "  SUB X1, X1, #1\n"
+    "  CBNZ X1, loop\n"
+    "  STR X0, [SP, #-8]!\n"
+    "  MOV X2, #3\n"
+    "  MOV X3, #4\n";
+
+void report(const char* what, const arm64::Machine& m) {
+    std::cout << what << ": " << arm64::stopReasonName(m.stopReason())
+              << " pc=0x" << std::hex << m.pc() << std::dec
+              << " steps=" << m.steps()
+              << " x0=" << m.registers().readX(0) << "\n";
+}
+
+} // namespace
+
+int main() {
+    {
+        arm64::Machine m;
+        m.loadText(kSum);
+        m.runUntil(0x14);
+        report("runUntil", m);
+
+        m.step();
+        uint64_t pushed = 0;
+        m.readMemory(m.registers().readSP(), &pushed, sizeof pushed);
+        std::cout << "step: pc=0x" << std::hex << m.pc() << " sp=0x" << m.registers().readSP()
+                  << std::dec << " pushed=" << pushed << "\n";
+
+        const uint64_t patched = 99;
+        m.writeMemory(m.registers().readSP(), &patched, sizeof patched);
+        m.registers().writeX(3, 1234);
+        m.run();
+        m.readMemory(m.registers().readSP(), &pushed, sizeof pushed);
+        report("run", m);
+        std::cout << "  x2=" << m.registers().readX(2) << " x3=" << m.registers().readX(3)
+                  << " [sp]=" << pushed << " finished=" << m.finished() << "\n";
+
+        // An ended program stays ended until PC is moved
+        m.run();
+        report("again", m);
+    }
+    {
+        arm64::Machine m;
+        m.loadText(kSum);
+        arm64::RunLimits limits;
+        limits.maxSteps = 7;
+        m.run(limits);
+        report("limit", m);
+        m.run(limits);
+        report("resume", m);
+        m.run();
+        report("rest", m);
+    }
+    {
+        arm64::MachineOptions opts;
+        opts.singleStep = true;
+        arm64::Machine m(opts);
+        std::size_t fetched = 0, branches = 0;
+        m.onFetch([&](const arm64::AsmInst& ai) {
+            ++fetched;
+            if (ai.inst.op == arm64::Opcode::Cbnz) ++branches;
+        });
+        m.loadText(kSum);
+        m.run();
+        std::cout << "onFetch: " << fetched << " instructions, " << branches << " CBNZ\n";
+    }
+    {
+        arm64::MachineOptions opts;
+        opts.fastLoops = true;
+        arm64::Machine m(opts);
+        m.loadText(kSum);
+        m.run();
+        report("fastLoops", m);
+    }
+    {
+        arm64::Machine m;
+        m.loadText("start:\n  MOV X0, #7\n  MOV X8, #94\n  SVC #0\n  MOV X0, #1\n");
+        m.run();
+        report("exit", m);
+        std::cout << "  exited=" << m.exec().exited << " code=" << m.exec().exitCode << "\n";
+    }
+    {
+        arm64::Machine m;
+        m.loadText("start:\n  MOV X9, #0x4000\n  LDR X0, [X9]\n");
+        try {
+            m.run();
+            std::cout << "error: no exception\n";
+        } catch (const std::runtime_error& ex) {
+            std::cout << "error: " << ex.what() << "\n";
+        }
+        report("error", m);
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+// Wide-immediate and multiply/divide test: MOVZ/MOVK chains (folded into
+// one constant load), MOVN, MADD/MSUB/MNEG, SMULL/UMULL/SMULH/UMULH, and
+// SDIV/UDIV edge cases
+//
+// Run:      ./build/executor tests/muldivTest.s --quiet --dump-regs --dump-stack
+// Expected: "Testing Output/muldivOutput.txt" (ctest: muldiv)
+//
+// Expected final state:
+//   X1  = 0x123456789ABCDEF0   ; MOVZ + 3x MOVK
+//   X2  = 0xFFFFFFFFEDCBFFFF
+//   X3  = 0x00000000FFFFEDCB
+//   X4  = 0x00000000BEEFCAFE
+//   X5  = 0x0000000000000007
+//   X6  = 0xFFFFFFFFFFFFFFFD
+//   X7  = 0x123456789ABCDEDB   ; 7 * -3 + X1
+//   X8  = 0x000000000000001C   ; 7 - 7 * -3
+//   X9  = 0x0000000000000015
+//   X10 = 0xFFFFFFFFFFFFFFEB   ; -3 * 7, signed 32x32->64
+//   X11 = 0x00000006FFFFFFEB   ; 0xFFFFFFFD * 7, unsigned
+//   X12 = 0xFFFFFFFFFFFFFFFF   ; high half of X1 * -3
+//   X13 = 0x1234567899717E39   ; high half of X1 * X2
+//   X14 = 0xFFFFFFFFFFFFFFF9
+//   X15 = 0x0000000000000002
+//   X16 = 0xFFFFFFFFFFFFFFFD   ; -7 / 2 truncates to -3
+//   X17 = 0x7FFFFFFFFFFFFFFC   ; unsigned view of -7
+//   X18 = 0x00000000FFFFFFFD   ; W form
+//   X19 = 0x0000000000000000   ; divide by zero gives 0
+//   X20 = 0x0000000000000000   ; signed divide by zero gives 0
+//   X21 = 0x8000000000000000
+//   X22 = 0xFFFFFFFFFFFFFFFF
+//   X23 = 0x8000000000000000   ; INT64_MIN / -1 wraps
+//   X24 = 0x0000000080000000
+//   X25 = 0x0000000080000000   ; INT32_MIN / -1 wraps
+//   X26 = 0x000000007FFFFFFF   ; 0xFFFFFFFF / 2
+
+start:
+  MOVZ X1, #0xDEF0
+  MOVK X1, #0x9ABC, LSL #16
+  MOVK X1, #0x5678, LSL #32
+  MOVK X1, #0x1234, LSL #48
+  MOVN X2, #0x1234, LSL #16
+  MOVN W3, #0x1234
+  MOVZ W4, #0xBEEF, LSL #16
+  MOVK W4, #0xCAFE
+  MOV X5, #7
+  MOV X6, #-3
+  MADD X7, X5, X6, X1
+  MSUB X8, X5, X6, X5
+  MNEG W9, W5, W6
+  SMULL X10, W6, W5
+  UMULL X11, W6, W5
+  SMULH X12, X1, X6
+  UMULH X13, X1, X2
+  MOV X14, #-7
+  MOV X15, #2
+  SDIV X16, X14, X15
+  UDIV X17, X14, X15
+  SDIV W18, W14, W15
+  UDIV X19, X1, XZR
+  SDIV X20, X14, XZR
+  MOV X21, #0x8000000000000000
+  MOV X22, #-1
+  SDIV X23, X21, X22
+  MOV W24, #0x80000000
+  SDIV W25, W24, W22
+  UDIV W26, W22, W15
@@ -0,0 +1,31 @@
+// Operand list test: lines with more operands than fit inline (the list moves
+// to the heap), a seven-operand .byte directive the program branches over,
+// and operand text long enough that it cannot sit in a short string
+//
+// Run:      ./build/executor tests/operandsTest.s --quiet --dump-regs
+// Expected: "Testing Output/operandsOutput.txt" (ctest: operands)
+// Also:     ./build/parser tests/operandsTest.s
+//           "Testing Output/operandsParserOutput.txt" (ctest: operandsParser),
+//           every operand of every line printed back as written
+//
+// Expected final state:
+//   X0  = 0x0000000000000003
+//   X1  = 0x0000000000000005
+//   X2  = 0x0000000000000017   ; ADD X2, X0, X1, LSL #2 = 3 + 20
+//   X3  = 0x0000000000000026   ; MADD X3, X0, X1, X2 = 15 + 23
+//   X4  = 0x0000000000000017   ; loaded back through a long memory operand
+//   X5  = 0x0000000000000026
+//   SP  = 0x0000000000000100
+
+start:
+  MOV X0, #3
+  MOV X1, #5
+  B over
+  .byte 1, 2, 3, 4, 5, 6, 7
+  .byte 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18
+over:
+  ADD X2, X0, X1, LSL #2
+  MADD X3, X0, X1, X2
+  STP X2, X3, [SP, #-16]!
+  LDP X4, X5, [SP, #0x0000000000000000]
+  ADD SP, SP, #16
@@ -0,0 +1,52 @@
+// Optimizer test: -O0 style code the block optimizer rewrites. Constants
+// fold through ALU chains, reloads of just-stored stack slots become
+// register moves or constants, and overwritten writes are dropped, all
+// without changing what the program computes
+//
+// Run:      ./build/executor tests/optimizeTest.s --quiet --dump-regs --dump-stack --optimize --profile
+// Expected: "Testing Output/optimizeOutput.txt" (ctest: optimize)
+// Run:      ./build/executor tests/optimizeTest.s --quiet --dump-regs --dump-stack --profile
+// Expected: "Testing Output/optimizeOffOutput.txt" (ctest: optimizeOff)
+//
+// Without --optimize the registers, flags and stack are identical; only the
+// "Optimized windows" line (how many instructions were rewritten) is new.
+//
+// Expected final state:
+//   X0  = 0x0000000000000005
+//   X1  = 0x0000000000000005   ; LDR of [SP, #8] just stored from X0
+//   X2  = 0x0000000000000028   ; (5 + 3) * 5, folded
+//   X3  = 0x0000000000000009   ; MOV X3, #7 is dead
+//   X4  = 0x000000000000ABCD   ; LDRH of a halfword just stored
+//   X5  = 0x0000000000000064   ; loop: 10 * 10 through a reloaded counter
+//   X6  = 0x0000000000000000
+//   SP  = 0x0000000000000100
+// Stack: [0xe8] = 5, [0xf0] = 0xABCD (halfword), [0xf8] = 0 (loop counter)
+
+start:
+  SUB SP, SP, #32
+
+  MOV X0, #5
+  STR X0, [SP, #8]
+  LDR X1, [SP, #8]
+  ADD X2, X1, #3
+  MUL X2, X2, X1
+  MOV X3, #7
+  MOV X3, #9
+  MOV W9, #0xABCD
+  STRH W9, [SP, #16]
+  LDRH W4, [SP, #16]
+
+  // for (i = 10; i != 0; i--) x5 += 10, with i kept in a stack slot
+  MOV X5, #0
+  MOV X6, #10
+  STR X6, [SP, #24]
+count_loop:
+  LDR X6, [SP, #24]
+  ADD X5, X5, #10
+  SUB X6, X6, #1
+  STR X6, [SP, #24]
+  LDR X6, [SP, #24]
+  CBNZ X6, count_loop
+
+  MOV X9, #0
+  ADD SP, SP, #32
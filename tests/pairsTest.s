@@ -0,0 +1,108 @@
+// Pairs and writeback test: STP/LDP of X and W registers with pre- and
+// post-index writeback, post-index walks over an array, and writeback into
+// the register being loaded or stored (Rt == Rn)
+//
+// Run:      ./build/executor tests/pairsTest.s --quiet --dump-regs --dump-stack
+// Expected: "Testing Output/pairsOutput.txt" (ctest: pairs)
+//
+// Rt == Rn with writeback is CONSTRAINED UNPREDICTABLE in the architecture;
+// the emulator loads into Rt after the base is written back (the loaded
+// value wins) and stores Rt's value from before the base moves.
+//
+// Expected final state:
+//   X0  = 0x000000000000AAAA   ; LDR X0, [X0, #8]! : the loaded value, not 0xE8
+//   X1  = 0x00000000000000D0   ; STR X1, [X1, #-16]! stored the old X1 (0xE0) at 0xD0
+//   X2  = 0x0000000000000011   ; LDP X2, X3, [X3], #16 from 0xB0
+//   X3  = 0x0000000000000022   ; ... Rt2 == Rn: the loaded value wins
+//   X4  = 0x00000000FFFFFFFF   ; LDP W4, W5 zero-extend
+//   X5  = 0x0000000000000001
+//   X6  = 0x000000000000000A   ; sum of the array 1 + 2 + 3 + 4 via LDR X7, [X8], #8
+//   X7  = 0x0000000000000004
+//   X8  = 0x00000000000000A0   ; one past the array at 0x80
+//   X19 = 0x00000000000000E8   ; popped from 0xE0, which the LDR test overwrote
+//   X20 = 0x000000000000AAAA
+//   X21 = 0x0000000000000003   ; bytes written by STRB W9, [X10], #1
+//   X29 = 0x0000000000002929   ; popped by LDP X29, X30, [SP], #16
+//   X30 = 0x0000000000003030
+//   SP  = 0x0000000000000100
+// Stack (base 0x0):
+//   [0x60..0x6b] = 01 00 00 00 FF FF FF FF 01 00 00 00  ; STP W9, W10 then STP W4, W9 at 0x64
+//   [0x70..0x72] = 07 08 09                              ; post-index STRB walk
+//   [0x80..0x9f] = 1, 2, 3, 4 as 64-bit words            ; the array
+//   [0xb0..0xbf] = 0x11, 0x22                            ; read back by LDP ... post-index
+//   [0xd0]       = 0xE0                                  ; STR X1, [X1, #-16]! stored the old X1
+//   [0xe0..0xef] = 0xE8, 0xAAAA                          ; over the pushed X19, X20
+//   [0xf0..0xff] = 0x2929, 0x3030                        ; STP X29, X30, [SP, #-16]!
+
+start:
+  // Push a frame with pre-index writeback
+  MOV X29, #0x2929
+  MOV X30, #0x3030
+  STP X29, X30, [SP, #-16]!   // SP = 0xF0
+  MOV X19, #0x1919
+  MOV X20, #0x2020
+  STP X19, X20, [SP, #-16]!   // SP = 0xE0
+
+  // LDR with writeback into its own base: [0xE8] = 0xAAAA
+  MOV X0, #0xE0
+  MOV X9, #0xAAAA
+  STR X9, [X0, #8]
+  MOV X9, #0xE8
+  STR X9, [X0]
+  LDR X0, [X0, #8]!           // X0 = 0xAAAA (the base write is overwritten)
+
+  // STR with writeback from its own base: stores 0xE0, then X1 = 0xD0
+  MOV X1, #0xE0
+  STR X1, [X1, #-16]!
+
+  // LDP post-index with Rt2 == base
+  MOV X9, #0x11
+  MOV X10, #0x22
+  MOV X3, #0xB0
+  STP X9, X10, [X3]
+  LDP X2, X3, [X3], #16       // X2 = 0x11, X3 = 0x22
+
+  // 32-bit pairs zero-extend
+  MOV W9, #1
+  MOV W10, #0xFFFFFFFF
+  MOV X11, #0x60
+  STP W9, W10, [X11]
+  LDP W4, W5, [X11, #4]!      // X11 = 0x64: W4 = 0xFFFFFFFF, W5 = 0
+  STP W4, W9, [X11]           // [0x64] = FF FF FF FF 01 00 00 00
+  LDP W4, W5, [X11]           // W4 = 0xFFFFFFFF, W5 = 1
+
+  // Sum an array with post-index loads
+  MOV X8, #0x80
+  MOV X9, #1
+  STR X9, [X8]
+  MOV X9, #2
+  STR X9, [X8, #8]
+  MOV X9, #3
+  STR X9, [X8, #16]
+  MOV X9, #4
+  STR X9, [X8, #24]
+  MOV X6, #0
+  MOV X12, #4
+sum_loop:
+  LDR X7, [X8], #8
+  ADD X6, X6, X7
+  SUB X12, X12, #1
+  CBNZ X12, sum_loop
+
+  // Byte stores with post-index
+  MOV X10, #0x70
+  MOV W9, #7
+  STRB W9, [X10], #1
+  MOV W9, #8
+  STRB W9, [X10], #1
+  MOV W9, #9
+  STRB W9, [X10], #1
+  SUB X21, X10, #0x70         // X21 = 3
+
+  // Pop the frame
+  LDP X19, X20, [SP], #16
+  LDP X29, X30, [SP], #16
+  MOV X9, #0
+  MOV X10, #0
+  MOV X11, #0
+  MOV X12, #0
@@ -0,0 +1,46 @@
+# Runs one fixture test (see arm64_fixture() in CMakeLists.txt).
+#
+#   EXE      tool to run
+#   ARGS     its arguments, separated by '|'
+#   EXPECTED file holding the expected stdout + stderr
+#   STATUS   expected exit status
+#   ACTUAL   where to leave this run's output when it differs
+#   UPDATE   if set, (re)write EXPECTED from this run instead of comparing
+#   WRITES   a file the tool writes; its contents are appended to the output
+#   CLEAN    a file to remove before the run (a SCRATCH file with CLEAN)
+#
+# The tool runs from the source directory, so inputs are named relative to
+# it exactly as in the command line quoted at the top of each test program.
+
+string(REPLACE "|" ";" args "${ARGS}")
+if (WRITES)
+  file(REMOVE "${WRITES}")
+endif()
+if (CLEAN)
+  file(REMOVE "${CLEAN}")
+endif()
+execute_process(
+  COMMAND ${EXE} ${args}
+  OUTPUT_VARIABLE out
+  ERROR_VARIABLE out
+  RESULT_VARIABLE rc
+)
+if (WRITES AND EXISTS "${WRITES}")
+  file(READ "${WRITES}" written)
+  string(APPEND out "${written}")
+endif()
+
+if (UPDATE)
+  file(WRITE "${EXPECTED}" "${out}")
+  message(STATUS "wrote ${EXPECTED} (exit status ${rc})")
+  return()
+endif()
+
+if (NOT rc STREQUAL "${STATUS}")
+  message(FATAL_ERROR "exit status ${rc}, expected ${STATUS}\n${out}")
+endif()
+file(READ "${EXPECTED}" want)
+if (NOT out STREQUAL want)
+  file(WRITE "${ACTUAL}" "${out}")
+  message(FATAL_ERROR "output differs from ${EXPECTED}; this run's output is in ${ACTUAL}")
+endif()
@@ -0,0 +1,102 @@
+// Listing scanner test: runs findFirstOf(), spanHex() and spanHexOrSpace()
+// over pseudo-random buffers of every length up to 96 bytes, at each
+// alignment, and checks every result against a plain scalar reference.
+//
+// CMake builds src/scan.cpp into this program once per path: scan_avx2
+// (-mavx2, x86 hosts that run AVX2), scan_sse2 and scan_scalar
+// (ARM64_NO_SIMD). All of them must print the expected output below, so the
+// paths agree with the reference and with each other; ARM64_EXPECT_BACKEND
+// makes sure each program really built the path it is named for.
+//
+// Run:      ./build/scan_sse2 (or scan_avx2, scan_scalar)
+// Expected: "Testing Output/scanOutput.txt" (ctest: scan_sse2, ...)
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "scan.hpp"
+
+namespace {
+
+// The characters listings are made of, the bytes the scanners look for, and
+// bytes >= 0x80 that signed compares could misclassify
+const char kAlphabet[] = "0123456789abcdefABCDEFxyzXZ ,[]{};:/#!-\t\r\n\v\x80\xff";
+
+uint32_t next(uint32_t& state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+std::size_t refFindFirstOf(std::string_view s, std::string_view set) {
+    for (std::size_t i = 0; i < s.size(); ++i)
+        if (set.find(s[i]) != std::string_view::npos) return i;
+    return std::string_view::npos;
+}
+
+bool isHex(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+std::size_t refSpan(std::string_view s, bool spaces) {
+    std::size_t i = 0;
+    while (i < s.size() && (isHex(s[i]) || (spaces && isSpace(s[i])))) ++i;
+    return i;
+}
+
+} // namespace
+
+int main() {
+    if (std::string_view(arm64::scan::backend()) != ARM64_EXPECT_BACKEND) {
+        std::cout << "built the " << arm64::scan::backend() << " path, expected " << ARM64_EXPECT_BACKEND << "\n";
+        return 1;
+    }
+
+    // Sets the parser uses, plus a five-byte one that takes the library scan
+    const std::string_view kSets[] = { "\n", ":", ",[]{", ";/[", ",[]", "#!", ",[]{;" };
+
+    uint32_t state = 2024;
+    std::size_t cases = 0, found = 0, hexRuns = 0, failures = 0;
+    std::string buf(96 + 3, '\0');
+    for (std::size_t len = 0; len <= 96; ++len) {
+        for (std::size_t align = 0; align < 4; ++align) {
+            for (int round = 0; round < 8; ++round) {
+                // Mostly hex digits in half the rounds, so the spans run long
+                for (char& c : buf) {
+                    const uint32_t r = next(state);
+                    c = (round & 1) && r % 32 ? kAlphabet[r % 22]
+                                              : kAlphabet[r % (sizeof kAlphabet - 1)];
+                }
+                const std::string_view s(buf.data() + align, len);
+
+                for (std::string_view set : kSets) {
+                    const std::size_t got = arm64::scan::findFirstOf(s, set);
+                    const std::size_t want = refFindFirstOf(s, set);
+                    ++cases;
+                    if (want != std::string_view::npos) ++found;
+                    if (got != want && failures++ < 5)
+                        std::cout << "findFirstOf len " << len << " align " << align
+                                  << ": got " << got << ", expected " << want << "\n";
+                }
+                for (bool spaces : { false, true }) {
+                    const std::size_t got = spaces ? arm64::scan::spanHexOrSpace(s) : arm64::scan::spanHex(s);
+                    const std::size_t want = refSpan(s, spaces);
+                    ++cases;
+                    if (want >= 16) ++hexRuns;
+                    if (got != want && failures++ < 5)
+                        std::cout << (spaces ? "spanHexOrSpace" : "spanHex") << " len " << len << " align "
+                                  << align << ": got " << got << ", expected " << want << "\n";
+                }
+            }
+        }
+    }
+
+    std::cout << cases << " cases (" << found << " finds, " << hexRuns << " spans of 16+ bytes), "
+              << failures << " differ from the reference\n";
+    return failures ? 1 : 0;
+}
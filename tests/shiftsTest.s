@@ -0,0 +1,72 @@
+// Shifts test: immediate and register shifts, bitfield moves and their
+// aliases, and shifted/extended second operands at X and W widths
+//
+// Run:      ./build/executor tests/shiftsTest.s --quiet --dump-regs --dump-stack
+// Expected: "Testing Output/shiftsOutput.txt" (ctest: shifts)
+//
+// X1 = 0xF0F0123456789ABC throughout. Expected final state:
+//   LSL X2, X1, #4                 -> X2 = 0x0F0123456789ABC0
+//   LSR X3, X1, #60                -> X3 = 0x000000000000000F
+//   ASR X4, X1, #8                 -> X4 = 0xFFF0F0123456789A
+//   ROR X5, X1, #12                -> X5 = 0xABCF0F0123456789
+//   LSL W6, W1, #28                -> X6 = 0x00000000C0000000
+//   ASR W7, W1, #4                 -> X7 = 0x00000000056789AB
+//   MOV X8, #68                    -> X8 = 0x0000000000000044
+//   LSL X8, X1, X8                 -> X8 = 0x0F0123456789ABC0
+//   UBFX X9, X1, #8, #12           -> X9 = 0x000000000000089A
+//   SBFX X10, X1, #60, #4          -> X10 = 0xFFFFFFFFFFFFFFFF
+//   UBFIZ X11, X1, #16, #8         -> X11 = 0x0000000000BC0000
+//   MOV X12, #0xAAAAAAAAAAAAAAAA   -> X12 = 0xAAAAAAAAAAAAAAAA
+//   BFI X12, X1, #4, #8            -> X12 = 0xAAAAAAAAAAAAABCA
+//   BFXIL X12, X1, #60, #4         -> X12 = 0xAAAAAAAAAAAAABCF
+//   SBFIZ W13, W1, #8, #4          -> X13 = 0x00000000FFFFFC00
+//   ADD X14, X1, X2, LSR #32       -> X14 = 0xF0F012346579BE01
+//   SUB W15, W1, W1, LSL #1        -> X15 = 0x00000000A9876544
+//   EOR X16, X1, X1, ROR #4        -> X16 = 0x3FFF1317131F1317
+//   MOV X17, #0x1000               -> X17 = 0x0000000000001000
+//   MOV W18, #0xFFFFFFF8           -> X18 = 0x00000000FFFFFFF8
+//   ADD X19, X17, W18, SXTW #2     -> X19 = 0x0000000000000FE0
+//   ADD X20, X17, W1, UXTB         -> X20 = 0x00000000000010BC
+//   SUB X21, X17, W1, UXTH #1      -> X21 = 0xFFFFFFFFFFFEDA88
+//   SXTB X22, W1                   -> X22 = 0xFFFFFFFFFFFFFFBC
+//   SXTH W23, W1                   -> X23 = 0x00000000FFFF9ABC
+//   SXTW X24, W1                   -> X24 = 0x0000000056789ABC
+//   UXTB W25, W1                   -> X25 = 0x00000000000000BC
+//   UXTH W26, W1                   -> X26 = 0x0000000000009ABC
+//   ADD X27, SP, X17, LSL #0       -> X27 = 0x0000000000001100
+//   UBFM X28, X1, #56, #7          -> X28 = 0x000000000000BC00
+// (X8 shifts by 68 mod 64 = 4; X12 is BFI then BFXIL over 0xAAAA...; SXTW #2
+//  of W18 = -8 gives X19 = 0x1000 - 32.)
+
+start:
+  MOV X1, #0xF0F0123456789ABC
+  LSL X2, X1, #4
+  LSR X3, X1, #60
+  ASR X4, X1, #8
+  ROR X5, X1, #12
+  LSL W6, W1, #28
+  ASR W7, W1, #4
+  MOV X8, #68
+  LSL X8, X1, X8
+  UBFX X9, X1, #8, #12
+  SBFX X10, X1, #60, #4
+  UBFIZ X11, X1, #16, #8
+  MOV X12, #0xAAAAAAAAAAAAAAAA
+  BFI X12, X1, #4, #8
+  BFXIL X12, X1, #60, #4
+  SBFIZ W13, W1, #8, #4
+  ADD X14, X1, X2, LSR #32
+  SUB W15, W1, W1, LSL #1
+  EOR X16, X1, X1, ROR #4
+  MOV X17, #0x1000
+  MOV W18, #0xFFFFFFF8
+  ADD X19, X17, W18, SXTW #2
+  ADD X20, X17, W1, UXTB
+  SUB X21, X17, W1, UXTH #1
+  SXTB X22, W1
+  SXTH W23, W1
+  SXTW X24, W1
+  UXTB W25, W1
+  UXTH W26, W1
+  ADD X27, SP, X17, LSL #0
+  UBFM X28, X1, #56, #7
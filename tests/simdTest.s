@@ -0,0 +1,101 @@
+// AdvSIMD test: LD1/ST1 with post-increment, lane-wise ADD/SUB/MUL with
+// wraparound at each element size, AND/ORR/EOR, CMEQ (register and #0),
+// ADDV, DUP, INS and UMOV, and a 64-bit arrangement clearing the top half
+//
+// Run:      ./build/executor tests/simdTest.s --quiet --dump-regs --dump-stack --dump-vregs
+// Expected: "Testing Output/simdOutput.txt" (ctest: simd)
+//
+// Expected final state:
+//   V0  = bytes 0xFF, 0x01 .. 0x0F loaded from 0x80
+//   V1  = sixteen 0x01 bytes (DUP V1.16B, W9)
+//   V2  = V0 + V1 per byte: byte 0 wraps 0xFF + 1 = 0x00
+//   V3  = V2 - V1 per halfword (8H)
+//   V4  = 4S: {3, 0xFFFFFFFF, 0x10000, 7} * {3, 2, 0x10000, 0} = {9, 0xFFFFFFFE, 0, 0}
+//   V5  = V0 AND V1, V6 = V0 ORR V1, V7 = V0 EOR V1
+//   V8  = CMEQ V3.16B, V0.16B: all ones but byte 1, where the 8H subtract of
+//         lane 0 (0x0200 - 0x0101 = 0x00FF) borrowed across the byte
+//   V9  = CMEQ V2.16B, #0: 0xFF in byte 0 only
+//   V10 = V6 + V1 as 8B: the low half, top half cleared
+//   V11 = V4 with S[1] replaced by V4.S[3] = 0x0000000000000009
+//   X0  = 0x0000000000000077   ; ADDV B of V0: 0xFF + (1 + .. + 15) = 0x177, low byte
+//   X1  = 0x0000000000000001   ; UMOV W1, V1.B[15]
+//   X2  = 0x0000000000000009   ; UMOV W2, V4.S[0] = 3 * 3
+//   X3  = 0xFFFFFFFE00000009   ; UMOV X3, V4.D[0]: lanes 0 and 1 (0xFFFFFFFF * 2)
+//   X4  = 0x0000000000000090   ; base after ST1 {V2.16B}, [X4], #16 from 0x80
+//   X5  = 0x00000000000000FF   ; UMOV W5, V9.B[0]
+//   X6  = 0x0000000000000000   ; UMOV W6, V10.B[8] (cleared top half)
+//   X7  = 0x0000000000000808   ; ADDV H of V1.8H = 8 * 0x0101
+//   SP  = 0x0000000000000100
+// Stack: 0x80..0x8f holds V2 (over the source bytes), 0x90..0x9f holds V7.
+
+start:
+  // Bytes 0xFF, 0x01, 0x02 .. 0x0F at 0x80
+  MOV X9, #0x01FF
+  MOVK X9, #0x0302, LSL #16
+  MOVK X9, #0x0504, LSL #32
+  MOVK X9, #0x0706, LSL #48
+  MOV X10, #0x0908
+  MOVK X10, #0x0B0A, LSL #16
+  MOVK X10, #0x0D0C, LSL #32
+  MOVK X10, #0x0F0E, LSL #48
+  MOV X4, #0x80
+  STR X9, [X4]
+  STR X10, [X4, #8]
+  LD1 {V0.16B}, [X4]
+
+  // Lane-wise arithmetic
+  MOV W9, #1
+  DUP V1.16B, W9
+  ADD V2.16B, V0.16B, V1.16B
+  SUB V3.8H, V2.8H, V1.8H
+
+  // 4S multiply: {3, 0xFFFFFFFF, 0x10000, 7} * {3, 2, 0x10000, 0}
+  MOV W9, #3
+  DUP V4.4S, W9
+  MOV W9, #0xFFFFFFFF
+  INS V4.S[1], W9
+  MOV W9, #0x10000
+  INS V4.S[2], W9
+  MOV W9, #7
+  INS V4.S[3], W9
+  MOV W9, #3
+  DUP V12.4S, W9
+  MOV W9, #2
+  INS V12.S[1], W9
+  MOV W9, #0x10000
+  INS V12.S[2], W9
+  MOV W9, #0
+  INS V12.S[3], W9
+  MUL V4.4S, V4.4S, V12.4S
+
+  // Logic and compares
+  AND V5.16B, V0.16B, V1.16B
+  ORR V6.16B, V0.16B, V1.16B
+  EOR V7.16B, V0.16B, V1.16B
+  CMEQ V8.16B, V3.16B, V0.16B
+  CMEQ V9.16B, V2.16B, #0
+
+  // A 64-bit arrangement writes the low half and clears the top
+  MOV V10.16B, V6.16B
+  ADD V10.8B, V10.8B, V1.8B
+
+  // Element moves
+  MOV V11.16B, V4.16B
+  INS V11.S[1], V4.S[3]
+
+  // Reductions and element reads
+  ADDV B13, V0.16B
+  UMOV W0, V13.B[0]
+  UMOV W1, V1.B[15]
+  UMOV W2, V4.S[0]
+  UMOV X3, V4.D[0]
+  UMOV W5, V9.B[0]
+  UMOV W6, V10.B[8]
+  ADDV H14, V1.8H
+  UMOV W7, V14.H[0]
+
+  // Stores with post-increment
+  ST1 {V2.16B}, [X4], #16
+  ST1 {V7.16B}, [X4]
+  MOV X9, #0
+  MOV X10, #0
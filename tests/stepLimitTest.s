@@ -0,0 +1,40 @@
+// Step limit test: --max-steps stops with exactly N instructions retired,
+// even when N falls inside a straight-line block the quiet run executes as
+// superinstructions, or inside a loop --fast-loops would skip
+//
+// Run:      ./build/executor tests/stepLimitTest.s --quiet --dump-regs --max-steps=23 --status-file=FILE
+// Expected: "Testing Output/stepLimitOutput.txt" (ctest: stepLimit, exit status 3)
+//           and stepLimitTraced (traced, one instruction at a time) the same
+//           state; stepLimitLoop stops after 10 steps with --fast-loops
+//
+// Expected output: "Aborting: exceeded max step count (23)" on stderr,
+// "step-limit" in the status file, and
+//   X0  = 0x0000000000000005   ; the loop ran all five iterations (17 steps)
+//   X1  = 0x0000000000000000
+//   X2  = 0x0000000000000006   ; six of the twelve ADDs ran (23 - 17)
+//   PC  = the seventh ADD
+// With --max-steps=10 --fast-loops: X0 = 3, X1 = 2, PC at the CBNZ
+// (2 + 3 * 3 - 1 = 10 steps: two full iterations, then ADD and SUB).
+
+start:
+  MOV X0, #0
+  MOV X1, #5
+loop:
+  ADD X0, X0, #1
+  SUB X1, X1, #1
+  CBNZ X1, loop
+
+  // One block of twelve dependent adds
+  ADD X2, X2, #1
+  ADD X2, X2, #1
+  ADD X2, X2, #1
+  ADD X2, X2, #1
+  ADD X2, X2, #1
+  ADD X2, X2, #1
+  ADD X2, X2, #1
+  ADD X2, X2, #1
+  ADD X2, X2, #1
+  ADD X2, X2, #1
+  ADD X2, X2, #1
+  ADD X2, X2, #1
+  MOV X3, #1
@@ -0,0 +1,71 @@
+// System call test: write to stdout and stderr from a stack buffer,
+// clock_gettime into the stack, an unknown number returning -ENOSYS, and
+// exit_group whose code becomes the executor's exit status
+//
+// Run:      ./build/executor tests/syscallTest.s --quiet --dump-regs
+// Expected: "Testing Output/syscallOutput.txt" (ctest: syscall, exit status 7)
+//
+// The guest's writes go straight to the host descriptors, so they come out
+// before the executor's own (buffered) report.
+//
+// Expected output: "Hi" on stdout, "Err" on stderr, then the report with
+//   X0  = 0x0000000000000007   ; exit_group's argument, untouched by the call
+//   X8  = 0x000000000000005E   ; 94, exit_group
+//   X19 = 0x0000000000000003   ; write returned the byte count
+//   X20 = 0x0000000000000004
+//   X21 = 0xFFFFFFFFFFFFFFDA   ; -38 (-ENOSYS) for syscall 999
+//   X22 = 0x0000000000000000   ; clock_gettime(CLOCK_MONOTONIC) succeeded
+//   X23 = 0x0000000000000001   ; ... and filled in a non-zero timespec
+//   X24 = 0x0000000000000000   ; the instruction after exit_group never runs
+//   SP  = 0x00000000000000E0
+
+start:
+  SUB SP, SP, #32
+
+  // write(1, "Hi\n", 3)
+  MOV W9, #0x6948
+  MOVK W9, #0x0A, LSL #16
+  STR W9, [SP]
+  MOV X0, #1
+  MOV X1, SP
+  MOV X2, #3
+  MOV X8, #64
+  SVC #0
+  MOV X19, X0
+
+  // write(2, "Err\n", 4)
+  MOV W9, #0x7245
+  MOVK W9, #0x0A72, LSL #16
+  STR W9, [SP, #4]
+  MOV X0, #2
+  ADD X1, SP, #4
+  MOV X2, #4
+  MOV X8, #64
+  SVC #0
+  MOV X20, X0
+
+  // An unimplemented number
+  MOV X8, #999
+  SVC #0
+  MOV X21, X0
+
+  // clock_gettime(CLOCK_MONOTONIC, sp + 16)
+  MOV X0, #1
+  ADD X1, SP, #16
+  MOV X8, #113
+  SVC #0
+  MOV X22, X0
+  LDP X9, X10, [SP, #16]
+  ORR X9, X9, X10
+  CMP X9, #0
+  CSET X23, NE
+  // The timespec varies run to run; clear it before the dump
+  STP XZR, XZR, [SP, #16]
+  MOV X9, #0
+  MOV X10, #0
+
+  // exit_group(7)
+  MOV X0, #7
+  MOV X8, #94
+  SVC #0
+  MOV X24, #1